@@ -18,6 +18,7 @@
 #include <iostream>
 #include <fstream>
 #include <string.h>
+#include <cstdio>
 #include <memory>
 #include <cctype>
 
@@ -36,6 +37,7 @@
 #include "Logger.h"
 #include "Screen.h"
 #include "File.h"
+#include "Archive.h"
 
 namespace CommandLine
 {
@@ -56,7 +58,7 @@ static void Usage()
 	Info() << "\t[-b benchmark demodulation models for time - for development purposes (default: off)]";
 	Info() << "\t[-c [AB/CD] - [optional: AB] select AIS channels and optionally the NMEA channel designations]";
 	Info() << "\t[-C [filename] - read configuration settings from file]";
-	Info() << "\t[-D [connection string] - write messages to a database: libpq string, sqlite:[file] or csv:[directory]]";
+	Info() << "\t[-D [connection string] - write messages to a database: libpq string, sqlite:[file], csv:[directory] or archive:[directory]]";
 	Info() << "\t[-e [baudrate] [serial port] - read NMEA from serial port at specified baudrate]";
 	Info() << "\t[-E [config file] [bind address:port] - managed mode: engine run from config file with control server, must be only option (defaults: config.json, control port 8118, viewer on control port + 1, local access without password; use 0.0.0.0:port for LAN access with password)]";
 	Info() << "\t[-f [filename] write NMEA lines to file]";
@@ -66,6 +68,7 @@ static void Usage()
 	Info() << "\t[-H [optional: url] - send messages via HTTP, for options see documentation]";
 	Info() << "\t[-i [interface] - read NMEA2000 data from socketCAN interface - Linux only]";
 	Info() << "\t[-I [interface] - push messages as NMEA2000 data to a socketCAN interface - Linux only]";
+	Info() << "\t[-K [archive directory or file] [from] [optional: to] [optional: mmsi,mmsi,...] - write archived messages in a time range as CSV to stdout and terminate (times: YYYY-MM-DD or YYYY-MM-DDTHH:MM:SS, UTC)]";
 	Info() << "\t[-m xx - run specific decoding model (default: 2), see README for more details]";
 	Info() << "\t[-M xxx - set additional meta data to generate: T = NMEA timestamp, D = decoder related (signal power, ppm) (default: none)]";
 	Info() << "\t[-n show NMEA messages on screen without detail (-o 1)]";
@@ -95,13 +98,14 @@ static void Usage()
 	Info() << "\t[-r [optional: yy] filename - read IQ data from file or stdin (.), short for -r -ga FORMAT yy FILE filename";
 	Info() << "\t[-t [[protocol]] [host [port]] - read IQ data from remote RTL-TCP instance]";
 	Info() << "\t[-w filename - read IQ data from WAV file, short for -w -gw FILE filename]";
+	Info() << "\t[-j [server][port] - TCP server input of NMEA feeds from many stations at port on server";
 	Info() << "\t[-x [server][port] - UDP input of NMEA messages at port on server";
 	Info() << "\t[-y [host [port]] - read IQ data from remote SpyServer]";
 	Info() << "\t[-z [optional [format]] [optional endpoint] - read IQ data from [endpoint] in [format] via ZMQ (default: format is CU8)]";
 	Info() << "";
 	Info() << "\tDevice specific settings:";
 	Info() << "";
-	Info() << "\t[-ga RAW file: FILE [filename] FORMAT [CF32/CS16/CU8/CS8] ]";
+	Info() << "\t[-ga RAW file: FILE [filename] FORMAT [CF32/CS16/CU8/CS8] WORKERS [auto/1-256, parallel decoding of NMEA files] ]";
 	Info() << "\t[-gd HydraSDR: SENSITIVITY [0-21] LINEARITY [0-21] VGA [0-14] LNA [auto/0-14] MIXER [auto/0-14] BIASTEE [on/off] ]";
 	Info() << "\t[-ge Serial Port: PRINT [on/off] FLOWCONTROL [none/hardware/software] INIT_SEQ [string] ]";
 	Info() << "\t[-gf HACKRF: LNA [0-40] VGA [0-62] PREAMP [on/off] ]";
@@ -112,12 +116,14 @@ static void Usage()
 	Info() << "\t[-gt RTLTCP: HOST [address] PORT [port] TUNER [auto/0.0-50.0] RTLAGC [on/off] FREQOFFSET [-150-150] PROTOCOL [none/rtltcp] TIMEOUT [1-60] ]";
 	Info() << "\t[-gu SOAPYSDR: DEVICE [string] GAIN [string] AGC [on/off] STREAM [string] SETTING [string] CH [0+] PROBE [on/off] ANTENNA [string] ]";
 	Info() << "\t[-gw WAV file: FILE [filename] ]";
+	Info() << "\t[-gx UDP input: WORKERS [1-64] BATCH [1-1024] ]";
+	Info() << "\t[-gj TCP server input: WORKERS [1-64] TIMEOUT [0-86400] STATION_MAP [address=station,...] ]";
 	Info() << "\t[-gy SPYSERVER: HOST [address] PORT [port] GAIN [0-50] ]";
 	Info() << "\t[-gz ZMQ: ENDPOINT [endpoint] FORMAT [CF32/CS16/CU8/CS8] ]";
 	Info() << "";
 	Info() << "\tModel specific settings:";
 	Info() << "";
-	Info() << "\t[-go Model: AFC_WIDE [on/off] FP_DS [on/off] PS_EMA [on/off] SOXR [on/off] SRC [on/off] DROOP [on/off] DD_TRAIN [weight] DD_WEIGHT [weight] ]";
+	Info() << "\t[-go Model: AFC_WIDE [on/off] FP_DS [on/off] PS_EMA [on/off] SOXR [on/off] SRC [on/off] PFB [on/off] FUSED [on/off] DROOP [on/off] DD_TRAIN [weight] DD_WEIGHT [weight] PORT [port] FORMAT [CS8/CS16] ]";
 }
 
 static void printBuildConfiguration()
@@ -265,6 +271,24 @@ static void Assert(bool b, std::string &context, const std::string &msg = "")
 	}
 }
 
+// YYYY-MM-DD[THH:MM:SS] in UTC, '/' or '-' between the date fields; a bare
+// date as the end of a range covers the whole day
+static std::time_t parseArchiveTime(const std::string &s, bool end)
+{
+	int y = 0, mo = 0, d = 0, h = 0, mi = 0, sec = 0;
+	char sep1 = 0, sep2 = 0;
+
+	const int n = std::sscanf(s.c_str(), "%d%c%d%c%d%*1[T ]%d:%d:%d", &y, &sep1, &mo, &sep2, &d, &h, &mi, &sec);
+	if ((n != 5 && n != 8) || sep1 != sep2 || (sep1 != '-' && sep1 != '/') || mo < 1 || mo > 12 || d < 1 || d > 31)
+		throw std::runtime_error("invalid time \"" + s + "\", expected YYYY-MM-DD or YYYY-MM-DDTHH:MM:SS");
+
+	std::time_t t = (std::time_t)Util::Convert::daysFromEpoch(y, mo, d) * 86400;
+	if (n == 8)
+		return t + h * 3600 + mi * 60 + sec;
+
+	return end ? t + 86399 : t;
+}
+
 static void parseCLI(int argc, char *argv[], Engine &engine, Config &c, int &cb)
 {
 	const std::string MSG_NO_PARAMETER = "does not allow additional parameter.";
@@ -444,9 +468,16 @@ static void parseCLI(int argc, char *argv[], Engine &engine, Config &c, int &cb)
 			setDeviceArgs(dm.UDP(), {AIS::KEY_SETTING_SERVER, AIS::KEY_SETTING_PORT}, argv, ptr, count, argc);
 		}
 		break;
+		case 'j':
+		{
+			Assert(count >= 2 && (count & 1) == 0, param, "requires two parameters [server] [port] (optionally followed by key value pairs).");
+			DeviceManager &dm = newDevice(Type::TCPSERVER);
+			setDeviceArgs(dm.TCPInput(), {AIS::KEY_SETTING_SERVER, AIS::KEY_SETTING_PORT}, argv, ptr, count, argc);
+		}
+		break;
 		case 'D':
 		{
-			// bare target = libpq string; a "sqlite:" or "csv:" prefix picks the backend
+			// bare target = libpq string; a "sqlite:", "csv:" or "archive:" prefix picks the backend
 			std::string type = "postgres";
 			std::string target = count % 2 == 1 ? arg1 : std::string();
 
@@ -460,6 +491,11 @@ static void parseCLI(int argc, char *argv[], Engine &engine, Config &c, int &cb)
 				type = "csv";
 				target = target.substr(4);
 			}
+			else if (target.compare(0, 8, "archive:") == 0)
+			{
+				type = "archive";
+				target = target.substr(8);
+			}
 
 			engine.msg.push_back(std::unique_ptr<IO::OutputMessage>(Config::newDatabaseOutput(type)));
 			IO::OutputMessage &d = *engine.msg.back();
@@ -477,6 +513,29 @@ static void parseCLI(int argc, char *argv[], Engine &engine, Config &c, int &cb)
 			}
 		}
 		break;
+		case 'K':
+		{
+			Assert(count >= 2 && count <= 4, param, "requires two to four parameters [archive] [from] [optional: to] [optional: mmsi list].");
+
+			// a lone date reads that whole day
+			const std::time_t from = parseArchiveTime(arg2, false);
+			const std::time_t to = count >= 3 ? parseArchiveTime(argv[ptr + 3], true) : parseArchiveTime(arg2, true);
+
+			std::vector<uint32_t> mmsi;
+			if (count == 4)
+			{
+				std::vector<std::string> list;
+				Util::Parse::Split(argv[ptr + 4], ',', list);
+				for (const auto &m : list)
+					mmsi.push_back((uint32_t)Util::Parse::Integer(m, 0, 999999999));
+			}
+
+			IO::Archive::extract(arg1, from, to, mmsi, std::cout);
+
+			engine.no_run = true;
+			engine.show_copyright = false;
+		}
+		break;
 		case 'y':
 		{
 			Assert(count <= 2, param, "requires one or two parameters [url] or [host] [port].");
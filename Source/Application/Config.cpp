@@ -22,6 +22,7 @@
 #include "PostgreSQL.h"
 #include "SQLite.h"
 #include "CSV.h"
+#include "Archive.h"
 
 IO::OutputMessage *Config::newDatabaseOutput(const std::string &type)
 {
@@ -31,8 +32,10 @@ IO::OutputMessage *Config::newDatabaseOutput(const std::string &type)
 		return new IO::SQLite();
 	if (type == "csv")
 		return new IO::CSV();
+	if (type == "archive")
+		return new IO::Archive();
 
-	throw std::runtime_error("Database type \"" + type + "\" is not one of postgres, sqlite, csv.");
+	throw std::runtime_error("Database type \"" + type + "\" is not one of postgres, sqlite, csv, archive.");
 }
 
 void Config::addDatabaseOutputsFromJSON(const JSON::Member &m)
@@ -56,9 +59,35 @@ void Config::addDatabaseOutputsFromJSON(const JSON::Member &m)
 
 		_engine.msg.push_back(std::unique_ptr<IO::OutputMessage>(newDatabaseOutput(type)));
 		setSettingsFromJSON(v, *_engine.msg.back(), AIS::KEY_SETTING_MODEL_TYPE);
+		_engine.msg.back()->spec = outputSpec("DB", v);
 	}
 }
 
+std::string Config::outputSpec(const std::string &label, const JSON::Value &v)
+{
+	std::string spec = label + ":";
+	JSON::Serializer serializer(JSON_DICT_SETTING);
+	serializer.stringify(v.getObject(), spec);
+	return spec;
+}
+
+// the top-level fields Engine::reload() can apply to a running engine
+static bool isReloadable(int key)
+{
+	switch (key)
+	{
+	case AIS::KEY_SETTING_UDP:
+	case AIS::KEY_SETTING_TCP:
+	case AIS::KEY_SETTING_MQTT:
+	case AIS::KEY_SETTING_TCP_LISTENER:
+	case AIS::KEY_SETTING_HTTP:
+	case AIS::KEY_SETTING_DB:
+	case AIS::KEY_SETTING_ENGINE:
+		return true;
+	}
+	return false;
+}
+
 bool Config::isActiveObject(const JSON::Value &m)
 {
 
@@ -179,8 +208,12 @@ int Config::engineType(const std::string &s)
 		return AIS::MODEL_V1_HIGH;
 	if (t == "V2_BASE")
 		return AIS::MODEL_V2_BASE;
+	if (t == "EDGE")
+		return AIS::MODEL_EDGE;
+	if (t == "MODES")
+		return AIS::MODEL_MODES;
 
-	throw std::runtime_error("engine type must be auto, v1_base, v1_high or v2_base");
+	throw std::runtime_error("engine type must be auto, v1_base, v1_high, v2_base, edge or modes");
 }
 
 // "engines": [ { "type": "v2_base", "settings": { "afc_wide": "off" } } ]
@@ -412,6 +445,15 @@ void Config::set(const std::string &str)
 		if (m.Key() == AIS::KEY_SETTING_CHANNEL || m.Key() == AIS::KEY_SETTING_ENGINES)
 			throw std::runtime_error(std::string("Config file: \"") + AIS::KeyMap[m.Key()][JSON_DICT_SETTING] + "\" is not allowed in the main section, set it inside a receiver object.");
 
+	// everything else needs a new engine when it changes
+	JSON::JSON core;
+	for (const auto &m : doc.getMembers())
+		if (!isReloadable(m.Key()))
+			core.Add(m.Key(), m.Get());
+
+	_engine.config_core.clear();
+	JSON::Serializer(JSON_DICT_SETTING).stringify(core, _engine.config_core);
+
 	setReceiverfromJSON(doc.getMembers(), true);
 	setSharing(doc.getMembers());
 
@@ -449,6 +491,7 @@ void Config::set(const std::string &str)
 		case AIS::KEY_SETTING_HACKRF:
 		case AIS::KEY_SETTING_HYDRASDR:
 		case AIS::KEY_SETTING_UDPSERVER:
+		case AIS::KEY_SETTING_TCPSERVER:
 		case AIS::KEY_SETTING_SOAPYSDR:
 		case AIS::KEY_SETTING_FILE:
 		case AIS::KEY_SETTING_ZMQ:
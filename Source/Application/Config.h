@@ -69,8 +69,11 @@ class Config
 			if (default_timeout)
 				o.SetKey(AIS::KEY_SETTING_TIMEOUT, default_timeout);
 			setSettingsFromJSON(v, o);
+			o.spec = outputSpec(label, v);
 		}
 	}
+	// identifies an output across reloads: same spec, same output
+	static std::string outputSpec(const std::string &label, const JSON::Value &v);
 	// the "db" array names its backend with a "type" field
 	void addDatabaseOutputsFromJSON(const JSON::Member &m);
 
@@ -56,7 +56,8 @@ namespace
 		{'t', AIS::KEY_SETTING_RTLTCP, Type::RTLTCP, false, [](DeviceManager &d) -> Device::Device & { return d.RTLTCP(); }},
 		{'y', AIS::KEY_SETTING_SPYSERVER, Type::SPYSERVER, false, [](DeviceManager &d) -> Device::Device & { return d.SpyServer(); }},
 		{'z', AIS::KEY_SETTING_ZMQ, Type::ZMQ, false, [](DeviceManager &d) -> Device::Device & { return d.ZMQ(); }},
-		{0, AIS::KEY_SETTING_UDPSERVER, Type::UDP, false, [](DeviceManager &d) -> Device::Device & { return d.UDP(); }}};
+		{'x', AIS::KEY_SETTING_UDPSERVER, Type::UDP, false, [](DeviceManager &d) -> Device::Device & { return d.UDP(); }},
+		{'j', AIS::KEY_SETTING_TCPSERVER, Type::TCPSERVER, false, [](DeviceManager &d) -> Device::Device & { return d.TCPInput(); }}};
 
 	// Types eligible for the implicit no-arguments default. Only SDR radios are
 	// unambiguous AIS receivers; serial/N2K ports (e.g. /dev/cu.debug-console)
@@ -117,101 +118,106 @@ Device::Device *DeviceManager::getDeviceByType(Type type)
 	return nullptr;
 }
 
-bool DeviceManager::openDevice(int sample_rate, int bandwidth, int ppm, int frequency, TAG &tag)
+bool DeviceManager::selectDevice()
 {
-	uint64_t handle;
-
-	{
-		std::lock_guard<std::mutex> lock(list_mtx);
+	std::lock_guard<std::mutex> lock(list_mtx);
 
-		int idx = device_list.empty() ? -1 : 0;
-		handle = device_list.empty() ? 0 : device_list[0].getHandle();
+	int idx = device_list.empty() ? -1 : 0;
+	handle = device_list.empty() ? 0 : device_list[0].getHandle();
 
-		if (!serial.empty()) {
-			Info() << "Searching for device with SN " << serial << (type != Type::NONE ? " and type " + Util::Parse::DeviceTypeString(type) : "") << ".";
-		}
+	if (!serial.empty()) {
+		Info() << "Searching for device with SN " << serial << (type != Type::NONE ? " and type " + Util::Parse::DeviceTypeString(type) : "") << ".";
+	}
 
-		if (!serial.empty() || type != Type::NONE)
+	if (!serial.empty() || type != Type::NONE)
+	{
+		std::vector<int> matches;
+		for (int i = 0; i < device_list.size(); i++)
 		{
-			std::vector<int> matches;
-			for (int i = 0; i < device_list.size(); i++)
-			{
-				bool serial_match = device_list[i].getSerial() == serial && (type == Type::NONE || type == device_list[i].getType());
-				bool type_match = serial.empty() && (type == device_list[i].getType());
+			bool serial_match = device_list[i].getSerial() == serial && (type == Type::NONE || type == device_list[i].getType());
+			bool type_match = serial.empty() && (type == device_list[i].getType());
 
-				if (serial_match || type_match)
-					matches.push_back(i);
-			}
+			if (serial_match || type_match)
+				matches.push_back(i);
+		}
+
+		idx = -1;
+		for (int m : matches)
+			if (!device_list[m].isClaimed()) { idx = m; break; }
 
-			idx = -1;
-			for (int m : matches)
-				if (!device_list[m].isClaimed()) { idx = m; break; }
+		if (idx == -1 && !matches.empty())
+		{
+			Device::Description &d = device_list[matches.front()];
+			Error() << "Device Manager: configuration opens the same device twice ("
+					<< Util::Parse::DeviceTypeString(d.getType()) << " SN " << d.getSerial()
+					<< "). Each receiver must select a distinct device (set a unique \"serial\").";
+			return false;
+		}
 
-			if (idx == -1 && !matches.empty())
+		if (idx == -1)
+		{
+			if (!serial.empty())
 			{
-				Device::Description &d = device_list[matches.front()];
-				Error() << "Device Manager: configuration opens the same device twice ("
-						<< Util::Parse::DeviceTypeString(d.getType()) << " SN " << d.getSerial()
-						<< "). Each receiver must select a distinct device (set a unique \"serial\").";
+				Error() << "Device Manager: cannot find device with SN " << serial << ".";
+				printAvailableDevices_locked();
 				return false;
 			}
 
-			if (idx == -1)
+			idx = 0;
+			handle = 0;
+		}
+		else
+		{
+			handle = device_list[idx].getHandle();
+			device_list[idx].setClaimed();
+
+			if (serial.empty() && matches.size() > 1)
 			{
-				if (!serial.empty())
-				{
-					Error() << "Device Manager: cannot find device with SN " << serial << ".";
-					printAvailableDevices_locked();
-					return false;
-				}
-
-				idx = 0;
-				handle = 0;
+				Device::Description &d = device_list[idx];
+				Warning() << "Device Manager: multiple devices match type "
+						  << Util::Parse::DeviceTypeString(type) << "; selecting SN " << d.getSerial()
+						  << ". Set \"serial\" to choose a specific device.";
 			}
-			else
+		}
+	}
+	else
+	{
+		// Nothing specified: auto-select the first available SDR radio only.
+		idx = -1;
+		for (int i = 0; i < device_list.size(); i++)
+			if (isAutoSelectable(device_list[i].getType()) && !device_list[i].isClaimed())
 			{
-				handle = device_list[idx].getHandle();
-				device_list[idx].setClaimed();
-
-				if (serial.empty() && matches.size() > 1)
-				{
-					Device::Description &d = device_list[idx];
-					Warning() << "Device Manager: multiple devices match type "
-							  << Util::Parse::DeviceTypeString(type) << "; selecting SN " << d.getSerial()
-							  << ". Set \"serial\" to choose a specific device.";
-				}
+				idx = i;
+				handle = device_list[i].getHandle();
+				device_list[i].setClaimed();
+				break;
 			}
-		}
-		else
+
+		if (idx == -1)
 		{
-			// Nothing specified: auto-select the first available SDR radio only.
-			idx = -1;
-			for (int i = 0; i < device_list.size(); i++)
-				if (isAutoSelectable(device_list[i].getType()) && !device_list[i].isClaimed())
-				{
-					idx = i;
-					handle = device_list[i].getHandle();
-					device_list[i].setClaimed();
-					break;
-				}
-
-			if (idx == -1)
+			if (device_list.empty())
+				Error() << "Device Manager: no devices available.";
+			else
 			{
-				if (device_list.empty())
-					Error() << "Device Manager: no devices available.";
-				else
-				{
-					Error() << "Device Manager: no SDR device found, please select a device.";
-					printAvailableDevices_locked();
-				}
-				return false;
+				Error() << "Device Manager: no SDR device found, please select a device.";
+				printAvailableDevices_locked();
 			}
+			return false;
 		}
-
-		if (type == Type::NONE)
-			type = device_list[idx].getType();
 	}
 
+	if (type == Type::NONE)
+		type = device_list[idx].getType();
+
+	selected = true;
+	return true;
+}
+
+bool DeviceManager::openDevice(int sample_rate, int bandwidth, int ppm, int frequency, TAG &tag)
+{
+	if (!selected && !selectDevice())
+		return false;
+
 	device = getDeviceByType(type);
 
 	if (device == 0)
@@ -34,6 +34,7 @@
 #include "Device/Serial.h"
 #include "Device/ZMQ.h"
 #include "Device/UDP.h"
+#include "Device/TCPInput.h"
 #include "Device/N2KsktCAN.h"
 #include "Device/HYDRASDR.h"
 
@@ -57,6 +58,7 @@ class DeviceManager
     Device::SerialPort _SerialPort;
     Device::ZMQ _ZMQ;
     Device::UDP _UDP;
+    Device::TCPInput _TCPInput;
     Device::N2KSCAN _N2KSCAN;
 
     Device::Device *getDeviceByType(Type type);
@@ -66,6 +68,10 @@ class DeviceManager
     static std::mutex list_mtx;
     Device::Device *device = nullptr;
 
+    // set by selectDevice()
+    uint64_t handle = 0;
+    bool selected = false;
+
 public:
     ~DeviceManager()
     {
@@ -88,6 +94,7 @@ public:
     Device::SOAPYSDR &SOAPYSDR() { return _SOAPYSDR; }
     Device::ZMQ &ZMQ() { return _ZMQ; }
     Device::UDP &UDP() { return _UDP; }
+    Device::TCPInput &TCPInput() { return _TCPInput; }
     Device::N2KSCAN &N2KSCAN() { return _N2KSCAN; }
 
     // The device Setting a "-g<flag>" switch or a config file key names,
@@ -104,6 +111,9 @@ public:
 
     Device::Device *getDevice() { return device; }
 
+    // Claims a device from the list. Separate from opening so the receivers can
+    // claim in order and then open side by side; openDevice() claims if needed.
+    bool selectDevice();
     bool openDevice(int sample_rate, int bandwidth, int ppm, int frequency, TAG &tag);
     void printAvailableDevices(bool JSON = false);
     static std::string getDeviceListJSON();
@@ -16,11 +16,15 @@
 */
 
 #include <chrono>
+#include <exception>
+#include <mutex>
+#include <thread>
 #include <sstream>
 
 #include "AIS-catcher.h"
 
 #include "Engine.h"
+#include "Config.h"
 #include "ControlCore.h"
 #include "Logger.h"
 
@@ -49,6 +53,262 @@ void Engine::detach()
 #endif
 }
 
+namespace
+{
+	// Runs fn(0) .. fn(n - 1) side by side, one thread each; rethrows the
+	// first exception once all have returned
+	template <typename F>
+	void parallelFor(int n, F fn)
+	{
+		if (n == 1)
+		{
+			fn(0);
+			return;
+		}
+
+		std::vector<std::thread> threads;
+		std::vector<std::exception_ptr> errors(n);
+
+		for (int i = 0; i < n; i++)
+			threads.emplace_back([&, i]
+								 {
+				try
+				{
+					fn(i);
+				}
+				catch (...)
+				{
+					errors[i] = std::current_exception();
+				} });
+
+		for (auto &t : threads)
+			t.join();
+
+		for (auto &e : errors)
+			if (e)
+				std::rethrow_exception(e);
+	}
+
+	// wall time per startup phase, for the log
+	class StartupTimer
+	{
+		high_resolution_clock::time_point start = high_resolution_clock::now(), last = start;
+		std::string phases;
+
+		static long long ms(high_resolution_clock::duration d) { return duration_cast<milliseconds>(d).count(); }
+
+	public:
+		void phase(const char *name)
+		{
+			auto now = high_resolution_clock::now();
+			phases += std::string(name) + " " + std::to_string(ms(now - last)) + " ms, ";
+			last = now;
+		}
+
+		std::string summary() const { return phases + "total " + std::to_string(ms(last - start)) + " ms"; }
+	};
+}
+
+void Engine::startOutputs(bool publish)
+{
+	std::mutex mtx;
+	IO::OutputList ready;
+
+	// Start() may resolve names and connect, so a slow host holds up no other output
+	parallelFor((int)msg.size(), [&](int i)
+				{
+		auto t0 = high_resolution_clock::now();
+		msg[i]->Start();
+		Debug() << "Startup: output " << i << " started in " << duration_cast<milliseconds>(high_resolution_clock::now() - t0).count() << " ms";
+
+		if (publish)
+		{
+			std::lock_guard<std::mutex> lock(mtx);
+			ready.push_back(msg[i].get());
+			outputs.set(std::make_shared<IO::OutputList>(ready));
+		} });
+}
+
+void Engine::connectRouters(Receiver &r)
+{
+	for (int j = 0; j < r.Count(); j++)
+	{
+		routers.push_back(std::unique_ptr<IO::OutputRouter>(new IO::OutputRouter(outputs, r.Output(j).getGroupOut(), r.OutputGPS(j).getGroupOut())));
+		IO::OutputRouter *router = routers.back().get();
+
+		r.Output(j).Connect((StreamIn<AIS::Message> *)router);
+		if (json_routes)
+			r.OutputJSON(j, json_keys).Connect((StreamIn<JSON::JSON> *)router);
+		r.OutputGPS(j).Connect((StreamIn<AIS::GPS> *)router);
+	}
+}
+
+void Engine::publishOutputs()
+{
+	std::shared_ptr<IO::OutputList> l = std::make_shared<IO::OutputList>();
+	for (auto &o : msg)
+		l->push_back(o.get());
+	outputs.set(l);
+}
+
+bool Engine::reload(ControlCore &control)
+{
+	// read the config file the way a new engine would
+	Engine next;
+
+	try
+	{
+		Config c(next, true);
+		c.set(control.getConfig());
+	}
+	catch (const std::exception &e)
+	{
+		Error() << "Control: cannot reload the configuration: " << e.what();
+		return false;
+	}
+
+	if (next.config_core != config_core)
+	{
+		Info() << "Control: receiver or viewer settings changed, restarting the engine";
+		return false;
+	}
+
+	// outputs are matched on their config entry, the community feed is not
+	// in there and stays as it is
+	std::vector<bool> kept(msg.size(), false);
+	std::vector<std::unique_ptr<IO::OutputMessage>> added;
+	std::vector<int> order; // of next.msg: index into msg, or -1 - index into added
+
+	for (auto &n : next.msg)
+	{
+		if (n.get() == next.comm_feed)
+			continue;
+
+		int match = -1;
+		for (int i = 0; i < (int)msg.size() && match < 0; i++)
+			if (!kept[i] && msg[i].get() != comm_feed && msg[i]->spec == n->spec)
+				match = i;
+
+		if (match >= 0)
+		{
+			kept[match] = true;
+			order.push_back(match);
+			continue;
+		}
+
+		// the receivers are wired for what this engine started with
+		if (n->usesJSONStream() && !(json_routes && json_keys.covers(n->jsonKeys())))
+		{
+			Info() << "Control: new output needs JSON the receivers do not build, restarting the engine";
+			return false;
+		}
+		if (!http_tags && dynamic_cast<IO::HTTPStreamer *>(n.get()))
+		{
+			Info() << "Control: first HTTP output needs tagged messages, restarting the engine";
+			return false;
+		}
+
+		added.push_back(std::move(n));
+		order.push_back(-(int)added.size());
+	}
+
+	int removed = 0;
+	for (int i = 0; i < (int)msg.size(); i++)
+		if (!kept[i] && msg[i].get() != comm_feed)
+			removed++;
+
+	if (!removed && added.empty())
+	{
+		Info() << "Control: configuration reloaded, outputs unchanged";
+		return true;
+	}
+
+	// take the removed outputs out of the routers and wait for the calls
+	// still in them to return, so they can close before a new one opens
+	if (removed)
+	{
+		std::weak_ptr<const IO::OutputList> previous = outputs.get();
+
+		std::shared_ptr<IO::OutputList> l = std::make_shared<IO::OutputList>();
+		for (int i = 0; i < (int)msg.size(); i++)
+			if (kept[i] || msg[i].get() == comm_feed)
+				l->push_back(msg[i].get());
+		outputs.set(l);
+
+		for (int wait = 0; !previous.expired(); wait++)
+		{
+			if (wait == 2000)
+			{
+				Warning() << "Control: output still busy after 2 seconds, restarting the engine";
+				return false;
+			}
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+	}
+
+#ifdef HASWEBVIEWER
+	for (auto *v : viewers)
+		v->setOutputChannels(nullptr);
+#endif
+
+	std::vector<std::unique_ptr<IO::OutputMessage>> updated;
+	if (comm_feed)
+		for (auto &o : msg)
+			if (o.get() == comm_feed)
+				updated.push_back(std::move(o));
+
+	for (int k : order)
+		updated.push_back(k >= 0 ? std::move(msg[k]) : std::move(added[-k - 1]));
+
+	// what is left in msg closes here
+	msg.swap(updated);
+	updated.clear();
+
+	bool ok = true;
+	try
+	{
+		const int first = comm_feed ? 1 : 0;
+
+		// as run() sets up the outputs it starts with
+		for (int p = 0; p < (int)order.size(); p++)
+		{
+			if (order[p] >= 0)
+				continue;
+
+			IO::OutputMessage &o = *msg[first + p];
+
+			if (!o.zones.empty())
+			{
+				uint64_t mask = resolveZones(receivers, o.zones);
+				if (!mask)
+					Warning() << "Output has zone filter but no matching receivers — will receive nothing";
+				o.SetKey(AIS::KEY_SETTING_GROUPS_IN, std::to_string(mask));
+			}
+
+			o.setExclusive(receivers.size() > 1);
+			o.Start();
+		}
+	}
+	catch (const std::exception &e)
+	{
+		Error() << "Control: cannot start output: " << e.what();
+		ok = false;
+	}
+
+#ifdef HASWEBVIEWER
+	for (auto *v : viewers)
+		v->setOutputChannels(&msg);
+#endif
+
+	if (!ok)
+		return false;
+
+	publishOutputs();
+
+	Info() << "Control: outputs reloaded (" << added.size() << " started, " << removed << " stopped), receivers kept running";
+	return true;
+}
+
 void Engine::run(WebViewer *viewer, ControlCore *control)
 {
 	attached_viewer = viewer;
@@ -61,9 +321,9 @@ void Engine::run(WebViewer *viewer, ControlCore *control)
 
 	bool has_server = false;
 #ifdef HASWEBVIEWER
-	// every viewer this run feeds, owned or not. The managed viewer differs only
-	// in that it outlives the engine, so the caller starts and closes it.
-	std::vector<WebViewer *> viewers;
+	// The managed viewer differs only in that it outlives the engine, so the
+	// caller starts and closes it.
+	viewers.clear();
 	for (auto &s : servers)
 		if (s->isActive())
 			viewers.push_back(s.get());
@@ -75,23 +335,35 @@ void Engine::run(WebViewer *viewer, ControlCore *control)
 	bool has_http = false;
 	for (auto &o : msg)
 		if (dynamic_cast<IO::HTTPStreamer *>(o.get())) { has_http = true; break; }
+	http_tags = has_server || has_http;
 
+	StartupTimer timer;
 	int group = 0;
 
-	for (int i = 0; i < (int)receivers.size(); i++)
+	// devices are claimed in receiver order, so which receiver gets which
+	// device does not depend on how the opens below interleave
+	for (auto &r : receivers)
 	{
-		Receiver &r = *receivers[i];
-		r.SetKey(AIS::KEY_SETTING_OWN_MMSI, std::to_string(own_mmsi));
-
-		if (has_server) r.setTags("DTM");
-		if (has_http)   r.setTags("DT");
+		r->SetKey(AIS::KEY_SETTING_OWN_MMSI, std::to_string(own_mmsi));
 
-		r.setupDevice();
+		if (has_server) r->setTags("DTM");
+		if (has_http)   r->setTags("DT");
 
-		// set up the decoding model(s), group is the last output group used
-		r.setupModel(group, i);
+		r->selectDevice();
 	}
 
+	// opening can take seconds per device (firmware, tuner calibration, network)
+	parallelFor((int)receivers.size(), [&](int i)
+				{
+		auto t0 = high_resolution_clock::now();
+		receivers[i]->setupDevice();
+		Debug() << "Startup: device " << i << " opened in " << duration_cast<milliseconds>(high_resolution_clock::now() - t0).count() << " ms"; });
+	timer.phase("devices");
+
+	// set up the decoding model(s), group is the last output group used
+	for (int i = 0; i < (int)receivers.size(); i++)
+		receivers[i]->setupModel(group, i);
+
 	// sharing is on by default as soon as there is anything to share with
 	if (!xshare_defined && !comm_feed && (has_server || !msg.empty()))
 	{
@@ -130,13 +402,25 @@ void Engine::run(WebViewer *viewer, ControlCore *control)
 		o->SetKey(AIS::KEY_SETTING_GROUPS_IN, std::to_string(mask));
 	}
 
+	// what the routers take is fixed from here on, reload() checks against it
+	if (control)
+		for (auto &o : msg)
+			if (o->usesJSONStream())
+			{
+				json_routes = true;
+				json_keys.merge(o->jsonKeys());
+			}
+
 	for (int i = 0; i < (int)receivers.size(); i++)
 	{
 		Receiver &r = *receivers[i];
 
 		// set up all the output and connect to the receiver outputs
-		for (auto &o : msg)
-			o->Connect(r);
+		if (control)
+			connectRouters(r);
+		else
+			for (auto &o : msg)
+				o->Connect(r);
 
 		if (!control)
 			screen.Connect(r);
@@ -162,7 +446,7 @@ void Engine::run(WebViewer *viewer, ControlCore *control)
 	// before attachEngine(), so the trackers are built with these already applied
 	for (auto *v : viewers)
 	{
-		v->setOutputChannels(msg);
+		v->setOutputChannels(&msg);
 		v->setCommFeed(comm_feed);
 
 		if (own_mmsi != -1)
@@ -181,8 +465,15 @@ void Engine::run(WebViewer *viewer, ControlCore *control)
 			for (int j = 0; j < r->Count(); j++)
 				r->Output(j).Connect((StreamIn<AIS::Message> *)&control->getChannelActivity());
 
-	for (auto &o : msg)
-		o->Start();
+	timer.phase("wiring");
+
+	// managed mode reaches the outputs through the routers, so the receivers
+	// can go first and each output joins as soon as it is up
+	if (!control)
+	{
+		startOutputs(false);
+		timer.phase("outputs");
+	}
 
 #ifdef HASWEBVIEWER
 	// the engine owns only the servers it built; the managed viewer is already
@@ -195,6 +486,16 @@ void Engine::run(WebViewer *viewer, ControlCore *control)
 	Debug() << "Starting receivers";
 	for (auto &r : receivers)
 		r->play();
+	timer.phase("receivers");
+
+	if (control)
+	{
+		startOutputs(true);
+		publishOutputs();
+		timer.phase("outputs");
+	}
+
+	Info() << "Startup: " << timer.summary();
 
 	if (control)
 	{
@@ -233,6 +534,10 @@ void Engine::run(WebViewer *viewer, ControlCore *control)
 		if (iscallback)
 			std::this_thread::sleep_for(std::chrono::milliseconds(SLEEP));
 
+		// a restart from the control API, applied here so the receivers keep running
+		if (control && control->consumeReloadRequest() && !reload(*control))
+			control->rebuildEngine();
+
 #ifdef HASWEBVIEWER
 		// above the verbose/timeout shortcut below or it never runs by default
 		if (--tick_countdown <= 0)
@@ -266,6 +571,11 @@ void Engine::run(WebViewer *viewer, ControlCore *control)
 						Info() << alignModelName(name) << "received: " << stat[i].statistics[j]->getDeltaCount() << " msgs, total: "
 							   << stat[i].statistics[j]->getCount() << " msgs, rate: " << stat[i].statistics[j]->getRate() << " msg/s";
 					}
+
+					Device::Device *device = r.getDeviceManager().getDevice();
+					if (device)
+						for (const std::string &line : device->getStatistics())
+							Info() << line;
 				}
 			}
 		}
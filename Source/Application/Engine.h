@@ -22,6 +22,7 @@
 
 #include "Receiver.h"
 #include "Network.h"
+#include "OutputRouter.h"
 #ifdef HASWEBVIEWER
 #include "WebViewer.h"
 
@@ -52,6 +53,9 @@ struct Engine {
 	// Community feed output, owned by msg; set up at most once
 	IO::OutputMessage *comm_feed = nullptr;
 
+	// the config this engine was read from less the fields reload() applies
+	std::string config_core;
+
 	// Screen and statistics
 	IO::ScreenOutput screen;
 	std::vector<OutputStatistics> stat;
@@ -91,6 +95,10 @@ struct Engine {
 	// into this object. Idempotent.
 	void detach();
 
+	// Managed mode: bring the outputs in line with the config file while the
+	// receivers keep running. False if the change needs a new engine.
+	bool reload(ControlCore &control);
+
 	// Each device option on the command line / in config defines a new receiver,
 	// except the first which reuses the default-constructed one.
 	Receiver &newReceiver() {
@@ -120,4 +128,21 @@ private:
 	// the viewer run() was handed, kept so detach() can reach it
 	WebViewer *attached_viewer = nullptr;
 	bool detached = false;
+
+#ifdef HASWEBVIEWER
+	// every viewer this run feeds, owned or not
+	std::vector<WebViewer *> viewers;
+#endif
+
+	// managed mode: the receivers reach msg through the routers only
+	IO::OutputTable outputs;
+	std::vector<std::unique_ptr<IO::OutputRouter>> routers;
+	bool json_routes = false; // the routers take the JSON stream, with json_keys
+	AIS::KeySet json_keys;
+	bool http_tags = false;	  // the receivers tag what HTTP outputs need
+
+	void connectRouters(Receiver &r);
+	void publishOutputs();
+	// publish: add each output to the routers once it has started
+	void startOutputs(bool publish);
 };
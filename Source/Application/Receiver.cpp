@@ -110,15 +110,32 @@ void Receiver::setChannel(std::string mode, std::string NMEA)
 }
 
 // Set up Device
+void Receiver::selectDevice()
+{
+	if (!deviceManager.selectDevice())
+		throw std::runtime_error("Receiver: cannot set up device.");
+}
+
 void Receiver::setupDevice()
 {
 	int frequency = (ChannelMode == AIS::Mode::AB) ? 162000000 : 156800000;
+	int rate = sample_rate;
+
+	// a Mode-S model listens at 1090 MHz, by default at the rate it is built for
+	for (const auto &m : models)
+		if (m->getClass() == AIS::ModelClass::MODES)
+		{
+			frequency = 1090000000;
+			if (!rate)
+				rate = 2400000;
+			break;
+		}
 
 	tag.version = VERSION_NUMBER;
 	tag.station_lat = station_lat;
 	tag.station_lon = station_lon;
 
-	if (!deviceManager.openDevice(sample_rate, bandwidth, ppm, frequency, tag))
+	if (!deviceManager.openDevice(rate, bandwidth, ppm, frequency, tag))
 		throw std::runtime_error("Receiver: cannot set up device.");
 }
 
@@ -190,6 +207,12 @@ std::unique_ptr<AIS::Model> &Receiver::addModel(int m)
 	case 11:
 		models.push_back(std::unique_ptr<AIS::Model>(new AIS::ModelEngineV2()));
 		break;
+	case 12:
+		models.push_back(std::unique_ptr<AIS::Model>(new AIS::ModelEdge()));
+		break;
+	case 13:
+		models.push_back(std::unique_ptr<AIS::Model>(new AIS::ModelModeS()));
+		break;
 	default:
 		throw std::runtime_error("Model not implemented in this version. Check in later.");
 	}
@@ -211,6 +234,9 @@ void Receiver::setupModel(int &group, int idx)
 			(m->getClass() != AIS::ModelClass::TXT && device->getFormat() == Format::TXT) ||
 			(m->getClass() == AIS::ModelClass::BASESTATION && (device->getFormat() != Format::BASESTATION && device->getFormat() != Format::BEAST && device->getFormat() != Format::RAW1090)))
 			throw std::runtime_error("Decoding model and input format not consistent.");
+
+		if ((m->getClass() == AIS::ModelClass::MODES) != (models[0]->getClass() == AIS::ModelClass::MODES))
+			throw std::runtime_error("Receiver: Mode-S and AIS models cannot share a device.");
 	}
 
 	// build the decoder models
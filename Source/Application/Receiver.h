@@ -144,7 +144,12 @@ public:
 	Connection<AIS::GPS> &OutputGPS(int i) { return models[i]->OutputGPS().out; }
 	Connection<Plane::ADSB> &OutputADSB(int i) { return models[i]->OutputADSB().out; }
 
-	Connection<JSON::JSON> &OutputJSON(int i) { return jsonais[i]->out; }
+	// the caller connects to the JSON and reads the fields in keys
+	Connection<JSON::JSON> &OutputJSON(int i, const AIS::KeySet &keys = AIS::KeySet::all())
+	{
+		jsonais[i]->require(keys);
+		return jsonais[i]->out;
+	}
 
 	std::unique_ptr<AIS::Model> &addModel(int m);
 	std::unique_ptr<AIS::Model> &Model(int i) { return models[i]; }
@@ -170,6 +175,8 @@ public:
 		return mask;
 	}
 
+	// claim the device, in receiver order; setupDevice() then opens it
+	void selectDevice();
 	void setupDevice();
 	void setupModel(int &g, int idx);
 
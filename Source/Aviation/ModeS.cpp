@@ -0,0 +1,261 @@
+/*
+    Copyright(c) 2021-2026 jvde.github@gmail.com
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include "ModeS.h"
+
+namespace
+{
+    // magnitude of an I/Q byte pair, full scale at 65535
+    struct MagnitudeTable
+    {
+        uint16_t v[256 * 256];
+        MagnitudeTable()
+        {
+            const float scale = 65535.0f / (127.5f * std::sqrt(2.0f));
+
+            for (int i = 0; i < 256; i++)
+                for (int q = 0; q < 256; q++)
+                {
+                    const float I = i - 127.5f, Q = q - 127.5f;
+                    v[(i << 8) | q] = (uint16_t)std::lrint(std::sqrt(I * I + Q * Q) * scale);
+                }
+        }
+    };
+    static const MagnitudeTable magnitude;
+
+    // syndrome of a single bit error in a long frame -> the bit
+    struct SyndromeTable
+    {
+        std::unordered_map<uint32_t, int> bit;
+        SyndromeTable()
+        {
+            Plane::ADSB m;
+            m.len = Plane::ADSB::MAX_BYTES;
+
+            // the DF field is not repaired: an error there changes the length
+            for (int b = 5; b < Plane::ADSB::MAX_BYTES * 8; b++)
+            {
+                std::memset(m.msg, 0, sizeof(m.msg));
+                m.msg[b >> 3] = 0x80 >> (b & 7);
+
+                const uint32_t parity = ((uint32_t)m.msg[11] << 16) | ((uint32_t)m.msg[12] << 8) | m.msg[13];
+                bit[m.calcCRC() ^ parity] = b;
+            }
+        }
+    };
+    static const SyndromeTable single_bit;
+
+    bool isModeS(int df)
+    {
+        switch (df)
+        {
+        case 0: case 4: case 5: case 11: case 16: case 17: case 18: case 20: case 21:
+            return true;
+        }
+        return false;
+    }
+}
+
+ModeS::ModeS()
+{
+    for (int p = 0; p < PHASES; p++)
+    {
+        for (int h = 0; h < LONG_BITS * 2; h++)
+        {
+            // half bit h of the data spans [a, a + 1.2) samples
+            const float a = (float)p / PHASES + (16 + h) * 1.2f;
+            Window &w = windows[p][h];
+
+            w.idx = (int)a;
+            for (int k = 0; k < 3; k++)
+            {
+                const float lo = std::max(a, (float)(w.idx + k)), hi = std::min(a + 1.2f, (float)(w.idx + k + 1));
+                w.w[k] = std::max(0.0f, hi - lo);
+            }
+        }
+    }
+}
+
+// Slices the bits of the frame at m for one phase into msg, returns the
+// number of bits or 0 if the downlink format is not one we decode
+int ModeS::demodulate(const uint16_t *m, int phase, FLOAT32 &level)
+{
+    const Window *w = windows[phase];
+    int bits = LONG_BITS;
+    float sum = 0.0f;
+
+    std::memset(msg.msg, 0, sizeof(msg.msg));
+
+    for (int i = 0; i < bits; i++)
+    {
+        const Window &a = w[2 * i], &b = w[2 * i + 1];
+        const float *wa = a.w, *wb = b.w;
+        const uint16_t *ma = m + a.idx, *mb = m + b.idx;
+
+        const float x = wa[0] * ma[0] + wa[1] * ma[1] + wa[2] * ma[2];
+        const float y = wb[0] * mb[0] + wb[1] * mb[1] + wb[2] * mb[2];
+
+        if (x > y)
+        {
+            msg.msg[i >> 3] |= 0x80 >> (i & 7);
+            sum += x;
+        }
+        else
+            sum += y;
+
+        if (i == 4)
+        {
+            msg.df = msg.msg[0] >> 3;
+            if (!isModeS(msg.df))
+                return 0;
+
+            bits = msg.getMessageLength(msg.df) * 8;
+        }
+    }
+
+    msg.len = bits / 8;
+    level = sum / (bits * 1.2f * 65535.0f);
+    return bits;
+}
+
+bool ModeS::validate()
+{
+    const uint8_t *p = msg.msg + msg.len - 3;
+    const uint32_t parity = ((uint32_t)p[0] << 16) | ((uint32_t)p[1] << 8) | p[2];
+    const uint32_t syndrome = msg.calcCRC() ^ parity;
+
+    switch (msg.df)
+    {
+    case 17:
+    case 18:
+        if (syndrome)
+        {
+            auto it = single_bit.bit.find(syndrome);
+            if (it == single_bit.bit.end())
+                return false;
+
+            msg.msg[it->second >> 3] ^= 0x80 >> (it->second & 7);
+        }
+        return true;
+    case 11:
+        // the parity carries the interrogator code
+        return syndrome < 80;
+    default:
+        // the parity carries the address
+        return known.count(syndrome) > 0;
+    }
+}
+
+void ModeS::process(TAG &tag)
+{
+    const int n = (int)mag.size();
+    int j = 0;
+
+    for (; j + FRAME_SAMPLES <= n; j++)
+    {
+        const uint16_t *m = mag.data() + j;
+
+        // preamble: pulses at 0, 1, 3.5 and 4.5 us; samples 5-7 and 14-17 are
+        // quiet and samples 0/1, 3, 9 and 11/12 in a pulse, whatever the phase
+        const int quiet = m[5] + m[6] + m[7] + m[14] + m[15] + m[16] + m[17];
+        const int ref = 3 * quiet / 14; // 1.5 times the mean quiet level
+
+        if (std::max(m[0], m[1]) <= ref || m[3] <= ref || m[9] <= ref || std::max(m[11], m[12]) <= ref)
+            continue;
+
+        for (int p = 0; p < PHASES; p++)
+        {
+            FLOAT32 level;
+
+            msg.reset(rxtime_cache);
+
+            const int bits = demodulate(m, p, level);
+            if (!bits || !validate())
+                continue;
+
+            const uint64_t idx = sample_idx + j;
+
+            if (msg.df == 11 || msg.df == 17 || msg.df == 18)
+                known[((uint32_t)msg.msg[1] << 16) | ((uint32_t)msg.msg[2] << 8) | msg.msg[3]] = idx;
+
+            msg.msgtype = msg.len == 7 ? '2' : '3';
+            // 12 MHz clock, as on a Beast feed
+            msg.timestamp = (std::time_t)(idx * 5 + p);
+            msg.signalLevel = level > 0 ? 20.0f * std::log10(level) : LEVEL_UNDEFINED;
+
+            msg.Decode();
+            Send(&msg, 1, tag);
+
+            j += PREAMBLE_SAMPLES + bits * 12 / 5 - 1;
+            break;
+        }
+    }
+
+    mag.erase(mag.begin(), mag.begin() + j);
+    sample_idx += j;
+
+    // forget addresses not heard from for a while
+    const uint64_t timeout = (uint64_t)KNOWN_TIMEOUT * 2400000;
+
+    if (sample_idx > known_cleanup + timeout)
+    {
+        for (auto it = known.begin(); it != known.end();)
+        {
+            if (sample_idx - it->second > timeout)
+                it = known.erase(it);
+            else
+                ++it;
+        }
+        known_cleanup = sample_idx;
+    }
+}
+
+void ModeS::Receive(const RAW *data, int len, TAG &tag)
+{
+    std::time(&rxtime_cache);
+
+    for (int j = 0; j < len; j++)
+    {
+        // CS8 is CU8 with the sign bit flipped
+        const uint8_t flip = data[j].format == Format::CS8 ? 0x80 : 0x00;
+        const uint8_t *src = (const uint8_t *)data[j].data;
+        const uint8_t *const end = src + data[j].size;
+
+        if (has_odd && src < end)
+        {
+            mag.push_back(magnitude.v[((odd_byte ^ flip) << 8) | (*src++ ^ flip)]);
+            has_odd = false;
+        }
+
+        mag.reserve(mag.size() + (end - src) / 2);
+
+        for (; src + 1 < end; src += 2)
+            mag.push_back(magnitude.v[((src[0] ^ flip) << 8) | (src[1] ^ flip)]);
+
+        if (src < end)
+        {
+            odd_byte = *src;
+            has_odd = true;
+        }
+    }
+
+    process(tag);
+}
@@ -0,0 +1,78 @@
+/*
+    Copyright(c) 2021-2026 jvde.github@gmail.com
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <ctime>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "Common.h"
+#include "Stream.h"
+#include "ADSB.h"
+
+// Mode-S demodulator for 1090 MHz IQ at 2.4 Msps (CU8 or CS8).
+//
+// At 2.4 Msps a half bit of 0.5 us is 1.2 samples, so the pulses never line
+// up with the samples. For each of PHASES sub-sample offsets of the frame the
+// half-bit windows are precomputed as up to three weighted magnitude samples;
+// a bit is the comparison of its two halves. A cheap integer test on the
+// preamble gates the full demodulation of a candidate.
+//
+// DF11/17/18 frames are checked against their CRC, DF17/18 with a single bit
+// error are repaired from the CRC syndrome. Frames with the address in the
+// parity field (DF0/4/5/16/20/21) are only accepted for addresses recently
+// seen in a DF11/17/18 frame.
+class ModeS : public SimpleStreamInOut<RAW, Plane::ADSB>
+{
+    static constexpr int PHASES = 5;
+    static constexpr int LONG_BITS = 112;
+    static constexpr int PREAMBLE_SAMPLES = 19;                                       // 8 us
+    static constexpr int FRAME_SAMPLES = PREAMBLE_SAMPLES + LONG_BITS * 12 / 5 + 4; // with the phase and window overhang
+    static constexpr int KNOWN_TIMEOUT = 60;                                          // seconds an address stays known
+
+    struct Window
+    {
+        int idx;
+        float w[3];
+    };
+
+    // half-bit windows of the data, per phase
+    Window windows[PHASES][LONG_BITS * 2];
+
+    std::vector<uint16_t> mag;
+    uint8_t odd_byte = 0;
+    bool has_odd = false;
+
+    uint64_t sample_idx = 0; // of mag[0]
+    std::unordered_map<uint32_t, uint64_t> known; // address -> sample last heard
+    uint64_t known_cleanup = 0;
+
+    Plane::ADSB msg;
+    std::time_t rxtime_cache = 0;
+
+    int demodulate(const uint16_t *m, int phase, FLOAT32 &level);
+    bool validate();
+    void process(TAG &tag);
+
+public:
+    ModeS();
+    virtual ~ModeS() {}
+
+    void Receive(const RAW *data, int len, TAG &tag);
+};
@@ -128,6 +128,7 @@ void ControlCore::stopEngine()
 		std::lock_guard<std::mutex> lock(mtx);
 		desired = false;
 		restart_pending = false;
+		reload_pending = false;
 		resetRetry();
 		status_epoch++;
 	}
@@ -143,19 +144,36 @@ void ControlCore::restartEngine()
 		std::lock_guard<std::mutex> lock(mtx);
 		desired = true;
 		running = (state == EngineState::Running);
-		restart_pending = running;
-		resetRetry();
-		auto_retry = running;
+		if (!running)
+		{
+			restart_pending = false;
+			resetRetry();
+		}
 		status_epoch++;
 	}
 	persistEngineField(true);
 
+	// the engine falls back to rebuildEngine() for what it cannot reload
 	if (running)
-		StopRequest();
+		reload_pending = true;
 	else
 		cv.notify_all();
 }
 
+void ControlCore::rebuildEngine()
+{
+	{
+		std::lock_guard<std::mutex> lock(mtx);
+		if (state != EngineState::Running)
+			return;
+		restart_pending = true;
+		resetRetry();
+		auto_retry = true;
+		status_epoch++;
+	}
+	StopRequest();
+}
+
 ControlCore::EngineState ControlCore::getEngineState()
 {
 	std::lock_guard<std::mutex> lock(mtx);
@@ -548,6 +566,8 @@ void ControlCore::reportRunning()
 	std::lock_guard<std::mutex> lock(mtx);
 	state = EngineState::Running;
 	engine_start_time = std::time(nullptr);
+	// this engine was built from the current config file
+	reload_pending = false;
 	auto_retry = false;
 	status_epoch++;
 }
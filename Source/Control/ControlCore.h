@@ -62,7 +62,10 @@ public:
 
 	void startEngine();
 	void stopEngine();
+	// a running engine applies what it can of the config file in place
 	void restartEngine();
+	// tear the running engine down and build it again from the config file
+	void rebuildEngine();
 
 	EngineState getEngineState();
 	long long getUptime();
@@ -79,6 +82,9 @@ public:
 	// so the viewer is only ever reconfigured from the thread that owns it.
 	bool consumeConfigChanged() { return config_dirty.exchange(false); }
 
+	// True once per restart of a running engine; polled by its main loop
+	bool consumeReloadRequest() { return reload_pending.exchange(false); }
+
 	ChannelActivity &getChannelActivity() { return channel_activity; }
 
 	int getControlPort() const { return control_port; }
@@ -130,6 +136,7 @@ private:
 	std::condition_variable cv;
 	bool desired = false;
 	bool restart_pending = false;
+	std::atomic<bool> reload_pending{false};
 	EngineState state = EngineState::Stopped;
 	std::time_t engine_start_time = 0;
 
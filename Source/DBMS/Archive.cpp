@@ -0,0 +1,788 @@
+/*
+	Copyright(c) 2021-2026 jvde.github@gmail.com
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "Archive.h"
+#include "Logger.h"
+#include "Convert.h"
+#include "Helper.h"
+#include "ZIP.h"
+
+// File layout, all integers little-endian:
+//   "AISARCH1", u32 length, schema: varint n, n x (varint len, name, varint scale)
+//   blocks:     "BLK1", u32 rows, i64 t_min, i64 t_max, u32 mmsi_min, u32 mmsi_max,
+//               u8 bloom[32], u8 codec, u32 raw_size, u32 stored_size, payload
+//   payload:    varint words, words x (varint len, bytes),
+//               per column: u32 length, presence bitmap, varint per present row
+// Integer columns hold zigzag deltas of value * scale, text columns an index
+// into the block's word list. Codec 1 is gzip, 0 stores the payload as is.
+
+namespace IO
+{
+	static const char FILE_MAGIC[] = "AISARCH1";
+	static const char BLOCK_MAGIC[] = "BLK1";
+	static const size_t BLOCK_HEADER = 4 + 4 + 8 + 8 + 4 + 4 + 32 + 1 + 4 + 4;
+
+	static const char *FILE_PREFIX = "ais_archive-";
+	static const char *FILE_EXT = ".aca";
+
+	enum
+	{
+		COL_TIME = 0,
+		COL_MMSI,
+		COL_STATION,
+		COL_TYPE,
+		COL_CHANNEL,
+		COL_LEVEL,
+		COL_PPM,
+		COL_POSITION
+	};
+
+	// in keys_position / keys_static order; the names come from the shared column lists
+	static const int scale_position[DatabaseOutput::N_POSITION] = {1000000, 1000000, 10, 10, 1, 1, 1, 1};
+	static const int scale_static[DatabaseOutput::N_STATIC] = {0, 0, 1, 1, 1, 1, 1, 1, 1, 100, 0, 0};
+
+	static void putVarint(std::string &out, uint64_t v)
+	{
+		while (v >= 0x80)
+		{
+			out += (char)(v | 0x80);
+			v >>= 7;
+		}
+		out += (char)v;
+	}
+
+	static bool getVarint(const char *&p, const char *end, uint64_t &v)
+	{
+		v = 0;
+		for (int shift = 0; p < end && shift < 64; shift += 7)
+		{
+			const uint8_t b = (uint8_t)*p++;
+			v |= (uint64_t)(b & 0x7F) << shift;
+			if (!(b & 0x80))
+				return true;
+		}
+		return false;
+	}
+
+	static uint64_t zigzag(int64_t v) { return ((uint64_t)v << 1) ^ (uint64_t)(v >> 63); }
+	static int64_t unzigzag(uint64_t v) { return (int64_t)(v >> 1) ^ -(int64_t)(v & 1); }
+
+	static void put32(std::string &out, uint32_t v)
+	{
+		for (int i = 0; i < 4; i++)
+			out += (char)(v >> (8 * i));
+	}
+
+	static void put64(std::string &out, uint64_t v)
+	{
+		for (int i = 0; i < 8; i++)
+			out += (char)(v >> (8 * i));
+	}
+
+	static uint32_t get32(const char *p)
+	{
+		uint32_t v = 0;
+		for (int i = 0; i < 4; i++)
+			v |= (uint32_t)(uint8_t)p[i] << (8 * i);
+		return v;
+	}
+
+	static uint64_t get64(const char *p)
+	{
+		uint64_t v = 0;
+		for (int i = 0; i < 8; i++)
+			v |= (uint64_t)(uint8_t)p[i] << (8 * i);
+		return v;
+	}
+
+	// two bits of 256 per MMSI: a false positive costs one block inflated for nothing
+	static void bloomBits(uint32_t mmsi, int &a, int &b)
+	{
+		a = (int)((mmsi * 2654435761u) >> 24);
+		b = (int)(((mmsi ^ (mmsi >> 15)) * 2246822519u) >> 24);
+	}
+
+	static void splitNames(const std::string &list, std::vector<std::string> &out)
+	{
+		size_t p = 0;
+		while (p <= list.size())
+		{
+			size_t e = list.find(',', p);
+			if (e == std::string::npos)
+				e = list.size();
+			out.push_back(list.substr(p, e - p));
+			p = e + 1;
+		}
+	}
+
+	const std::vector<Archive::ColumnDef> &Archive::schema()
+	{
+		static const std::vector<ColumnDef> s = []()
+		{
+			std::vector<ColumnDef> s = {{"received_at", 1}, {"mmsi", 1}, {"station_id", 1}, {"type", 1}, {"channel", 0}, {"signal_level", 100}, {"ppm", 100}};
+
+			// drop the leading msg_id of the shared lists
+			std::vector<std::string> pos, sta;
+			splitNames(columnList(ST_POSITION), pos);
+			splitNames(columnList(ST_STATIC), sta);
+
+			for (int i = 0; i < N_POSITION; i++)
+				s.push_back({pos[1 + i], scale_position[i]});
+			for (int i = 0; i < N_STATIC; i++)
+				s.push_back({sta[1 + i], scale_static[i]});
+
+			s.push_back({"nmea", 0});
+			return s;
+		}();
+		return s;
+	}
+
+	void Archive::Block::clear(size_t n_cols)
+	{
+		day = -1;
+		rows = 0;
+		std::memset(bloom, 0, sizeof(bloom));
+
+		cols.resize(n_cols);
+		for (auto &c : cols)
+		{
+			c.present.clear();
+			c.values.clear();
+		}
+
+		words.clear();
+		dict.clear();
+	}
+
+	void Archive::connectDB()
+	{
+		// empty ("-D archive:") means cwd; dir doubles as the connected flag
+		dir = conn_string.empty() ? "." : conn_string;
+		if (dir[dir.size() - 1] != '/')
+			dir += '/';
+
+		const std::string probe = dir + ".aiscatcher-archive";
+		std::ofstream t(probe.c_str());
+		if (!t.is_open())
+		{
+			stats.connect_fail++;
+			dir.clear();
+			throw std::runtime_error("DBMS: cannot write to directory \"" + (conn_string.empty() ? std::string(".") : conn_string) + "\", does it exist?");
+		}
+		t.close();
+		std::remove(probe.c_str());
+
+		if (block.cols.empty())
+			block.clear(schema().size());
+
+		Debug() << "DBMS: writing archive files to " << dir << (ZIP::installed() ? "" : " (no zlib: blocks stored uncompressed)");
+	}
+
+	void Archive::addInt(int c, const char *v)
+	{
+		Column &col = block.cols[c];
+
+		char *end = nullptr;
+		const double d = v ? std::strtod(v, &end) : 0;
+
+		// booleans and other non-numbers are left out, never written as 0
+		if (!v || end == v || !std::isfinite(d))
+		{
+			col.present.push_back(0);
+			return;
+		}
+
+		col.present.push_back(1);
+		col.values.push_back((int64_t)std::llround(d * schema()[c].scale));
+	}
+
+	void Archive::addText(int c, const char *v)
+	{
+		Column &col = block.cols[c];
+		if (!v || !*v)
+		{
+			col.present.push_back(0);
+			return;
+		}
+
+		auto it = block.dict.find(v);
+		if (it == block.dict.end())
+		{
+			it = block.dict.emplace(v, (uint32_t)block.words.size()).first;
+			block.words.push_back(v);
+		}
+
+		col.present.push_back(1);
+		col.values.push_back(it->second);
+	}
+
+	void Archive::addRow(const QueuedEntry &entry)
+	{
+		const RowArena::Row &r = *entry.row;
+		const long day = (long)(r.rxtime / 86400);
+
+		// a block never spans two day files
+		if (block.rows && day != block.day)
+			writeBlock();
+
+		if (block.rows == 0)
+		{
+			block.day = day;
+			block.opened = std::time(nullptr);
+			block.t_min = block.t_max = r.rxtime;
+			block.mmsi_min = block.mmsi_max = r.mmsi;
+		}
+
+		block.t_min = MIN(block.t_min, r.rxtime);
+		block.t_max = MAX(block.t_max, r.rxtime);
+		block.mmsi_min = MIN(block.mmsi_min, r.mmsi);
+		block.mmsi_max = MAX(block.mmsi_max, r.mmsi);
+
+		int a, b;
+		bloomBits(r.mmsi, a, b);
+		block.bloom[a >> 3] |= 1 << (a & 7);
+		block.bloom[b >> 3] |= 1 << (b & 7);
+
+		auto integer = [this](int c, int64_t v)
+		{
+			block.cols[c].present.push_back(1);
+			block.cols[c].values.push_back(v);
+		};
+
+		integer(COL_TIME, r.rxtime);
+		integer(COL_MMSI, r.mmsi);
+		integer(COL_STATION, r.station_id);
+		integer(COL_TYPE, r.msg_type);
+		addText(COL_CHANNEL, entry.channel);
+		addInt(COL_LEVEL, entry.has_level ? entry.level : nullptr);
+		addInt(COL_PPM, entry.has_ppm ? entry.ppm : nullptr);
+
+		std::vector<const char *> params;
+		if (logsPosition(entry))
+			positionParams(entry, nullptr, params);
+		else
+			params.assign(1 + N_POSITION, nullptr);
+
+		for (int i = 0; i < N_POSITION; i++)
+			addInt(COL_POSITION + i, params[1 + i]);
+
+		if (logsStatic(entry))
+			staticParams(entry, nullptr, params);
+		else
+			params.assign(1 + N_STATIC, nullptr);
+
+		for (int i = 0; i < N_STATIC; i++)
+		{
+			const int c = COL_POSITION + N_POSITION + i;
+			if (scale_static[i])
+				addInt(c, params[1 + i]);
+			else
+				addText(c, params[1 + i]);
+		}
+
+		addText(COL_POSITION + N_POSITION + N_STATIC, NMEA ? entry.nmea : nullptr);
+
+		if (++block.rows >= BLOCK_ROWS)
+			writeBlock();
+	}
+
+	bool Archive::openDay(long day)
+	{
+		if (file.is_open())
+			file.close();
+
+		file_day = -1;
+		const std::string path = dir + FILE_PREFIX + Util::Convert::toDateStr((std::time_t)day * 86400) + FILE_EXT;
+
+		std::ifstream probe(path.c_str(), std::ios::binary | std::ios::ate);
+		const bool fresh = !probe.good() || probe.tellg() <= 0;
+		probe.close();
+
+		file.open(path.c_str(), std::ios::out | std::ios::app | std::ios::binary);
+		if (!file.is_open())
+		{
+			Error() << "DBMS: cannot open " << path;
+			return false;
+		}
+
+		if (fresh)
+		{
+			std::string s;
+			putVarint(s, schema().size());
+			for (const auto &c : schema())
+			{
+				putVarint(s, c.name.size());
+				s += c.name;
+				putVarint(s, (uint64_t)c.scale);
+			}
+
+			std::string hdr(FILE_MAGIC, 8);
+			put32(hdr, (uint32_t)s.size());
+			file << hdr << s;
+		}
+
+		file_day = day;
+		return file.good();
+	}
+
+	bool Archive::writeBlock()
+	{
+		if (block.rows == 0)
+			return true;
+
+		raw.clear();
+		putVarint(raw, block.words.size());
+		for (const auto &w : block.words)
+		{
+			putVarint(raw, w.size());
+			raw += w;
+		}
+
+		for (size_t c = 0; c < block.cols.size(); c++)
+		{
+			const Column &col = block.cols[c];
+			const size_t len_at = raw.size();
+			put32(raw, 0);
+
+			for (size_t i = 0; i < block.rows; i += 8)
+			{
+				uint8_t bits = 0;
+				for (size_t k = 0; k < 8 && i + k < block.rows; k++)
+					bits |= col.present[i + k] << k;
+				raw += (char)bits;
+			}
+
+			// text indexes go as is, numbers as the change from the previous row
+			const bool text = schema()[c].scale == 0;
+			int64_t prev = 0;
+			for (int64_t v : col.values)
+			{
+				putVarint(raw, text ? (uint64_t)v : zigzag(v - prev));
+				prev = v;
+			}
+
+			const uint32_t len = (uint32_t)(raw.size() - len_at - 4);
+			for (int i = 0; i < 4; i++)
+				raw[len_at + i] = (char)(len >> (8 * i));
+		}
+
+		ZIP zip;
+		const bool packed = ZIP::installed() && zip.zip(raw) && zip.getOutputLength() < raw.size();
+		const char *payload = packed ? zip.getOutputPtr() : raw.data();
+		const size_t stored = packed ? zip.getOutputLength() : raw.size();
+
+		std::string hdr(BLOCK_MAGIC, 4);
+		put32(hdr, (uint32_t)block.rows);
+		put64(hdr, (uint64_t)block.t_min);
+		put64(hdr, (uint64_t)block.t_max);
+		put32(hdr, block.mmsi_min);
+		put32(hdr, block.mmsi_max);
+		hdr.append((const char *)block.bloom, sizeof(block.bloom));
+		hdr += (char)(packed ? 1 : 0);
+		put32(hdr, (uint32_t)raw.size());
+		put32(hdr, (uint32_t)stored);
+
+		bool ok = file_day == block.day || openDay(block.day);
+		if (ok)
+		{
+			file.write(hdr.data(), hdr.size());
+			file.write(payload, stored);
+			file.flush();
+			ok = file.good();
+		}
+
+		// a full disk must not grow the block without bound: the rows are dropped
+		if (ok)
+			stats.bytes_out += hdr.size() + stored;
+		else
+		{
+			Error() << "DBMS: archive dropped " << block.rows << " rows, write failed";
+			file.close();
+			file_day = -1;
+		}
+
+		block.clear(block.cols.size());
+		return ok;
+	}
+
+	bool Archive::writeBatch(const std::vector<QueuedEntry> &batch)
+	{
+		for (const auto &entry : batch)
+			addRow(entry);
+
+		return true;
+	}
+
+	void Archive::flushed()
+	{
+		if (block.rows && std::time(nullptr) - block.opened >= BLOCK_AGE)
+			writeBlock();
+	}
+
+	void Archive::maintain()
+	{
+		pruneFiles();
+	}
+
+	void Archive::pruneFiles()
+	{
+		if (retention_days <= 0 || dir.empty())
+			return;
+
+		const std::string cutoff = Util::Convert::toDateStr(retentionCutoff());
+		const std::string prefix = FILE_PREFIX;
+		for (const auto &path : Util::Helper::getFilesWithExtension(dir, FILE_EXT))
+		{
+			const std::string name = path.substr(path.find_last_of("/\\") + 1);
+			if (name.size() == prefix.size() + 14 && name.compare(0, prefix.size(), prefix) == 0 &&
+				name.substr(prefix.size(), 10) < cutoff)
+				std::remove(path.c_str());
+		}
+	}
+
+	void Archive::closeDB()
+	{
+		if (file.is_open())
+			file.close();
+	}
+
+	Archive::~Archive()
+	{
+		// the worker's final flush fills the block, this writes it
+		stopWorker();
+		if (!dir.empty())
+			writeBlock();
+		closeDB();
+	}
+
+	// -------------------------------
+	// reader
+
+	static void csvField(std::ostream &out, const std::string &v)
+	{
+		if (v.find_first_of(",\"\n\r") == std::string::npos)
+		{
+			out << v;
+			return;
+		}
+
+		out << '"';
+		for (char c : v)
+		{
+			if (c == '\n' || c == '\r')
+				c = ' ';
+			if (c == '"')
+				out << '"';
+			out << c;
+		}
+		out << '"';
+	}
+
+	static void printScaled(std::ostream &out, int64_t v, int scale)
+	{
+		char buf[32];
+		if (scale <= 1)
+			std::snprintf(buf, sizeof(buf), "%lld", (long long)v);
+		else
+		{
+			const int digits = (int)std::lround(std::log10((double)scale));
+			std::snprintf(buf, sizeof(buf), "%.*f", digits, (double)v / scale);
+		}
+		out << buf;
+	}
+
+	struct DecodedColumn
+	{
+		std::vector<uint8_t> present;
+		std::vector<int64_t> values; // one per row, valid where present
+	};
+
+	// false on a corrupt payload
+	static bool decodeBlock(const char *p, const char *end, size_t rows, size_t n_cols,
+							std::vector<std::string> &words, std::vector<DecodedColumn> &cols)
+	{
+		uint64_t n, len;
+		if (!getVarint(p, end, n))
+			return false;
+
+		words.clear();
+		for (uint64_t i = 0; i < n; i++)
+		{
+			if (!getVarint(p, end, len) || len > (uint64_t)(end - p))
+				return false;
+			words.emplace_back(p, (size_t)len);
+			p += len;
+		}
+
+		cols.resize(n_cols);
+		for (size_t c = 0; c < n_cols; c++)
+		{
+			if (end - p < 4)
+				return false;
+			const char *col_end = p + 4 + get32(p);
+			p += 4;
+			if (col_end > end || (size_t)(col_end - p) < (rows + 7) / 8)
+				return false;
+
+			DecodedColumn &col = cols[c];
+			col.present.resize(rows);
+			col.values.assign(rows, 0);
+			for (size_t i = 0; i < rows; i++)
+				col.present[i] = ((uint8_t)p[i >> 3] >> (i & 7)) & 1;
+			p += (rows + 7) / 8;
+
+			col.values.resize(rows);
+			for (size_t i = 0; i < rows; i++)
+			{
+				if (!col.present[i])
+					continue;
+				uint64_t v;
+				if (!getVarint(p, col_end, v))
+					return false;
+				col.values[i] = (int64_t)v;
+			}
+			p = col_end;
+		}
+		return true;
+	}
+
+	struct ReadStats
+	{
+		long rows = 0, blocks = 0, skipped = 0, corrupt = 0;
+	};
+
+	static void extractFile(const std::string &path, std::time_t from, std::time_t to,
+							const std::vector<uint32_t> &mmsi, std::ostream &out, bool &header, ReadStats &rs)
+	{
+		std::ifstream f(path.c_str(), std::ios::binary);
+		char buf[BLOCK_HEADER];
+
+		if (!f.read(buf, 12) || std::memcmp(buf, FILE_MAGIC, 8) != 0)
+		{
+			Warning() << "DBMS: " << path << " is not an archive file";
+			return;
+		}
+
+		std::string s(get32(buf + 8), '\0');
+		if (!f.read(&s[0], s.size()))
+			return;
+
+		// the file describes its own columns
+		std::vector<Archive::ColumnDef> cols;
+		const char *p = s.data(), *end = s.data() + s.size();
+		uint64_t n, len, scale;
+		if (!getVarint(p, end, n))
+			return;
+		for (uint64_t i = 0; i < n; i++)
+		{
+			if (!getVarint(p, end, len) || len > (uint64_t)(end - p))
+				return;
+			std::string name(p, (size_t)len);
+			p += len;
+			if (!getVarint(p, end, scale))
+				return;
+			cols.push_back({name, (int)scale});
+		}
+
+		if (cols.size() < COL_POSITION)
+		{
+			Warning() << "DBMS: " << path << " has an unknown column layout";
+			return;
+		}
+
+		if (!header)
+		{
+			for (size_t c = 0; c < cols.size(); c++)
+				out << (c ? "," : "") << cols[c].name;
+			out << '\n';
+			header = true;
+		}
+
+		// keep only the bloom bits and range of the selection
+		uint32_t sel_min = 0xFFFFFFFF, sel_max = 0;
+		for (uint32_t m : mmsi)
+		{
+			sel_min = MIN(sel_min, m);
+			sel_max = MAX(sel_max, m);
+		}
+
+		std::string payload;
+		std::vector<std::string> words;
+		std::vector<DecodedColumn> decoded;
+		ZIP zip;
+
+		while (f.read(buf, BLOCK_HEADER))
+		{
+			if (std::memcmp(buf, BLOCK_MAGIC, 4) != 0)
+			{
+				// a torn tail from a crash ends the readable part of the file
+				rs.corrupt++;
+				break;
+			}
+
+			const size_t rows = get32(buf + 4);
+			const std::time_t t_min = (std::time_t)get64(buf + 8), t_max = (std::time_t)get64(buf + 16);
+			const uint32_t m_min = get32(buf + 24), m_max = get32(buf + 28);
+			const uint8_t *bloom = (const uint8_t *)buf + 32;
+			const int codec = buf[64];
+			const size_t raw_size = get32(buf + 65), stored = get32(buf + 69);
+
+			bool wanted = t_max >= from && t_min <= to;
+			if (wanted && !mmsi.empty())
+			{
+				wanted = false;
+				if (sel_max >= m_min && sel_min <= m_max)
+					for (uint32_t m : mmsi)
+					{
+						int a, b;
+						bloomBits(m, a, b);
+						if (m >= m_min && m <= m_max && (bloom[a >> 3] >> (a & 7) & 1) && (bloom[b >> 3] >> (b & 7) & 1))
+						{
+							wanted = true;
+							break;
+						}
+					}
+			}
+
+			if (!wanted)
+			{
+				rs.skipped++;
+				f.seekg((std::streamoff)stored, std::ios::cur);
+				continue;
+			}
+
+			payload.resize(stored);
+			if (!f.read(&payload[0], stored))
+			{
+				rs.corrupt++;
+				break;
+			}
+
+			const char *data = payload.data();
+			size_t size = payload.size();
+			if (codec == 1)
+			{
+				if (!zip.unzip(payload.data(), payload.size(), raw_size))
+				{
+					rs.corrupt++;
+					continue;
+				}
+				data = zip.getOutputPtr();
+				size = zip.getOutputLength();
+			}
+			else if (codec != 0)
+			{
+				rs.corrupt++;
+				continue;
+			}
+
+			if (!decodeBlock(data, data + size, rows, cols.size(), words, decoded))
+			{
+				rs.corrupt++;
+				continue;
+			}
+
+			rs.blocks++;
+
+			// undo the deltas per column before filtering rows
+			for (size_t c = 0; c < cols.size(); c++)
+			{
+				if (cols[c].scale == 0)
+					continue;
+				int64_t prev = 0;
+				for (size_t i = 0; i < rows; i++)
+					if (decoded[c].present[i])
+						prev = decoded[c].values[i] = prev + unzigzag((uint64_t)decoded[c].values[i]);
+			}
+
+			for (size_t i = 0; i < rows; i++)
+			{
+				const std::time_t t = (std::time_t)decoded[COL_TIME].values[i];
+				if (t < from || t > to)
+					continue;
+				if (!mmsi.empty() && std::find(mmsi.begin(), mmsi.end(), (uint32_t)decoded[COL_MMSI].values[i]) == mmsi.end())
+					continue;
+
+				out << Util::Convert::toTimestampStr(t);
+				for (size_t c = 1; c < cols.size(); c++)
+				{
+					out << ',';
+					const DecodedColumn &col = decoded[c];
+					if (!col.present[i])
+						continue;
+
+					if (cols[c].scale)
+						printScaled(out, col.values[i], cols[c].scale);
+					else if ((size_t)col.values[i] < words.size())
+						csvField(out, words[(size_t)col.values[i]]);
+				}
+				out << '\n';
+				rs.rows++;
+			}
+		}
+	}
+
+	long Archive::extract(const std::string &path, std::time_t from, std::time_t to,
+						  const std::vector<uint32_t> &mmsi, std::ostream &out)
+	{
+		const auto t0 = std::chrono::steady_clock::now();
+
+		std::vector<std::string> files;
+		if (std::ifstream(path.c_str(), std::ios::binary).good() && path.size() > 4 && path.compare(path.size() - 4, 4, FILE_EXT) == 0)
+			files.push_back(path);
+		else
+		{
+			// day files outside the range are never opened
+			const std::string first = Util::Convert::toDateStr(from), last = Util::Convert::toDateStr(to);
+			const std::string prefix = FILE_PREFIX;
+			for (const auto &f : Util::Helper::getFilesWithExtension(path, FILE_EXT))
+			{
+				const std::string name = f.substr(f.find_last_of("/\\") + 1);
+				if (name.size() != prefix.size() + 14 || name.compare(0, prefix.size(), prefix) != 0)
+					continue;
+				const std::string day = name.substr(prefix.size(), 10);
+				if (day >= first && day <= last)
+					files.push_back(f);
+			}
+			std::sort(files.begin(), files.end());
+		}
+
+		if (files.empty())
+			Warning() << "DBMS: no archive files for this range in " << path;
+
+		bool header = false;
+		ReadStats rs;
+		for (const auto &f : files)
+			extractFile(f, from, to, mmsi, out, header, rs);
+
+		out.flush();
+
+		Info() << "DBMS: archive read " << rs.rows << " rows from " << rs.blocks << " blocks, skipped " << rs.skipped
+			   << " blocks by index in " << Util::Helper::msSince(t0) << " ms";
+		if (rs.corrupt)
+			Warning() << "DBMS: " << rs.corrupt << " corrupt blocks ignored";
+
+		return rs.rows;
+	}
+}
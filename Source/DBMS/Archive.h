@@ -0,0 +1,124 @@
+/*
+	Copyright(c) 2021-2026 jvde.github@gmail.com
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <fstream>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "DatabaseOutput.h"
+
+namespace IO
+{
+
+	// Message log as daily column files: rows are gathered into blocks of up
+	// to BLOCK_ROWS, each column delta- or dictionary-coded and the block
+	// deflated. A block header carries its time and MMSI range plus an MMSI
+	// bloom filter, so a reader skips blocks without inflating them.
+	class Archive : public DatabaseOutput
+	{
+	public:
+		// column coding: integers are scaled to `scale` per unit, text is dictionary coded
+		struct ColumnDef
+		{
+			std::string name;
+			int scale; // 0 for text
+		};
+
+		// streams rows in [from, to] of the day files in `path` (a directory or
+		// one file) as CSV; an empty `mmsi` list selects every vessel
+		static long extract(const std::string &path, std::time_t from, std::time_t to,
+							const std::vector<uint32_t> &mmsi, std::ostream &out);
+
+	private:
+		static const size_t BLOCK_ROWS = 4096;
+
+		// a quiet site still gets its rows on disk: at most this old in memory
+		static const int BLOCK_AGE = 600;
+
+		struct Column
+		{
+			std::vector<uint8_t> present; // one flag per row
+			std::vector<int64_t> values;  // scaled integer or dictionary index, present rows only
+		};
+
+		struct Block
+		{
+			long day = -1;
+			std::time_t opened = 0;
+			size_t rows = 0;
+			std::time_t t_min = 0, t_max = 0;
+			uint32_t mmsi_min = 0, mmsi_max = 0;
+			uint8_t bloom[32];
+
+			std::vector<Column> cols;
+			std::vector<std::string> words;
+			std::unordered_map<std::string, uint32_t> dict;
+
+			void clear(size_t n_cols);
+		};
+
+		// column order of every file written by this build
+		static const std::vector<ColumnDef> &schema();
+
+		std::string dir;
+		std::ofstream file;
+		long file_day = -1;
+
+		Block block;
+		std::string raw; // encode buffer, reused
+
+		void addRow(const QueuedEntry &entry);
+		void addInt(int c, const char *v);
+		void addText(int c, const char *v);
+		bool writeBlock();
+		bool openDay(long day);
+		void pruneFiles();
+		void closeDB();
+
+	protected:
+		void connectDB() override;
+
+		bool ensureConnection() override { return !dir.empty(); }
+		bool prepareAll() override { return true; }
+
+		// every message goes through writeBatch; state and stats are not archived
+		bool exec(int st, const std::vector<const char *> &params) override { return true; }
+		bool execReturningId(int st, const std::vector<const char *> &params, std::string &id) override { return true; }
+
+		// writeBatch only fills the open block, so the batch path is always taken
+		bool begin() override { return true; }
+		bool commit() override { return true; }
+		bool rollback() override { return true; }
+
+		bool writeBatch(const std::vector<QueuedEntry> &batch) override;
+		void flushed() override;
+		void maintain() override;
+
+	public:
+		Archive() : DatabaseOutput("Archive")
+		{
+			conn_string = ".";
+			POSITION = STATIC = true;
+			STATE = STATS = false;
+		}
+		~Archive();
+	};
+}
@@ -83,6 +83,7 @@ namespace IO
 	{
 		std::string sql[DatabaseOutput::ST_COUNT];
 		std::string cols[DatabaseOutput::ST_COUNT];
+		std::string state_params;
 	};
 
 	// No RETURNING clause: the shared text stays portable.
@@ -98,6 +99,7 @@ namespace IO
 		t.cols[DatabaseOutput::ST_POSITION] = "msg_id," + pos;
 		t.cols[DatabaseOutput::ST_STATIC] = "msg_id," + sta;
 		t.cols[DatabaseOutput::ST_STATE] = "mmsi,first_seen,received_at,station_id,signalpower,ppm," + pos + "," + sta + ",count,msg_types,channels";
+		t.state_params = "mmsi,received_at,station_id,signalpower,ppm," + pos + "," + sta + ",msg_types,channels";
 		t.cols[DatabaseOutput::ST_STATS] = "station_id,bucket,msgs,vessels,channel_a,channel_b,channel_c,channel_d,level_min,level_max,ppm";
 
 		t.sql[DatabaseOutput::ST_MESSAGE] = "INSERT INTO ais_message (" + t.cols[DatabaseOutput::ST_MESSAGE] +
@@ -122,7 +124,8 @@ namespace IO
 			const std::string c = colName(i < NP ? keys_position[i] : keys_static[i - NP]);
 			upd += ',' + c + "=COALESCE(EXCLUDED." + c + ",ais_state." + c + ')';
 		}
-		upd += ",count=ais_state.count+1,"
+		// EXCLUDED.count is 1 per row; a bulk merge of several rows for one MMSI carries more
+		upd += ",count=ais_state.count+EXCLUDED.count,"
 			   "msg_types=EXCLUDED.msg_types|ais_state.msg_types,"
 			   "channels=EXCLUDED.channels|ais_state.channels";
 
@@ -155,6 +158,11 @@ namespace IO
 		return templates().cols[st];
 	}
 
+	const std::string &DatabaseOutput::stateParamColumns()
+	{
+		return templates().state_params;
+	}
+
 	int DatabaseOutput::sqlParamCount(int st)
 	{
 		switch (st)
@@ -175,7 +183,72 @@ namespace IO
 	size_t DatabaseOutput::queueSize()
 	{
 		const std::lock_guard<std::mutex> lock(queue_mutex);
-		return message_queue.size();
+		return arena.size();
+	}
+
+	void DatabaseOutput::RowArena::dropOldest(size_t n)
+	{
+		if (n >= rows.size())
+		{
+			clear();
+			return;
+		}
+
+		const uint32_t cut_bytes = rows[n].bytes_begin;
+		const uint32_t cut_fields = rows[n].field_begin;
+
+		rows.erase(rows.begin(), rows.begin() + n);
+		fields.erase(fields.begin(), fields.begin() + cut_fields);
+		bytes.erase(0, cut_bytes);
+
+		for (auto &r : rows)
+		{
+			r.bytes_begin -= cut_bytes;
+			r.field_begin -= cut_fields;
+			r.field_end -= cut_fields;
+			if (r.nmea != NONE)
+				r.nmea -= cut_bytes;
+		}
+
+		for (auto &f : fields)
+			f.off -= cut_bytes;
+	}
+
+	// same text std::to_string produced when rows were queued as strings
+	void DatabaseOutput::QueuedEntry::render(const RowArena &a, size_t i)
+	{
+		const RowArena::Row &r = a.rows[i];
+
+		arena = &a;
+		row = &r;
+		field_begin = r.field_begin;
+		field_end = r.field_end;
+		mmsi_int = r.mmsi;
+		msg_type_int = r.msg_type;
+
+		std::snprintf(mmsi, sizeof(mmsi), "%u", r.mmsi);
+		std::snprintf(station_id, sizeof(station_id), "%d", r.station_id);
+		std::snprintf(msg_type, sizeof(msg_type), "%d", r.msg_type);
+		Util::Convert::toTimestampStr(r.rxtime, timestamp);
+		channel[0] = r.channel;
+		channel[1] = '\0';
+
+		// a tag without measurements is bound as NULL, so a non-SDR
+		// source cannot write the 1024 sentinel over real values
+		has_level = r.level != LEVEL_UNDEFINED;
+		has_ppm = r.ppm != PPM_UNDEFINED;
+		if (has_level)
+			std::snprintf(level, sizeof(level), "%f", r.level);
+		if (has_ppm)
+			std::snprintf(ppm, sizeof(ppm), "%f", r.ppm);
+
+		int ch = r.channel - 'A';
+		if (ch < 0 || ch > 4)
+			ch = 4;
+		std::snprintf(type_bit, sizeof(type_bit), "%d", 1 << r.msg_type);
+		std::snprintf(channel_bit, sizeof(channel_bit), "%d", 1 << ch);
+
+		nmea = r.nmea != RowArena::NONE ? a.str(r.nmea) : nullptr;
 	}
 
 	// AIS key -> column index within the position/static blocks, or -1
@@ -204,60 +277,104 @@ namespace IO
 		return m;
 	}
 
-	bool DatabaseOutput::writePosition(const QueuedEntry &entry, const char *msg_id)
+	void DatabaseOutput::messageParams(const QueuedEntry &entry, std::vector<const char *> &params) const
+	{
+		params.assign(sqlParamCount(ST_MESSAGE), nullptr);
+
+		params[0] = entry.mmsi;
+		params[1] = entry.timestamp;
+		params[2] = entry.station_id;
+		params[3] = entry.msg_type;
+		params[4] = entry.channel;
+		params[5] = entry.has_level ? entry.level : nullptr;
+		params[6] = entry.has_ppm ? entry.ppm : nullptr;
+		params[7] = NMEA && entry.nmea && *entry.nmea ? entry.nmea : nullptr;
+	}
+
+	void DatabaseOutput::positionParams(const QueuedEntry &entry, const char *msg_id, std::vector<const char *> &params) const
 	{
-		std::vector<const char *> params(sqlParamCount(ST_POSITION), nullptr);
+		params.assign(sqlParamCount(ST_POSITION), nullptr);
 		params[0] = msg_id;
 
-		for (const auto &kv : entry.kvs)
+		for (uint32_t i = entry.field_begin; i < entry.field_end; i++)
 		{
-			int col = columnMaps().position[kv.key];
+			const RowArena::Field &f = entry.arena->fields[i];
+			int col = columnMaps().position[f.key];
 			if (col >= 0)
-				params[1 + col] = kv.value.c_str();
+				params[1 + col] = entry.arena->str(f.off);
 		}
-
-		return exec(ST_POSITION, params);
 	}
 
-	bool DatabaseOutput::writeStatic(const QueuedEntry &entry, const char *msg_id)
+	void DatabaseOutput::staticParams(const QueuedEntry &entry, const char *msg_id, std::vector<const char *> &params) const
 	{
-		std::vector<const char *> params(sqlParamCount(ST_STATIC), nullptr);
+		params.assign(sqlParamCount(ST_STATIC), nullptr);
 		params[0] = msg_id;
 
-		for (const auto &kv : entry.kvs)
+		for (uint32_t i = entry.field_begin; i < entry.field_end; i++)
 		{
-			int col = columnMaps().stat[kv.key];
+			const RowArena::Field &f = entry.arena->fields[i];
+			int col = columnMaps().stat[f.key];
 			if (col >= 0)
-				params[1 + col] = kv.value.c_str();
+				params[1 + col] = entry.arena->str(f.off);
 		}
-
-		return exec(ST_STATIC, params);
 	}
 
-	bool DatabaseOutput::writeState(const QueuedEntry &entry)
+	void DatabaseOutput::stateParams(const QueuedEntry &entry, std::vector<const char *> &params) const
 	{
-		std::vector<const char *> params(sqlParamCount(ST_STATE), nullptr);
+		params.assign(sqlParamCount(ST_STATE), nullptr);
 
-		params[0] = entry.mmsi.c_str();
-		params[1] = entry.timestamp.c_str();
-		params[2] = entry.station_id.c_str();
-		params[3] = entry.level.empty() ? nullptr : entry.level.c_str();
-		params[4] = entry.ppm.empty() ? nullptr : entry.ppm.c_str();
+		params[0] = entry.mmsi;
+		params[1] = entry.timestamp;
+		params[2] = entry.station_id;
+		params[3] = entry.has_level ? entry.level : nullptr;
+		params[4] = entry.has_ppm ? entry.ppm : nullptr;
 
-		for (const auto &kv : entry.kvs)
+		for (uint32_t i = entry.field_begin; i < entry.field_end; i++)
 		{
-			int col = columnMaps().position[kv.key];
+			const RowArena::Field &f = entry.arena->fields[i];
+			const char *value = entry.arena->str(f.off);
+
+			int col = columnMaps().position[f.key];
 			if (col >= 0)
-				params[ST_STATE_FIXED + col] = kv.value.c_str();
+				params[ST_STATE_FIXED + col] = value;
 
-			col = columnMaps().stat[kv.key];
+			col = columnMaps().stat[f.key];
 			if (col >= 0)
-				params[ST_STATE_FIXED + N_POSITION + col] = kv.value.c_str();
+				params[ST_STATE_FIXED + N_POSITION + col] = value;
 		}
 
-		params[ST_STATE_FIXED + N_POSITION + N_STATIC] = entry.type_bit.c_str();
-		params[ST_STATE_FIXED + N_POSITION + N_STATIC + 1] = entry.channel_bit.c_str();
+		params[ST_STATE_FIXED + N_POSITION + N_STATIC] = entry.type_bit;
+		params[ST_STATE_FIXED + N_POSITION + N_STATIC + 1] = entry.channel_bit;
+	}
 
+	bool DatabaseOutput::logsPosition(const QueuedEntry &entry) const
+	{
+		return POSITION && carriesPosition(entry.msg_type_int);
+	}
+
+	bool DatabaseOutput::logsStatic(const QueuedEntry &entry) const
+	{
+		return STATIC && carriesStatic(entry.msg_type_int);
+	}
+
+	bool DatabaseOutput::writePosition(const QueuedEntry &entry, const char *msg_id)
+	{
+		std::vector<const char *> params;
+		positionParams(entry, msg_id, params);
+		return exec(ST_POSITION, params);
+	}
+
+	bool DatabaseOutput::writeStatic(const QueuedEntry &entry, const char *msg_id)
+	{
+		std::vector<const char *> params;
+		staticParams(entry, msg_id, params);
+		return exec(ST_STATIC, params);
+	}
+
+	bool DatabaseOutput::writeState(const QueuedEntry &entry)
+	{
+		std::vector<const char *> params;
+		stateParams(entry, params);
 		return exec(ST_STATE, params);
 	}
 
@@ -286,45 +403,68 @@ namespace IO
 							   ppm.empty() ? nullptr : ppm.c_str()});
 	}
 
-	bool DatabaseOutput::writeEntry(const QueuedEntry &entry)
+	void DatabaseOutput::countBytes(const QueuedEntry &entry)
 	{
-		const bool pos = POSITION && carriesPosition(entry.msg_type_int);
-		const bool sta = STATIC && carriesStatic(entry.msg_type_int);
+		stats.bytes_out += std::strlen(entry.mmsi) + std::strlen(entry.station_id) + std::strlen(entry.msg_type) +
+						   std::strlen(entry.timestamp) + 1;
+
+		if (entry.has_level)
+			stats.bytes_out += std::strlen(entry.level);
+		if (entry.has_ppm)
+			stats.bytes_out += std::strlen(entry.ppm);
+		if (entry.nmea)
+			stats.bytes_out += std::strlen(entry.nmea);
 
+		for (uint32_t i = entry.field_begin; i < entry.field_end; i++)
+			stats.bytes_out += std::strlen(entry.arena->str(entry.arena->fields[i].off));
+	}
+
+	bool DatabaseOutput::writeEntry(const QueuedEntry &entry)
+	{
 		std::string msg_id;
 
 		if (needMessageTable())
 		{
-			if (!execReturningId(ST_MESSAGE,
-								 {entry.mmsi.c_str(), entry.timestamp.c_str(), entry.station_id.c_str(),
-								  entry.msg_type.c_str(), entry.channel.c_str(),
-								  entry.level.empty() ? nullptr : entry.level.c_str(),
-								  entry.ppm.empty() ? nullptr : entry.ppm.c_str(),
-								  NMEA && !entry.nmea.empty() ? entry.nmea.c_str() : nullptr},
-								 msg_id))
+			std::vector<const char *> params;
+			messageParams(entry, params);
+
+			if (!execReturningId(ST_MESSAGE, params, msg_id))
 				return false;
 		}
 
 		const char *msg_id_ptr = msg_id.empty() ? nullptr : msg_id.c_str();
 
-		if (pos && !writePosition(entry, msg_id_ptr))
+		if (logsPosition(entry) && !writePosition(entry, msg_id_ptr))
 			return false;
 
-		if (sta && !writeStatic(entry, msg_id_ptr))
+		if (logsStatic(entry) && !writeStatic(entry, msg_id_ptr))
 			return false;
 
-		if (STATE && entry.mmsi != "0" && !writeState(entry))
+		if (logsState(entry) && !writeState(entry))
 			return false;
 
-		stats.bytes_out += entry.mmsi.size() + entry.station_id.size() + entry.msg_type.size() +
-						   entry.timestamp.size() + entry.channel.size() + entry.level.size() +
-						   entry.ppm.size() + entry.nmea.size();
-		for (const auto &kv : entry.kvs)
-			stats.bytes_out += kv.value.size();
+		countBytes(entry);
+		return true;
+	}
+
+	bool DatabaseOutput::writeBatch(const std::vector<QueuedEntry> &batch)
+	{
+		for (const auto &entry : batch)
+			if (!writeEntry(entry))
+				return false;
 
 		return true;
 	}
 
+	void DatabaseOutput::recordFlush(size_t rows, const std::chrono::steady_clock::time_point &t0)
+	{
+		const long ms = Util::Helper::msSince(t0);
+
+		stats.rows_out += rows;
+		stats.flush_ms = (uint32_t)ms;
+		stats.rows_per_sec = (uint32_t)(rows * 1000 / (ms > 0 ? ms : 1));
+	}
+
 	// caller holds queue_mutex
 	void DatabaseOutput::accumulateStats(const AIS::Message &msg, const TAG &tag)
 	{
@@ -414,26 +554,34 @@ namespace IO
 		if (STATS)
 			postStats();
 
-		std::vector<QueuedEntry> batch;
+		batch.clear();
 		{
 			const std::lock_guard<std::mutex> lock(queue_mutex);
-			batch.swap(message_queue);
+			batch.swap(arena);
 		}
 
-		if (batch.empty())
+		if (batch.size() == 0)
 		{
 			conn_fails = 0;
 			return;
 		}
 
+		entries.resize(batch.size());
+		for (size_t i = 0; i < batch.size(); i++)
+			entries[i].render(batch, i);
+
+		const auto t0 = std::chrono::steady_clock::now();
+
 		// no rollback exists: skip failed entries in place, a replay would double-write
 		if (!transactional())
 		{
 			int failed = 0;
-			for (const auto &entry : batch)
+			for (const auto &entry : entries)
 				if (!writeEntry(entry))
 					failed++;
 
+			recordFlush(batch.size() - failed, t0);
+
 			if (failed)
 				Warning() << "DBMS: dropped " << failed << " of " << batch.size() << " messages the backend rejected";
 
@@ -447,20 +595,13 @@ namespace IO
 			return;
 		}
 
-		bool ok = true;
-		for (const auto &entry : batch)
-			if (!writeEntry(entry))
-			{
-				ok = false;
-				break;
-			}
-
-		if (ok)
+		if (writeBatch(entries))
 		{
 			// a failed commit means nothing landed; count the cycle so the
 			// watchdog fires on a persistently failing backend
 			if (commit())
 			{
+				recordFlush(batch.size(), t0);
 				conn_fails = 0;
 				return;
 			}
@@ -475,7 +616,7 @@ namespace IO
 
 		// nothing landed: replay row by row so one refused message cannot block the rest
 		int failed = 0;
-		for (const auto &entry : batch)
+		for (const auto &entry : entries)
 		{
 			if (!begin())
 			{
@@ -490,6 +631,8 @@ namespace IO
 			failed++;
 		}
 
+		recordFlush(batch.size() - failed, t0);
+
 		if (failed)
 			Warning() << "DBMS: dropped " << failed << " of " << batch.size() << " messages the database rejected";
 
@@ -571,7 +714,8 @@ namespace IO
 			<< ", position " << Util::Convert::toString(POSITION)
 			<< ", static " << Util::Convert::toString(STATIC)
 			<< ", nmea " << Util::Convert::toString(NMEA)
-			<< ", stats " << Util::Convert::toString(STATS);
+			<< ", stats " << Util::Convert::toString(STATS)
+			<< ", bulk " << Util::Convert::toString(BULK);
 	}
 
 	void DatabaseOutput::stopWorker()
@@ -634,17 +778,37 @@ namespace IO
 		startWorker();
 	}
 
-	static std::string valueToParam(const JSON::Value &v)
+	// same text std::to_string gives; false for values that are not logged
+	bool DatabaseOutput::RowArena::appendValue(const JSON::Value &v)
 	{
+		char tmp[64];
+		int n;
+
 		if (v.isString())
-			return v.getString();
+		{
+			const std::string &str = v.getString();
+			append(str.data(), str.size());
+			return true;
+		}
 		if (v.isInt())
-			return std::to_string(v.getInt());
-		if (v.isFloat())
-			return std::to_string(v.getFloat());
-		if (v.isBool())
-			return v.getBool() ? "true" : "false";
-		return "";
+			n = std::snprintf(tmp, sizeof(tmp), "%ld", v.getInt());
+		else if (v.isFloat())
+			n = std::snprintf(tmp, sizeof(tmp), "%f", v.getFloat());
+		else if (v.isBool())
+			n = std::snprintf(tmp, sizeof(tmp), "%s", v.getBool() ? "true" : "false");
+		else
+			return false;
+
+		append(tmp, MIN(n, (int)sizeof(tmp) - 1));
+		return true;
+	}
+
+	// only the position and static columns are read from the JSON
+	AIS::KeySet DatabaseOutput::jsonKeys() const
+	{
+		AIS::KeySet keys;
+		keys.add(keys_position, N_POSITION).add(keys_static, N_STATIC).add(AIS::KEY_NAME);
+		return keys;
 	}
 
 	void DatabaseOutput::Receive(const JSON::JSON *data, int len, TAG &tag)
@@ -655,42 +819,45 @@ namespace IO
 		if (!filter.include(msg))
 			return;
 
-		// nothing below the statistics is enabled: no entry to build or queue
+		const std::lock_guard<std::mutex> lock(queue_mutex);
+
+		if (STATS)
+			accumulateStats(msg, tag);
+
+		// nothing below the statistics is enabled: no row to queue
 		if (!needMessageTable() && !STATE)
-		{
-			if (STATS)
-			{
-				const std::lock_guard<std::mutex> lock(queue_mutex);
-				accumulateStats(msg, tag);
-			}
 			return;
-		}
 
-		// build outside the lock: the flush thread must not wait on the string
-		// work below, nor the decoder on a flush in progress
-		QueuedEntry entry;
-		entry.mmsi = std::to_string(msg.mmsi());
-		entry.station_id = std::to_string(station_id ? station_id : msg.getStation());
-		entry.msg_type = std::to_string(msg.type());
-		entry.msg_type_int = msg.type();
-		entry.timestamp = Util::Convert::toTimestampStr(msg.getRxTimeUnix());
-		entry.channel = std::string(1, (char)msg.getChannel());
+		if (arena.size() >= MAX_QUEUE_SIZE)
+		{
+			// drop the oldest quarter rather than the whole buffer: a slow database
+			// should cost the least recent history, not everything still queued
+			const size_t drop = MAX_QUEUE_SIZE / 4;
+			Warning() << "DBMS: writing to database slow or failed, dropped " << drop << " oldest messages.";
+			arena.dropOldest(drop);
+		}
 
-		// a tag without measurements stays empty and is bound as NULL, so a
-		// non-SDR source cannot write the 1024 sentinel over real values
-		if (tag.level != LEVEL_UNDEFINED)
-			entry.level = std::to_string(tag.level);
-		if (tag.ppm != PPM_UNDEFINED)
-			entry.ppm = std::to_string(tag.ppm);
+		// plain copies into reused buffers: the worker only holds the lock for
+		// a swap, so neither side waits on the other's string work
+		RowArena::Row &row = arena.addRow();
+		row.rxtime = msg.getRxTimeUnix();
+		row.mmsi = msg.mmsi();
+		row.station_id = station_id ? station_id : msg.getStation();
+		row.msg_type = msg.type();
+		row.channel = (char)msg.getChannel();
+		row.level = tag.level;
+		row.ppm = tag.ppm;
 
-		if (NMEA)
+		if (NMEA && !msg.sentences().empty())
 		{
+			row.nmea = arena.begin();
 			for (const auto &s : msg.sentences())
 			{
-				if (!entry.nmea.empty())
-					entry.nmea += '\n';
-				entry.nmea += s;
+				if (arena.begin() != row.nmea)
+					arena.append("\n", 1);
+				arena.append(s.data(), s.size());
 			}
+			arena.end();
 		}
 
 		for (const auto &p : json.getMembers())
@@ -699,37 +866,13 @@ namespace IO
 			if (k < 0 || k >= AIS::KEY_COUNT)
 				continue;
 
-			std::string val = valueToParam(p.Get());
-			if (val.empty() && !p.Get().isString())
+			const uint32_t off = arena.begin();
+			if (!arena.appendValue(p.Get()))
 				continue;
 
-			entry.kvs.push_back({k, std::move(val)});
-		}
-
-		if (STATE)
-		{
-			int ch = msg.getChannel() - 'A';
-			if (ch < 0 || ch > 4)
-				ch = 4;
-			entry.type_bit = std::to_string(1 << msg.type());
-			entry.channel_bit = std::to_string(1 << ch);
-		}
-
-		const std::lock_guard<std::mutex> lock(queue_mutex);
-
-		if (STATS)
-			accumulateStats(msg, tag);
-
-		if (message_queue.size() >= MAX_QUEUE_SIZE)
-		{
-			// drop the oldest quarter rather than the whole buffer: a slow database
-			// should cost the least recent history, not everything still queued
-			const size_t drop = MAX_QUEUE_SIZE / 4;
-			Warning() << "DBMS: writing to database slow or failed, dropped " << drop << " oldest messages.";
-			message_queue.erase(message_queue.begin(), message_queue.begin() + drop);
+			arena.end();
+			arena.addField(k, off);
 		}
-
-		message_queue.push_back(std::move(entry));
 	}
 
 	// removed table settings get an error naming their replacement
@@ -770,6 +913,12 @@ namespace IO
 		case AIS::KEY_SETTING_RETENTION:
 			retention_days = Util::Parse::Integer(arg, 0, 36500);
 			break;
+		case AIS::KEY_SETTING_BULK:
+			BULK = Util::Parse::Switch(arg);
+			break;
+		case AIS::KEY_SETTING_READERS:
+			readers = Util::Parse::Integer(arg, 0, 16);
+			break;
 		case AIS::KEY_SETTING_GROUPS_IN:
 			StreamIn<JSON::JSON>::setGroupsIn(Util::Parse::Integer(arg));
 			break;
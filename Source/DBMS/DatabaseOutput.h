@@ -18,6 +18,8 @@
 #pragma once
 
 #include <atomic>
+#include <chrono>
+#include <ctime>
 #include <mutex>
 #include <set>
 #include <string>
@@ -100,21 +102,116 @@ namespace IO
 		// derived destructors must call this first: the worker calls their virtuals
 		void stopWorker();
 
-		struct QueuedEntry
+		// One flush cycle of queued rows: fixed-width fields per row, text values
+		// NUL-terminated in one byte buffer. Producer and worker swap whole
+		// arenas and clear() keeps capacity, so queueing costs no allocation.
+		struct RowArena
 		{
-			struct KV
+			static const uint32_t NONE = 0xFFFFFFFF;
+
+			struct Row
+			{
+				std::time_t rxtime;
+				uint32_t mmsi;
+				int station_id, msg_type;
+				float level, ppm; // LEVEL_UNDEFINED / PPM_UNDEFINED when not measured
+				char channel;
+				uint32_t nmea;	  // byte offset, NONE when not logged
+				uint32_t bytes_begin, field_begin, field_end;
+			};
+
+			struct Field
 			{
 				int key;
-				std::string value;
+				uint32_t off;
 			};
 
-			std::string mmsi, station_id, msg_type, timestamp, channel, level, ppm;
-			std::string type_bit, channel_bit;
-			std::string nmea;
+			std::vector<Row> rows;
+			std::vector<Field> fields;
+			std::string bytes;
+
+			size_t size() const { return rows.size(); }
+			const char *str(uint32_t off) const { return bytes.data() + off; }
+
+			void clear()
+			{
+				rows.clear();
+				fields.clear();
+				bytes.clear();
+			}
+
+			void swap(RowArena &other)
+			{
+				rows.swap(other.rows);
+				fields.swap(other.fields);
+				bytes.swap(other.bytes);
+			}
+
+			Row &addRow()
+			{
+				rows.push_back(Row());
+				Row &r = rows.back();
+				r.nmea = NONE;
+				r.bytes_begin = (uint32_t)bytes.size();
+				r.field_begin = r.field_end = (uint32_t)fields.size();
+				return r;
+			}
+
+			// opens a value in the byte buffer; append() extends it, end() terminates it
+			uint32_t begin() const { return (uint32_t)bytes.size(); }
+			void append(const char *p, size_t n) { bytes.append(p, n); }
+			void end() { bytes.push_back('\0'); }
+
+			// false for value types that are not logged; nothing is appended then
+			bool appendValue(const JSON::Value &v);
+
+			void addField(int key, uint32_t off)
+			{
+				fields.push_back({key, off});
+				rows.back().field_end = (uint32_t)fields.size();
+			}
+
+			void dropOldest(size_t n);
+		};
+
+		// One arena row with its fixed-width fields rendered on the worker;
+		// the text values stay in the arena and are bound in place.
+		struct QueuedEntry
+		{
+			const RowArena *arena = nullptr;
+			const RowArena::Row *row = nullptr; // the unrendered values
+			uint32_t field_begin = 0, field_end = 0;
+
+			uint32_t mmsi_int = 0;
 			int msg_type_int = 0;
-			std::vector<KV> kvs;
+
+			char mmsi[12], station_id[12], msg_type[12], timestamp[20], channel[2];
+			char level[32], ppm[32], type_bit[16], channel_bit[8];
+			const char *nmea = nullptr;
+
+			bool has_level = false, has_ppm = false;
+
+			void render(const RowArena &a, size_t i);
 		};
 
+		// parameters exactly as the per-row statements bind them; a bulk
+		// backend streams the same values, so both paths write identical rows
+		void messageParams(const QueuedEntry &entry, std::vector<const char *> &params) const;
+		void positionParams(const QueuedEntry &entry, const char *msg_id, std::vector<const char *> &params) const;
+		void staticParams(const QueuedEntry &entry, const char *msg_id, std::vector<const char *> &params) const;
+		void stateParams(const QueuedEntry &entry, std::vector<const char *> &params) const;
+
+		bool logsPosition(const QueuedEntry &entry) const;
+		bool logsStatic(const QueuedEntry &entry) const;
+		bool logsState(const QueuedEntry &entry) const { return STATE && entry.mmsi_int != 0; }
+
+		// columns the ST_STATE parameters fill, in parameter order
+		static const std::string &stateParamColumns();
+
+		// one flush cycle inside begin()/commit(); the default writes row by row
+		virtual bool writeBatch(const std::vector<QueuedEntry> &batch);
+		void countBytes(const QueuedEntry &entry);
+
 		struct StatsBucket
 		{
 			std::time_t hour = 0;
@@ -160,6 +257,12 @@ namespace IO
 		// CSV-only, but every backend accepts it: the hub writes the whole object
 		int capacity = 8192;
 
+		// PostgreSQL-only in the same way: COPY-based flush instead of row-by-row inserts
+		bool BULK = false;
+
+		// SQLite-only in the same way: read-only connections opened beside the writer
+		int readers = 0;
+
 		// days of history maintain() keeps, 0 keeps everything
 		int retention_days = 0;
 
@@ -174,7 +277,10 @@ namespace IO
 
 		long maintain_day = 0;
 
-		std::vector<QueuedEntry> message_queue;
+		// the producer fills `arena` under queue_mutex; the worker swaps it with
+		// `batch` and renders `entries` from it, all reusing their capacity
+		RowArena arena, batch;
+		std::vector<QueuedEntry> entries;
 		static const size_t MAX_QUEUE_SIZE = 2048;
 		std::mutex queue_mutex;
 
@@ -191,6 +297,7 @@ namespace IO
 
 		void accumulateStats(const AIS::Message &msg, const TAG &tag);
 		void postStats();
+		void recordFlush(size_t rows, const std::chrono::steady_clock::time_point &t0);
 		void post();
 		void process();
 
@@ -205,6 +312,7 @@ namespace IO
 		using StreamIn<AIS::GPS>::Receive;
 		using StreamIn<JSON::JSON>::Receive;
 		void Receive(const JSON::JSON *data, int len, TAG &tag) override;
+		AIS::KeySet jsonKeys() const override;
 
 		void setup();
 		void Start() override { setup(); }
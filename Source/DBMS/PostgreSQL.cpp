@@ -25,6 +25,68 @@ namespace IO
 {
 	static const char *statement_name[DatabaseOutput::ST_COUNT] = {"ais_msg", "ais_pos", "ais_sta", "ais_state", "ais_stats"};
 
+	// one round trip hands out the ids a whole flush cycle needs
+	static const char *reserve_ids_sql = "SELECT nextval(pg_get_serial_sequence('ais_message','id')) FROM generate_series(1,$1::integer)";
+
+	// session-local; seq keeps arrival order so the merge can pick the latest value
+	static const char *stage_sql = "CREATE TEMP TABLE IF NOT EXISTS ais_state_stage "
+								   "(seq bigserial, LIKE ais_state) ON COMMIT DELETE ROWS";
+
+	static void splitColumns(const std::string &list, std::vector<std::string> &out)
+	{
+		size_t start = 0;
+		while (start <= list.size())
+		{
+			size_t end = list.find(',', start);
+			if (end == std::string::npos)
+				end = list.size();
+			out.push_back(list.substr(start, end - start));
+			start = end + 1;
+		}
+	}
+
+	// Collapses the staged rows to one per MMSI before the upsert, which may
+	// not touch a row twice: latest non-null value per column wins, exactly
+	// what the per-row COALESCE sequence would have left behind.
+	std::string PostgreSQL::buildMergeSQL()
+	{
+		std::vector<std::string> cols;
+		splitColumns(columnList(ST_STATE), cols);
+
+		// one select term per ais_state column, in the order of the insert list
+		std::string sel;
+		for (const auto &c : cols)
+		{
+			if (!sel.empty())
+				sel += ',';
+
+			if (c == "mmsi")
+				sel += c;
+			else if (c == "first_seen")
+				sel += "(array_agg(received_at ORDER BY seq))[1]";
+			else if (c == "count")
+				sel += "count(*)";
+			else if (c == "msg_types" || c == "channels")
+				sel += "bit_or(" + c + ")";
+			else if (c == "received_at" || c == "station_id")
+				sel += "(array_agg(" + c + " ORDER BY seq DESC))[1]";
+			else
+				sel += "(array_agg(" + c + " ORDER BY seq DESC) FILTER (WHERE " + c + " IS NOT NULL))[1]";
+		}
+
+		const std::string &upsert = sqlTemplate(ST_STATE);
+		const std::string conflict = upsert.substr(upsert.find(" ON CONFLICT"));
+
+		return "INSERT INTO ais_state (" + columnList(ST_STATE) + ") SELECT " + sel +
+			   " FROM ais_state_stage GROUP BY mmsi" + conflict;
+	}
+
+	const std::string &PostgreSQL::mergeSQL()
+	{
+		static const std::string sql = buildMergeSQL();
+		return sql;
+	}
+
 	PostgreSQL::~PostgreSQL()
 	{
 		// before PQfinish: the worker calls back into this object
@@ -113,10 +175,32 @@ namespace IO
 				return false;
 		}
 
+		if (BULK && !prepareBulk())
+			return false;
+
 		prepared = true;
 		return true;
 	}
 
+	bool PostgreSQL::prepareBulk()
+	{
+		if (!run(stage_sql))
+			return false;
+
+		PGresult *res = PQprepare(con, "ais_ids", reserve_ids_sql, 0, nullptr);
+		bool ok = PQresultStatus(res) == PGRES_COMMAND_OK;
+		PQclear(res);
+
+		res = ok ? PQprepare(con, "ais_state_merge", mergeSQL().c_str(), 0, nullptr) : nullptr;
+		ok = ok && PQresultStatus(res) == PGRES_COMMAND_OK;
+		PQclear(res);
+
+		if (!ok)
+			Error() << "DBMS: cannot prepare bulk statements: " << PQerrorMessage(con);
+
+		return ok;
+	}
+
 	void PostgreSQL::collectVesselsSince(const std::string &since, std::set<uint32_t> &out)
 	{
 		const char *params[] = {since.c_str()};
@@ -169,6 +253,171 @@ namespace IO
 		return ok;
 	}
 
+	// COPY text format: tab-separated, \N for NULL, backslash escapes for the separators
+	void PostgreSQL::appendCopyRow(std::string &out, const std::vector<const char *> &params)
+	{
+		for (size_t i = 0; i < params.size(); i++)
+		{
+			if (i)
+				out += '\t';
+
+			if (!params[i])
+			{
+				out += "\\N";
+				continue;
+			}
+
+			for (const char *p = params[i]; *p; p++)
+			{
+				switch (*p)
+				{
+				case '\\':
+					out += "\\\\";
+					break;
+				case '\n':
+					out += "\\n";
+					break;
+				case '\r':
+					out += "\\r";
+					break;
+				case '\t':
+					out += "\\t";
+					break;
+				default:
+					out += *p;
+				}
+			}
+		}
+		out += '\n';
+	}
+
+	bool PostgreSQL::reserveIds(size_t n)
+	{
+		const std::string count = std::to_string(n);
+		const char *params[] = {count.c_str()};
+
+		PGresult *res = PQexecPrepared(con, "ais_ids", 1, params, nullptr, nullptr, 0);
+		const bool ok = PQresultStatus(res) == PGRES_TUPLES_OK && PQntuples(res) == (int)n;
+
+		if (ok)
+		{
+			ids.resize(n);
+			for (size_t i = 0; i < n; i++)
+				ids[i] = PQgetvalue(res, (int)i, 0);
+		}
+		else
+			Error() << "DBMS: cannot reserve message ids: " << PQerrorMessage(con);
+
+		PQclear(res);
+		return ok;
+	}
+
+	bool PostgreSQL::copyIn(const std::string &sql, const std::string &data)
+	{
+		PGresult *res = PQexec(con, sql.c_str());
+		bool ok = PQresultStatus(res) == PGRES_COPY_IN;
+		PQclear(res);
+
+		if (!ok)
+		{
+			Error() << "DBMS: " << sql << " failed: " << PQerrorMessage(con);
+			return false;
+		}
+
+		ok = PQputCopyData(con, data.data(), (int)data.size()) == 1;
+		ok = PQputCopyEnd(con, ok ? nullptr : "client send failed") == 1 && ok;
+
+		// the COPY result, then a terminating null
+		while ((res = PQgetResult(con)) != nullptr)
+		{
+			if (PQresultStatus(res) != PGRES_COMMAND_OK)
+				ok = false;
+			PQclear(res);
+		}
+
+		if (!ok)
+			Error() << "DBMS: " << sql << " failed: " << PQerrorMessage(con);
+		else
+			stats.bytes_out += data.size();
+
+		return ok;
+	}
+
+	// a handful of round trips per cycle however many rows it carries; any
+	// failure rolls back and the base replays the cycle row by row
+	bool PostgreSQL::writeBatch(const std::vector<QueuedEntry> &batch)
+	{
+		if (!BULK)
+			return DatabaseOutput::writeBatch(batch);
+
+		std::vector<const char *> params;
+
+		if (needMessageTable())
+		{
+			if (!reserveIds(batch.size()))
+				return false;
+
+			copy_buffer.clear();
+			for (size_t i = 0; i < batch.size(); i++)
+			{
+				messageParams(batch[i], params);
+				params.insert(params.begin(), ids[i].c_str());
+				appendCopyRow(copy_buffer, params);
+			}
+
+			if (!copyIn("COPY ais_message (id," + columnList(ST_MESSAGE) + ") FROM STDIN", copy_buffer))
+				return false;
+
+			copy_buffer.clear();
+			for (size_t i = 0; i < batch.size(); i++)
+				if (logsPosition(batch[i]))
+				{
+					positionParams(batch[i], ids[i].c_str(), params);
+					appendCopyRow(copy_buffer, params);
+				}
+
+			if (!copy_buffer.empty() && !copyIn("COPY ais_position (" + columnList(ST_POSITION) + ") FROM STDIN", copy_buffer))
+				return false;
+
+			copy_buffer.clear();
+			for (size_t i = 0; i < batch.size(); i++)
+				if (logsStatic(batch[i]))
+				{
+					staticParams(batch[i], ids[i].c_str(), params);
+					appendCopyRow(copy_buffer, params);
+				}
+
+			if (!copy_buffer.empty() && !copyIn("COPY ais_static (" + columnList(ST_STATIC) + ") FROM STDIN", copy_buffer))
+				return false;
+		}
+
+		copy_buffer.clear();
+		for (const auto &entry : batch)
+			if (logsState(entry))
+			{
+				stateParams(entry, params);
+				appendCopyRow(copy_buffer, params);
+			}
+
+		if (!copy_buffer.empty())
+		{
+			if (!copyIn("COPY ais_state_stage (" + stateParamColumns() + ") FROM STDIN", copy_buffer))
+				return false;
+
+			PGresult *res = PQexecPrepared(con, "ais_state_merge", 0, nullptr, nullptr, nullptr, 0);
+			const bool ok = PQresultStatus(res) == PGRES_COMMAND_OK;
+
+			if (!ok)
+				Error() << "DBMS: ais_state_merge failed: " << PQerrorMessage(con);
+
+			PQclear(res);
+			if (!ok)
+				return false;
+		}
+
+		return true;
+	}
+
 	bool PostgreSQL::exec(int st, const std::vector<const char *> &params)
 	{
 		return execPrepared(st, params, nullptr);
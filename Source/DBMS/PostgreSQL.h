@@ -38,12 +38,25 @@ namespace IO
 		void initSession();
 		void closeDB();
 
+		// bulk mode: ids reserved from the sequence, rows streamed with COPY
+		std::string copy_buffer;
+		std::vector<std::string> ids;
+
+		static void appendCopyRow(std::string &out, const std::vector<const char *> &params);
+		bool reserveIds(size_t n);
+		bool copyIn(const std::string &sql, const std::string &data);
+		bool prepareBulk();
+
+		static std::string buildMergeSQL();
+		static const std::string &mergeSQL();
+
 	protected:
 		void connectDB() override;
 		bool ensureConnection() override;
 		bool prepareAll() override;
 
 		bool exec(int st, const std::vector<const char *> &params) override;
+		bool writeBatch(const std::vector<QueuedEntry> &batch) override;
 		bool execReturningId(int st, const std::vector<const char *> &params, std::string &id) override;
 
 		void collectVesselsSince(const std::string &since, std::set<uint32_t> &out) override;
@@ -17,6 +17,7 @@
 
 #include "SQLite.h"
 #include "Logger.h"
+#include "Helper.h"
 
 #ifdef HASSQLITE
 
@@ -31,6 +32,38 @@ namespace IO
 		return sql;
 	}
 
+	// "... VALUES (<tuple>) <tail>" with the tuple repeated `rows` times and
+	// $k renumbered to ?k of its row, so one statement binds rows*n parameters
+	static std::string multiRowSQL(const std::string &sql, int n, int rows)
+	{
+		const size_t open = sql.find(" VALUES (") + 8;
+		const size_t close = sql.find(')', open);
+		const std::string tuple = sql.substr(open, close - open + 1);
+
+		std::string out = sql.substr(0, open);
+		for (int r = 0; r < rows; r++)
+		{
+			if (r)
+				out += ',';
+
+			for (size_t i = 0; i < tuple.size(); i++)
+			{
+				if (tuple[i] != '$')
+				{
+					out += tuple[i];
+					continue;
+				}
+
+				int k = 0;
+				while (i + 1 < tuple.size() && tuple[i + 1] >= '0' && tuple[i + 1] <= '9')
+					k = k * 10 + (tuple[++i] - '0');
+
+				out += '?' + std::to_string(k + r * n);
+			}
+		}
+		return out + sql.substr(close + 1);
+	}
+
 	SQLite::~SQLite()
 	{
 		// before finalizing anything: the worker calls back into this object
@@ -59,10 +92,98 @@ namespace IO
 		run("PRAGMA journal_mode = WAL");
 		run("PRAGMA synchronous = NORMAL");
 		run("PRAGMA busy_timeout = 5000");
+
+		openReaders();
+	}
+
+	void SQLite::openReaders()
+	{
+		for (int i = 0; i < readers; i++)
+		{
+			sqlite3 *r = nullptr;
+			if (sqlite3_open_v2(conn_string.c_str(), &r, SQLITE_OPEN_READONLY, nullptr) != SQLITE_OK)
+			{
+				Warning() << "DBMS: cannot open read-only connection: " << (r ? sqlite3_errmsg(r) : "out of memory");
+				sqlite3_close(r);
+				break;
+			}
+
+			sqlite3_busy_timeout(r, 5000);
+
+			const std::lock_guard<std::mutex> lock(reader_mutex);
+			reader_pool.push_back(r);
+			reader_idle.push_back(r);
+		}
+
+		if (!reader_pool.empty())
+			Debug() << "DBMS: opened " << reader_pool.size() << " read-only SQLite connections";
+	}
+
+	// waits for readers out on loan: a query must never see its connection closed
+	void SQLite::closeReaders()
+	{
+		std::unique_lock<std::mutex> lock(reader_mutex);
+		reader_cv.wait(lock, [this] { return reader_idle.size() == reader_pool.size(); });
+
+		for (sqlite3 *r : reader_pool)
+			sqlite3_close(r);
+
+		reader_pool.clear();
+		reader_idle.clear();
+		lock.unlock();
+
+		// queries waiting for a reader give up
+		reader_cv.notify_all();
+	}
+
+	bool SQLite::query(const std::string &sql, const std::vector<std::string> &params,
+					   const std::function<void(sqlite3_stmt *)> &row)
+	{
+		sqlite3 *r;
+		{
+			std::unique_lock<std::mutex> lock(reader_mutex);
+			if (reader_pool.empty())
+				return false;
+
+			reader_cv.wait(lock, [this] { return !reader_idle.empty() || reader_pool.empty(); });
+			if (reader_pool.empty())
+			{
+				Error() << "DBMS: read query failed: database closed";
+				return false;
+			}
+
+			r = reader_idle.back();
+			reader_idle.pop_back();
+		}
+
+		sqlite3_stmt *s = nullptr;
+		bool ok = sqlite3_prepare_v2(r, sql.c_str(), -1, &s, nullptr) == SQLITE_OK;
+
+		for (size_t i = 0; ok && i < params.size(); i++)
+			ok = sqlite3_bind_text(s, (int)i + 1, params[i].c_str(), -1, SQLITE_STATIC) == SQLITE_OK;
+
+		int rc = SQLITE_DONE;
+		while (ok && (rc = sqlite3_step(s)) == SQLITE_ROW)
+			row(s);
+
+		ok = ok && rc == SQLITE_DONE;
+		if (!ok)
+			Error() << "DBMS: read query failed: " << sqlite3_errmsg(r);
+
+		sqlite3_finalize(s);
+
+		{
+			const std::lock_guard<std::mutex> lock(reader_mutex);
+			reader_idle.push_back(r);
+		}
+		reader_cv.notify_all();
+		return ok;
 	}
 
 	void SQLite::closeDB()
 	{
+		closeReaders();
+
 		for (int i = 0; i < ST_COUNT; i++)
 		{
 			if (stmt[i])
@@ -70,8 +191,24 @@ namespace IO
 				sqlite3_finalize(stmt[i]);
 				stmt[i] = nullptr;
 			}
+
+			if (multi[i])
+			{
+				sqlite3_finalize(multi[i]);
+				multi[i] = nullptr;
+			}
+
+			if (single[i])
+			{
+				sqlite3_finalize(single[i]);
+				single[i] = nullptr;
+			}
 		}
 
+		sqlite3_finalize(next_id_stmt);
+		sqlite3_finalize(prune_stmt);
+		next_id_stmt = prune_stmt = nullptr;
+
 		if (db)
 		{
 			sqlite3_close(db);
@@ -128,17 +265,57 @@ namespace IO
 			}
 		}
 
-		return true;
+		return prepareMulti();
 	}
 
-	bool SQLite::bindAndStep(int st, const std::vector<const char *> &params)
+	bool SQLite::prepareMulti()
 	{
-		sqlite3_stmt *s = stmt[st];
+		// older builds cap a statement at 999 parameters
+		const int limit = sqlite3_limit(db, SQLITE_LIMIT_VARIABLE_NUMBER, -1);
 
+		const int tables[] = {ST_MESSAGE, ST_POSITION, ST_STATIC, ST_STATE};
+		for (int st : tables)
+		{
+			// message rows carry the id assigned up front as an extra first column
+			const int n = sqlParamCount(st) + (st == ST_MESSAGE ? 1 : 0);
+			multi_rows[st] = MIN(64, limit / n);
+
+			std::string sql = sqlTemplate(st);
+			if (st == ST_MESSAGE)
+			{
+				sql = "INSERT INTO ais_message (id," + columnList(st) + ") VALUES ($1";
+				for (int i = 2; i <= n; i++)
+					sql += ",$" + std::to_string(i);
+				sql += ")";
+			}
+
+			if (sqlite3_prepare_v2(db, multiRowSQL(sql, n, multi_rows[st]).c_str(), -1, &multi[st], nullptr) != SQLITE_OK ||
+				sqlite3_prepare_v2(db, multiRowSQL(sql, n, 1).c_str(), -1, &single[st], nullptr) != SQLITE_OK)
+			{
+				Error() << "DBMS: cannot prepare batched statement " << st << ": " << sqlite3_errmsg(db);
+				return false;
+			}
+		}
+
+		const char *next_id_sql = "SELECT COALESCE(MAX(id),0)+1 FROM ais_message";
+		const char *prune_sql = "DELETE FROM ais_message WHERE id >= ?1 AND id < ?2 AND received_at < ?3";
+
+		if (sqlite3_prepare_v2(db, next_id_sql, -1, &next_id_stmt, nullptr) != SQLITE_OK ||
+			sqlite3_prepare_v2(db, prune_sql, -1, &prune_stmt, nullptr) != SQLITE_OK)
+		{
+			Error() << "DBMS: cannot prepare statement: " << sqlite3_errmsg(db);
+			return false;
+		}
+
+		return true;
+	}
+
+	bool SQLite::bind(sqlite3_stmt *s, int st, const char *const *params, size_t n)
+	{
 		// no clear_bindings: every call rebinds all parameters, nulls included
 		sqlite3_reset(s);
 
-		for (size_t i = 0; i < params.size(); i++)
+		for (size_t i = 0; i < n; i++)
 		{
 			// text plus column affinity; the strings outlive the step, hence SQLITE_STATIC
 			int rc = params[i] ? sqlite3_bind_text(s, (int)i + 1, params[i], -1, SQLITE_STATIC)
@@ -151,6 +328,11 @@ namespace IO
 			}
 		}
 
+		return true;
+	}
+
+	bool SQLite::step(sqlite3_stmt *s, int st)
+	{
 		if (sqlite3_step(s) != SQLITE_DONE)
 		{
 			Error() << "DBMS: statement " << st << " failed: " << sqlite3_errmsg(db);
@@ -160,6 +342,172 @@ namespace IO
 		return true;
 	}
 
+	bool SQLite::bindAndStep(int st, const std::vector<const char *> &params)
+	{
+		return bind(stmt[st], st, params.data(), params.size()) && step(stmt[st], st);
+	}
+
+	bool SQLite::queueRow(int st, const std::vector<const char *> &params)
+	{
+		pending.insert(pending.end(), params.begin(), params.end());
+
+		if ((int)(pending.size() / params.size()) < multi_rows[st])
+			return true;
+
+		const bool ok = bind(multi[st], st, pending.data(), pending.size()) && step(multi[st], st);
+		pending.clear();
+		return ok;
+	}
+
+	// the remainder below a full multi-row statement goes through the single-row one
+	bool SQLite::flushRows(int st)
+	{
+		const size_t n = sqlParamCount(st) + (st == ST_MESSAGE ? 1 : 0);
+
+		for (size_t i = 0; i < pending.size(); i += n)
+			if (!bind(single[st], st, &pending[i], n) || !step(single[st], st))
+				return false;
+
+		pending.clear();
+		return true;
+	}
+
+	// same rows as the per-row path, up to multi_rows[st] per statement execution
+	bool SQLite::writeBatch(const std::vector<QueuedEntry> &batch)
+	{
+		pending.clear();
+
+		if (needMessageTable())
+		{
+			// ids assigned up front so children need no last_insert_rowid round trip;
+			// inside the batch transaction nothing else inserts on this connection
+			sqlite3_reset(next_id_stmt);
+			if (sqlite3_step(next_id_stmt) != SQLITE_ROW)
+			{
+				Error() << "DBMS: cannot read next message id: " << sqlite3_errmsg(db);
+				return false;
+			}
+
+			const long long next = sqlite3_column_int64(next_id_stmt, 0);
+			sqlite3_reset(next_id_stmt);
+
+			ids.resize(batch.size());
+			for (size_t i = 0; i < batch.size(); i++)
+			{
+				char tmp[24];
+				std::snprintf(tmp, sizeof(tmp), "%lld", next + (long long)i);
+				ids[i].assign(tmp);
+			}
+
+			for (size_t i = 0; i < batch.size(); i++)
+			{
+				messageParams(batch[i], row);
+				row.insert(row.begin(), ids[i].c_str());
+				if (!queueRow(ST_MESSAGE, row))
+					return false;
+			}
+
+			if (!flushRows(ST_MESSAGE))
+				return false;
+
+			for (size_t i = 0; i < batch.size(); i++)
+				if (logsPosition(batch[i]))
+				{
+					positionParams(batch[i], ids[i].c_str(), row);
+					if (!queueRow(ST_POSITION, row))
+						return false;
+				}
+
+			if (!flushRows(ST_POSITION))
+				return false;
+
+			for (size_t i = 0; i < batch.size(); i++)
+				if (logsStatic(batch[i]))
+				{
+					staticParams(batch[i], ids[i].c_str(), row);
+					if (!queueRow(ST_STATIC, row))
+						return false;
+				}
+
+			if (!flushRows(ST_STATIC))
+				return false;
+		}
+
+		// SQLite applies an upsert row by row, so one MMSI may recur within a statement
+		for (const auto &entry : batch)
+			if (logsState(entry))
+			{
+				stateParams(entry, row);
+				if (!queueRow(ST_STATE, row))
+					return false;
+			}
+
+		if (!flushRows(ST_STATE))
+			return false;
+
+		for (const auto &entry : batch)
+			countBytes(entry);
+
+		return true;
+	}
+
+	void SQLite::maintain()
+	{
+		if (retention_days <= 0)
+			return;
+
+		prune_cutoff = Util::Convert::toTimestampStr(retentionCutoff());
+
+		execDelete("DELETE FROM ais_stats_hourly WHERE bucket < $1", prune_cutoff.c_str());
+		execDelete("DELETE FROM ais_state WHERE received_at < $1", prune_cutoff.c_str());
+
+		// the time index bounds the id range once; the chunks then walk the rowid
+		sqlite3_stmt *s = nullptr;
+		if (sqlite3_prepare_v2(db, "SELECT MIN(id), MAX(id) FROM ais_message WHERE received_at < ?1", -1, &s, nullptr) != SQLITE_OK)
+			return;
+
+		sqlite3_bind_text(s, 1, prune_cutoff.c_str(), -1, SQLITE_STATIC);
+		if (sqlite3_step(s) == SQLITE_ROW && sqlite3_column_type(s, 0) != SQLITE_NULL)
+		{
+			prune_next = sqlite3_column_int64(s, 0);
+			prune_end = sqlite3_column_int64(s, 1);
+			prune_total = 0;
+		}
+		sqlite3_finalize(s);
+
+		prune();
+	}
+
+	// a bounded slice per flush cycle, each chunk its own short write transaction
+	void SQLite::prune()
+	{
+		if (!prune_stmt || prune_next > prune_end)
+			return;
+
+		const auto t0 = std::chrono::steady_clock::now();
+
+		while (prune_next <= prune_end && Util::Helper::msSince(t0) < PRUNE_BUDGET_MS)
+		{
+			sqlite3_reset(prune_stmt);
+			sqlite3_bind_int64(prune_stmt, 1, prune_next);
+			sqlite3_bind_int64(prune_stmt, 2, prune_next + PRUNE_CHUNK);
+			sqlite3_bind_text(prune_stmt, 3, prune_cutoff.c_str(), -1, SQLITE_STATIC);
+
+			// busy or failed: the same chunk is retried next cycle
+			if (sqlite3_step(prune_stmt) != SQLITE_DONE)
+			{
+				Warning() << "DBMS: retention chunk failed: " << sqlite3_errmsg(db);
+				break;
+			}
+
+			prune_total += sqlite3_changes(db);
+			prune_next += PRUNE_CHUNK;
+		}
+
+		if (prune_next > prune_end && prune_total)
+			Info() << "DBMS: retention removed " << prune_total << " messages older than " << prune_cutoff;
+	}
+
 	bool SQLite::exec(int st, const std::vector<const char *> &params)
 	{
 		return bindAndStep(st, params);
@@ -21,6 +21,8 @@
 
 #ifdef HASSQLITE
 
+#include <condition_variable>
+#include <functional>
 #include <sqlite3.h>
 
 #include "DatabaseOutput.h"
@@ -33,8 +35,39 @@ namespace IO
 		sqlite3 *db = nullptr;
 		sqlite3_stmt *stmt[ST_COUNT] = {nullptr};
 
+		// batch variants of stmt: `multi_rows` tuples per execution bound flat,
+		// and a one-tuple form in the same layout for the remainder
+		sqlite3_stmt *multi[ST_COUNT] = {nullptr};
+		sqlite3_stmt *single[ST_COUNT] = {nullptr};
+		int multi_rows[ST_COUNT] = {0};
+
+		// per-batch scratch, reused across cycles
+		std::vector<const char *> pending, row;
+		std::vector<std::string> ids;
+
+		// retention runs in rowid chunks between flush cycles instead of one long delete
+		static const int PRUNE_CHUNK = 2000;
+		static const int PRUNE_BUDGET_MS = 250;
+		sqlite3_stmt *prune_stmt = nullptr, *next_id_stmt = nullptr;
+		long long prune_next = 0, prune_end = -1;
+		long prune_total = 0;
+		std::string prune_cutoff;
+
+		// read-only connections for queries against the log; WAL lets them run beside the writer
+		std::vector<sqlite3 *> reader_pool, reader_idle;
+		std::mutex reader_mutex;
+		std::condition_variable reader_cv;
+
 		bool run(const char *cmd);
+		bool bind(sqlite3_stmt *s, int st, const char *const *params, size_t n);
+		bool step(sqlite3_stmt *s, int st);
 		bool bindAndStep(int st, const std::vector<const char *> &params);
+		bool queueRow(int st, const std::vector<const char *> &params);
+		bool flushRows(int st);
+		bool prepareMulti();
+		void prune();
+		void openReaders();
+		void closeReaders();
 		void closeDB();
 
 	protected:
@@ -46,6 +79,10 @@ namespace IO
 
 		bool exec(int st, const std::vector<const char *> &params) override;
 		bool execReturningId(int st, const std::vector<const char *> &params, std::string &id) override;
+		bool writeBatch(const std::vector<QueuedEntry> &batch) override;
+
+		void flushed() override { prune(); }
+		void maintain() override;
 
 		void collectVesselsSince(const std::string &since, std::set<uint32_t> &out) override;
 		long execDelete(const char *sql, const char *param) override;
@@ -57,6 +94,12 @@ namespace IO
 	public:
 		SQLite() : DatabaseOutput("SQLite") { conn_string = "ais.db"; }
 		~SQLite();
+
+		// Runs a read-only query on a pooled reader, never on the writer, and
+		// calls `row` per result row. False without readers, once they are
+		// closed or on error.
+		bool query(const std::string &sql, const std::vector<std::string> &params,
+				   const std::function<void(sqlite3_stmt *)> &row);
 	};
 }
 
@@ -27,19 +27,7 @@
 namespace DSP {
 	void SimplePLL::Receive(const FLOAT32* data, int len, TAG& tag) {
 		for (int i = 0; i < len; i++) {
-			BIT bit = (data[i] > 0);
-
-			if (bit != prev) {
-				PLL += (0.5f - PLL) * (FastPLL ? 0.6f : 0.05f);
-			}
-
-			PLL += 0.2f;
-
-			if (PLL >= 1.0f) {
-				Send(&data[i], 1, tag);
-				PLL -= (int)PLL;
-			}
-			prev = bit;
+			if (Run(data[i])) Send(&data[i], 1, tag);
 		}
 	}
 
@@ -315,6 +303,290 @@ namespace DSP {
 		rot /= std::abs(rot);
 	}
 
+	// Fused CU8 front-end
+	void FusedDownsampleCU8::CIC5::run(CFLOAT32* data, int len) {
+		CFLOAT32 z, r0, r1, r2, r3, r4;
+
+		for (int i = 0, j = 0; i < len; i += 2, j++) {
+			z = data[i];
+			MA1(0);
+			MA1(1);
+			MA1(2);
+			MA1(3);
+			MA1(4);
+			data[j] = z * (FLOAT32)0.03125f;
+			z = data[i + 1];
+			MA2(0);
+			MA2(1);
+			MA2(2);
+			MA2(3);
+			MA2(4);
+		}
+	}
+
+	FusedDownsampleCU8::FusedDownsampleCU8() {
+		for (int i = 0; i < 256; i++)
+			lut[i] = (i - 128) / 128.0f;
+		setup();
+	}
+
+	void FusedDownsampleCU8::setCIC(int stages, bool d, FLOAT32 a) {
+		cic.assign(stages, CIC5());
+		taps.clear();
+		K = 1;
+
+		droop = d;
+		alpha = a;
+		beta = 1 - 2 * a;
+
+		setup();
+	}
+
+	void FusedDownsampleCU8::setFIR(const std::vector<FLOAT32>& t, int k) {
+		cic.clear();
+		taps = t;
+		K = k;
+		droop = false;
+
+		setup();
+	}
+
+	void FusedDownsampleCU8::setup() {
+		history = taps.empty() ? 0 : (int)taps.size() - 1;
+		granule = (K << cic.size()) * 2;
+		pending = 0;
+		buffer.assign(history + TILE, 0.0f);
+	}
+
+	// len samples in the tile, a multiple of granule
+	void FusedDownsampleCU8::process(int len) {
+		CFLOAT32* x = buffer.data();
+		int n = len;
+
+		if (K > 1) {
+			// in place: output j reads from j * K on and only earlier outputs are overwritten
+			for (int i = 0, j = 0; i < len; i += K, j++)
+				x[j] = dot(&x[i]);
+			n = len / K;
+		}
+		else {
+			for (auto& c : cic) {
+				c.run(x, n);
+				n /= 2;
+			}
+		}
+
+		if (droop) {
+			for (int i = 0; i < n; i++) {
+				CFLOAT32 v = x[i];
+				x[i] = alpha * (d1 + v) + d2 * beta;
+				d1 = d2;
+				d2 = v;
+			}
+		}
+
+		if (output_up.size() < count + n) {
+			output_up.resize(count + n);
+			output_down.resize(count + n);
+		}
+
+		CFLOAT32* u = output_up.data() + count;
+		CFLOAT32* d = output_down.data() + count;
+
+		for (int i = 0; i < n; i++) {
+			FLOAT32 RR = x[i].real() * rot.real(), II = x[i].imag() * rot.imag();
+			FLOAT32 RI = x[i].real() * rot.imag(), IR = x[i].imag() * rot.real();
+
+			u[i].real(RR - II);
+			u[i].imag(IR + RI);
+			d[i].real(RR + II);
+			d[i].imag(IR - RI);
+
+			rot *= mult;
+		}
+		rot /= std::abs(rot);
+
+		cic_a.run(u, n);
+		cic_b.run(d, n);
+		count += n / 2;
+
+		// filter history for the next tile
+		for (int i = 0; i < history; i++)
+			x[i] = x[len + i];
+	}
+
+	void FusedDownsampleCU8::Receive(const CU8* data, int len, TAG& tag) {
+		const uint8_t* in = (const uint8_t*)data;
+		CFLOAT32* tile = buffer.data() + history;
+
+		count = 0;
+
+		for (int i = 0; i < len; i++) {
+			tile[pending].real(lut[in[2 * i]]);
+			tile[pending].imag(lut[in[2 * i + 1]]);
+
+			if (++pending == TILE || i == len - 1) {
+				int n = pending - pending % granule;
+				if (n == 0) continue;
+
+				process(n);
+
+				pending -= n;
+				for (int j = 0; j < pending; j++)
+					tile[j] = tile[n + j];
+			}
+		}
+
+		if (count) {
+			up.Send(output_up.data(), count, tag);
+			down.Send(output_down.data(), count, tag);
+		}
+	}
+
+	void Channelizer::setParams(int sample_rate, int output_rate) {
+		if (output_rate <= 0 || sample_rate % output_rate)
+			throw std::runtime_error("Channelizer: output rate must divide the sample rate.");
+
+		D = sample_rate / output_rate;
+		M = OVERSAMPLE * D;
+
+		if (M & (M - 1))
+			throw std::runtime_error("Channelizer: sample rate over output rate must be a power of 2.");
+
+		in_rate = sample_rate;
+		out_rate = output_rate;
+		logM = FFT::log2(M);
+
+		reversed.resize(M);
+		for (int m = 0; m < M; m++) reversed[m] = FFT::rev(m, logM);
+
+		design();
+
+		acc.assign(M, 0.0f);
+		fft_data.assign(M, 0.0f);
+		buffer.assign(taps.size() - 1, 0.0f);
+		idx_in = 0;
+
+		channels.clear();
+		out.clear();
+	}
+
+	// Blackman-Harris windowed sinc with its cutoff at half the output rate, so the
+	// band around the bin centre is free of aliases after decimation. It is shaped
+	// further by the CIC5 the cascade applies at twice the output rate, which the
+	// demodulators were tuned with.
+	void Channelizer::design() {
+		const int L = M * TAPS_PER_BRANCH;
+		const int S = D / 2; // input samples per sample at twice the output rate
+		const int Lw = L - 5 * S;
+		const double fc = 0.5 * out_rate / in_rate;
+		const double a0 = 0.35875, a1 = 0.48829, a2 = 0.14128, a3 = 0.01168;
+
+		std::vector<double> h(L, 0.0);
+
+		for (int n = 0; n < Lw; n++) {
+			double t = n - (Lw - 1) / 2.0;
+			double x = 2 * fc * t;
+			double s = t == 0 ? 1.0 : std::sin(PI * x) / (PI * x);
+			double p = 2 * PI * n / (Lw - 1);
+
+			h[n] = s * (a0 - a1 * std::cos(p) + a2 * std::cos(2 * p) - a3 * std::cos(3 * p));
+		}
+
+		// (1 + z^-S)^5, in place from the back
+		for (int k = 0, len = Lw; k < 5; k++, len += S)
+			for (int n = len + S - 1; n >= S; n--) h[n] += h[n - S];
+
+		double sum = 0;
+		for (double v : h) sum += v;
+
+		// unit gain at the bin centre, stored reversed to run along the input
+		taps.resize(L);
+		for (int n = 0; n < L; n++) taps[n] = (FLOAT32)(h[L - 1 - n] / sum);
+	}
+
+	int Channelizer::addChannel(int offset) {
+		if (!M) throw std::runtime_error("Channelizer: channel added before the sample rate is set.");
+
+		Channel c;
+		c.bin = (int)std::lround((double)offset * M / in_rate);
+
+		FLOAT32 residual = (FLOAT32)offset - (FLOAT32)c.bin * in_rate / M;
+		// the bin output turns by bin * D / M cycles per sample
+		double cycles = (double)c.bin * D / M + residual / out_rate;
+		c.mult = std::polar(1.0f, (float)(-2 * PI * (cycles - std::floor(cycles))));
+
+		// branch i holds the window sample M - 1 - i modulo M
+		c.twiddle.resize(M);
+		for (int i = 0; i < M; i++)
+			c.twiddle[i] = std::polar(1.0f, (float)(2 * PI * (((long)c.bin * (M - 1 - i)) & (M - 1)) / M));
+
+		channels.push_back(c);
+		out.resize(channels.size());
+
+		// an FFT costs M / 2 * log2(M) butterflies, a single bin M products
+		use_fft = (int)channels.size() * 2 > logM;
+
+		return (int)channels.size() - 1;
+	}
+
+	void Channelizer::Receive(const CFLOAT32* data, int len, TAG& tag) {
+		const int L = (int)taps.size();
+
+		if (buffer.size() < L - 1 + len) buffer.resize(L - 1 + len);
+		std::memcpy(&buffer[L - 1], data, len * sizeof(CFLOAT32));
+
+		for (auto& c : channels)
+			if (c.output.size() < c.count + len / D + 2) c.output.resize(c.count + len / D + 2);
+
+		for (; idx_in < len; idx_in += D) {
+			// fold the filtered window onto M branches
+			const CFLOAT32* w = &buffer[idx_in];
+			const FLOAT32* h = taps.data();
+
+			for (int i = 0; i < M; i++) acc[i] = h[i] * w[i];
+			for (int r = M; r < L; r += M)
+				for (int i = 0; i < M; i++) acc[i] += h[r + i] * w[r + i];
+
+			if (use_fft) {
+				for (int m = 0; m < M; m++) fft_data[reversed[m]] = acc[M - 1 - m];
+
+				fft_plan.fft(fft_data);
+
+				for (auto& c : channels) {
+					c.output[c.count++] = fft_data[(M - c.bin) & (M - 1)] * c.rot;
+					c.rot *= c.mult;
+				}
+			}
+			else {
+				for (auto& c : channels) {
+					const CFLOAT32* t = c.twiddle.data();
+					CFLOAT32 y = 0.0f;
+
+					for (int i = 0; i < M; i++) y += acc[i] * t[i];
+
+					c.output[c.count++] = y * c.rot;
+					c.rot *= c.mult;
+				}
+			}
+		}
+
+		idx_in -= len;
+		std::memmove(buffer.data(), &buffer[len], (L - 1) * sizeof(CFLOAT32));
+
+		// the CIC filters downstream take pairs of samples
+		for (int i = 0; i < channels.size(); i++) {
+			Channel& c = channels[i];
+			int n = c.count & ~1;
+
+			if (n) out[i].Send(c.output.data(), n, tag);
+
+			if (c.count & 1) c.output[0] = c.output[n];
+			c.count &= 1;
+			c.rot /= std::abs(c.rot);
+		}
+	}
+
 	void SOXR::setParams(int sample_rate, int out_rate) {
 #ifdef HASSOXR
 		soxr_error_t error;
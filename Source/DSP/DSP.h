@@ -41,6 +41,28 @@ namespace DSP
 
 	public:
 		virtual ~SimplePLL() {}
+
+		// true if the sample is taken as a bit
+		inline bool Run(FLOAT32 sample)
+		{
+			BIT bit = (sample > 0);
+
+			if (bit != prev)
+			{
+				PLL += (0.5f - PLL) * (FastPLL ? 0.6f : 0.05f);
+			}
+
+			PLL += 0.2f;
+			prev = bit;
+
+			if (PLL >= 1.0f)
+			{
+				PLL -= (int)PLL;
+				return true;
+			}
+			return false;
+		}
+
 		// StreamIn
 		virtual void Receive(const FLOAT32 *data, int len, TAG &tag);
 
@@ -295,6 +317,7 @@ namespace DSP
 			alpha = a;
 			beta = 1 - 2 * a;
 		}
+		FLOAT32 getTaps() const { return alpha; }
 
 		// StreamIn
 		void Receive(const CFLOAT32 *data, int len, TAG &tag);
@@ -318,6 +341,127 @@ namespace DSP
 		void Receive(const CFLOAT32 *data, int len, TAG &tag);
 	};
 
+	// CU8 straight to the two 48K channels: the conversion, the CIC5 halvings (or
+	// the decimate by 3 filter), droop compensation, the +/-25K rotation and the
+	// final halving per channel run over one tile at a time, in place, so only
+	// the 48K output is written to memory. The arithmetic per sample is that of
+	// the separate blocks.
+	class FusedDownsampleCU8 : public StreamIn<CU8>
+	{
+		static const int TILE = 4096;
+
+		struct CIC5
+		{
+			CFLOAT32 h0 = 0, h1 = 0, h2 = 0, h3 = 0, h4 = 0;
+			// halves data in place, len even
+			void run(CFLOAT32 *data, int len);
+		};
+
+		FLOAT32 lut[256];
+
+		std::vector<CIC5> cic;
+		CIC5 cic_a, cic_b;
+
+		std::vector<FLOAT32> taps;
+		int K = 1;
+
+		bool droop = false;
+		FLOAT32 alpha = 0.0f, beta = 1.0f;
+		CFLOAT32 d1 = 0.0f, d2 = 0.0f;
+
+		CFLOAT32 rot = 1.0f, mult = 1.0f;
+
+		// filter history, then the tile of converted samples
+		std::vector<CFLOAT32> buffer;
+		int history = 0;
+		int pending = 0;
+		int granule = 2; // input samples per pair of 48K outputs
+
+		std::vector<CFLOAT32> output_up, output_down;
+		int count = 0;
+
+		inline CFLOAT32 dot(const CFLOAT32 *data)
+		{
+			CFLOAT32 x = 0.0f;
+			for (int i = 0; i < taps.size(); i++)
+				x += taps[i] * *data++;
+			return x;
+		}
+
+		void process(int len);
+		void setup();
+
+	public:
+		FusedDownsampleCU8();
+		virtual ~FusedDownsampleCU8() {}
+
+		// stages CIC5 halvings down to 96K, optionally followed by the droop filter
+		void setCIC(int stages, bool droop, FLOAT32 a);
+		// decimation by k with a FIR filter down to 96K
+		void setFIR(const std::vector<FLOAT32> &t, int k);
+		void setRotation(float angle) { mult = std::polar(1.0f, angle); }
+
+		// Streams out
+		Connection<CFLOAT32> up;
+		Connection<CFLOAT32> down;
+
+		// Streams in
+		void Receive(const CU8 *data, int len, TAG &tag);
+	};
+
+	// Polyphase filter bank: one pass of the prototype filter per output sample
+	// folds the input onto M branches, and one FFT of those turns them into M
+	// bins. Bins are a quarter of the output rate apart, so they overlap and a
+	// channel is never more than an eighth of the output rate from a bin centre;
+	// each channel takes its nearest bin and a rotation removes the rest of its
+	// offset. The work per input sample depends on M, not on the number of
+	// channels, except that a few channels are cheaper to take out one by one
+	// than with a full FFT.
+	class Channelizer : public StreamIn<CFLOAT32>
+	{
+		static const int OVERSAMPLE = 4;
+		static const int TAPS_PER_BRANCH = 4;
+
+		struct Channel
+		{
+			int bin = 0;
+			CFLOAT32 rot = 1.0f, mult = 1.0f;
+			std::vector<CFLOAT32> twiddle; // the single bin DFT over the branches
+			std::vector<CFLOAT32> output;
+			int count = 0;
+		};
+
+		std::vector<Channel> channels;
+
+		int M = 0, logM = 0, D = 0;
+		int in_rate = 0, out_rate = 0;
+
+		std::vector<FLOAT32> taps; // reversed prototype, M * TAPS_PER_BRANCH
+		std::vector<CFLOAT32> buffer, acc, fft_data;
+		std::vector<int> reversed;
+		int idx_in = 0;
+		bool use_fft = false;
+
+		FFT::Plan<FLOAT32> fft_plan;
+
+		void design();
+
+	public:
+		virtual ~Channelizer() {}
+
+		// the input rate over the output rate must be a power of 2
+		void setParams(int sample_rate, int output_rate);
+		// offset in Hz from the tuned frequency, after setParams; returns the index into out
+		int addChannel(int offset);
+		int getBins() const { return M; }
+
+		// Streams out
+		std::vector<Connection<CFLOAT32>> out;
+
+		// Streams in
+		void Receive(const CFLOAT32 *data, int len, TAG &tag);
+	};
+
 	class SOXR : public SimpleStreamInOut<CFLOAT32, CFLOAT32>
 	{
 #ifdef HASSOXR
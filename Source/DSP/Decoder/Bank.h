@@ -0,0 +1,82 @@
+/*
+	Copyright(c) 2021-2026 jvde.github@gmail.com
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <vector>
+
+#include "AIS.h"
+#include "Common.h"
+#include "Stream.h"
+#include "DSP.h"
+
+// Bit recovery that hands its bits to the decoders itself, a block per call
+// instead of a stream call per bit. The decoders still see every bit in the
+// original order: a found message resets the other phases, and the decoder
+// state sets the loop gain of the PLL, from the very next bit on.
+namespace DSP
+{
+	// Deinterleave in front of one decoder per phase of the symbol
+	class DecoderBank : public StreamIn<FLOAT32>
+	{
+		std::vector<AIS::Decoder *> decoders;
+		int lastSymbol = 0;
+		long long sample_idx = 0;
+
+	public:
+		virtual ~DecoderBank() {}
+
+		void add(AIS::Decoder &d) { decoders.push_back(&d); }
+
+		void Receive(const FLOAT32 *data, int len, TAG &tag)
+		{
+			const int n = (int)decoders.size();
+
+			for (int i = 0; i < len; i++)
+			{
+				tag.sample_idx = sample_idx++;
+				decoders[lastSymbol]->Run(data[i], tag);
+
+				if (++lastSymbol == n)
+					lastSymbol = 0;
+			}
+		}
+	};
+
+	// SimplePLL in front of a decoder
+	class DecoderPLL : public StreamIn<FLOAT32>
+	{
+		SimplePLL pll;
+		AIS::Decoder *decoder = nullptr;
+
+	public:
+		virtual ~DecoderPLL() {}
+
+		void setDecoder(AIS::Decoder &d)
+		{
+			decoder = &d;
+			d.DecoderMessage.Connect(pll);
+		}
+
+		void Receive(const FLOAT32 *data, int len, TAG &tag)
+		{
+			for (int i = 0; i < len; i++)
+				if (pll.Run(data[i]))
+					decoder->Run(data[i], tag);
+		}
+	};
+}
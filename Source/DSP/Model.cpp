@@ -32,6 +32,23 @@ namespace AIS
 
 		Connection<RAW> &physical = timerOn ? (*device >> timer).out : device->out;
 
+		if (device->getFormat() == Format::BASEBAND)
+		{
+			// an edge did the downsampling and sends the 48K channels
+			physical >> baseband;
+
+			C_a = &baseband.a;
+			C_b = &baseband.b;
+
+			if (dump)
+			{
+				*C_a >> convertA >> wavA;
+				*C_b >> convertB >> wavB;
+			}
+
+			return;
+		}
+
 		if (mode == AIS::Mode::X)
 		{
 
@@ -124,6 +141,44 @@ namespace AIS
 			DS_MA.setRates(sample_rate, 96000);
 			physical >> convert >> DS_MA >> ROT;
 		}
+		else if (PFB_DS)
+		{
+			// the filter bank takes power of 2 multiples of 96K; others are upsampled at
+			// the input rate, ahead of the bank, except 288K which the cascade takes as is
+			if (sample_rate == 288000)
+				throw std::runtime_error("Model: the filter bank does not support 288K, use a power of 2 multiple of 96K or -go PFB off.");
+
+			const std::vector<uint32_t> definedRates = {96000, 192000, 384000, 768000, 1536000, 3072000, 6144000, 12288000};
+
+			uint32_t bucket = 0xFFFF;
+			bool interpolated = false;
+
+			for (uint32_t r : definedRates)
+				if (r >= sample_rate)
+				{
+					bucket = r;
+					if (r != sample_rate)
+						interpolated = true;
+					break;
+				}
+
+			if (interpolated)
+				Warning() << "sample rate " << sample_rate / 1000 << "K upsampled to " << bucket / 1000 << "K.";
+
+			US.setParams(sample_rate, bucket);
+			PFB.setParams(bucket, 48000);
+			PFB.addChannel(-25000);
+			PFB.addChannel(25000);
+
+			Debug() << "Model: filter bank with " << PFB.getBins() << " bins";
+
+			physical >> convert;
+
+			if (interpolated)
+				convert >> US >> PFB;
+			else
+				convert >> PFB;
+		}
 		else
 		{
 			const std::vector<uint32_t> definedRatesNoDSK = {96000, 192000, 288000, 384000, 768000, 1536000, 3072000, 6144000, 12288000};
@@ -336,10 +391,45 @@ namespace AIS
 			default:
 				throw std::runtime_error("Model: internal error. Sample rate should be supported.");
 			}
+
+			// CU8 input on the rates without resampling takes the fused path instead, the chain above stays for the other formats
+			if (FUSED_DS && !interpolated && !(fixedpointDS && bucket == 1536000))
+			{
+				int stages = 0;
+				while ((96000u << stages) < bucket)
+					stages++;
+
+				bool fuse = true;
+
+				if ((96000u << stages) == bucket)
+					FUSED.setCIC(stages, droop_compensation && stages > 0, FDC.getTaps());
+				else if (bucket == 288000)
+					FUSED.setFIR(Filters::BlackmanHarris_28_3, 3);
+				else
+					fuse = false;
+
+				if (fuse)
+				{
+					Debug() << "Model: fused CU8 front-end";
+
+					FUSED.setRotation((float)(PI * 25000.0 / 48000.0));
+					convert.outCU8 >> FUSED;
+					FUSED.up >> FCIC5_a;
+					FUSED.down >> FCIC5_b;
+				}
+			}
 		}
 
-		ROT.up >> DS2_a >> FCIC5_a;
-		ROT.down >> DS2_b >> FCIC5_b;
+		if (PFB_DS)
+		{
+			PFB.out[0] >> FCIC5_a;
+			PFB.out[1] >> FCIC5_b;
+		}
+		else
+		{
+			ROT.up >> DS2_a >> FCIC5_a;
+			ROT.down >> DS2_b >> FCIC5_b;
+		}
 
 		// pick up point for downstream decoders
 		C_a = &FCIC5_a.out;
@@ -367,16 +457,28 @@ namespace AIS
 			SOXR_DS = Util::Parse::Switch(arg);
 			SAMPLERATE_DS = false;
 			MA_DS = false;
+			PFB_DS = false;
 			break;
 		case AIS::KEY_SETTING_SRC:
 			SAMPLERATE_DS = Util::Parse::Switch(arg);
 			SOXR_DS = false;
 			MA_DS = false;
+			PFB_DS = false;
 			break;
 		case AIS::KEY_SETTING_MA:
 			MA_DS = Util::Parse::Switch(arg);
 			SAMPLERATE_DS = false;
 			SOXR_DS = false;
+			PFB_DS = false;
+			break;
+		case AIS::KEY_SETTING_PFB:
+			PFB_DS = Util::Parse::Switch(arg);
+			SAMPLERATE_DS = false;
+			SOXR_DS = false;
+			MA_DS = false;
+			break;
+		case AIS::KEY_SETTING_FUSED:
+			FUSED_DS = Util::Parse::Switch(arg);
 			break;
 		case AIS::KEY_SETTING_DSK:
 			allowDSK = Util::Parse::Switch(arg);
@@ -412,8 +514,10 @@ namespace AIS
 			return "src ON " + Model::Get();
 		else if (MA_DS)
 			return "MA ON " + Model::Get();
+		else if (PFB_DS)
+			return "pfb ON " + Model::Get();
 
-		return "droop " + Util::Convert::toString(droop_compensation) + " fp_ds " + Util::Convert::toString(fixedpointDS) + " dsk " + Util::Convert::toString(allowDSK) + " " + Model::Get();
+		return "droop " + Util::Convert::toString(droop_compensation) + " fp_ds " + Util::Convert::toString(fixedpointDS) + " dsk " + Util::Convert::toString(allowDSK) + " fused " + Util::Convert::toString(FUSED_DS) + " " + Model::Get();
 	}
 
 	void ModelBase::buildModel(char CH1, char CH2, int sample_rate, bool timerOn, Device::Device *dev)
@@ -428,15 +532,60 @@ namespace AIS
 		DEC_a.setOrigin(CH1, station, own_mmsi);
 		DEC_b.setOrigin(CH2, station, own_mmsi);
 
-		*C_a >> FM_a >> FR_a >> sampler_a >> DEC_a >> output;
-		*C_b >> FM_b >> FR_b >> sampler_b >> DEC_b >> output;
+		*C_a >> FM_a >> FR_a >> sampler_a;
+		*C_b >> FM_b >> FR_b >> sampler_b;
 
-		DEC_a.DecoderMessage.Connect(sampler_a);
-		DEC_b.DecoderMessage.Connect(sampler_b);
+		sampler_a.setDecoder(DEC_a);
+		sampler_b.setDecoder(DEC_b);
+		DEC_a >> output;
+		DEC_b >> output;
 
 		return;
 	}
 
+	void ModelEdge::buildModel(char CH1, char CH2, int sample_rate, bool timerOn, Device::Device *dev)
+	{
+		if (dev->getFormat() == Format::BASEBAND)
+			throw std::runtime_error("Model: an edge cannot take its input from another edge.");
+
+		ModelFrontend::buildModel(CH1, CH2, sample_rate, timerOn, dev);
+
+		assert(C_a != NULL && C_b != NULL);
+
+		*C_a >> encoder.a;
+		*C_b >> encoder.b;
+		encoder >> server;
+
+		server.Start();
+	}
+
+	Setting &ModelEdge::SetKey(AIS::Keys key, const std::string &arg)
+	{
+		switch (key)
+		{
+		case AIS::KEY_SETTING_PORT:
+			server.setPort(Util::Parse::Integer(arg, 0, 0xFFFF));
+			break;
+		case AIS::KEY_SETTING_FORMAT:
+		{
+			Format f;
+			if (!Util::Parse::StreamFormat(arg, f) || (f != Format::CS8 && f != Format::CS16))
+				throw std::runtime_error("Model: edge format must be CS8 or CS16.");
+			encoder.setWidth(f == Format::CS8 ? 1 : 2);
+			break;
+		}
+		default:
+			ModelFrontend::SetKey(key, arg);
+			break;
+		}
+		return *this;
+	}
+
+	std::string ModelEdge::Get()
+	{
+		return "port " + std::to_string(server.getPort()) + " format " + (encoder.getWidth() == 1 ? "CS8" : "CS16") + " " + ModelFrontend::Get();
+	}
+
 	void ModelEngineV2::buildModel(char CH1, char CH2, int sample_rate, bool timerOn, Device::Device *dev)
 	{
 		ModelFrontend::buildModel(CH1, CH2, sample_rate, timerOn, dev);
@@ -490,9 +639,6 @@ namespace AIS
 		FR_a.setTaps(Filters::Receiver);
 		FR_b.setTaps(Filters::Receiver);
 
-		S_a.setConnections(N_SAMPLES_PER_SYMBOL);
-		S_b.setConnections(N_SAMPLES_PER_SYMBOL);
-
 		*C_a >> FM_a >> FR_a >> S_a;
 		*C_b >> FM_b >> FR_b >> S_b;
 
@@ -501,8 +647,10 @@ namespace AIS
 			DEC_a[i].setOrigin(CH1, station, own_mmsi);
 			DEC_b[i].setOrigin(CH2, station, own_mmsi);
 
-			S_a.out[i] >> DEC_a[i] >> output;
-			S_b.out[i] >> DEC_b[i] >> output;
+			S_a.add(DEC_a[i]);
+			S_b.add(DEC_b[i]);
+			DEC_a[i] >> output;
+			DEC_b[i] >> output;
 
 			for (int j = 0; j < N_SAMPLES_PER_SYMBOL; j++)
 			{
@@ -708,9 +856,6 @@ namespace AIS
 		FR_a.setTaps(Filters::Receiver);
 		FR_b.setTaps(Filters::Receiver);
 
-		S_a.setConnections(N_SAMPLES_PER_SYMBOL);
-		S_b.setConnections(N_SAMPLES_PER_SYMBOL);
-
 		Connection<RAW> &physical = timerOn ? (*device >> timer).out : device->out;
 
 		if (sample_rate == 48000)
@@ -734,8 +879,10 @@ namespace AIS
 
 		for (int i = 0; i < N_SAMPLES_PER_SYMBOL; i++)
 		{
-			S_a.out[i] >> DEC_a[i] >> output;
-			S_b.out[i] >> DEC_b[i] >> output;
+			S_a.add(DEC_a[i]);
+			S_b.add(DEC_b[i]);
+			DEC_a[i] >> output;
+			DEC_b[i] >> output;
 
 			DEC_a[i].setOrigin(CH1, station, own_mmsi);
 			DEC_b[i].setOrigin(CH2, station, own_mmsi);
@@ -757,11 +904,22 @@ namespace AIS
 	{
 		device = dev;
 		Connection<RAW> &physical = timerOn ? (*device >> timer).out : device->out;
-		physical >> nmea >> output;
-		nmea.outGPS >> output_gps;
 
 		nmea.setStation(station);
 		nmea.setOwnMMSI(own_mmsi);
+
+		int n = device->getConcurrency();
+		if (n > 1)
+		{
+			parallel.reset(new NMEAParallel(nmea, n));
+			physical >> *parallel >> output;
+			parallel->outGPS >> output_gps;
+		}
+		else
+		{
+			physical >> nmea >> output;
+			nmea.outGPS >> output_gps;
+		}
 	}
 
 	Setting &ModelNMEA::SetKey(AIS::Keys key, const std::string &arg)
@@ -878,6 +1036,30 @@ namespace AIS
 		return Model::Get();
 	}
 
+	void ModelModeS::buildModel(char CH1, char CH2, int sample_rate, bool timerOn, Device::Device *dev)
+	{
+		device = dev;
+
+		if (sample_rate != 2400000)
+			throw std::runtime_error("Model: the Mode-S demodulator needs a sample rate of 2400K.");
+
+		if (device->getFormat() != Format::CU8 && device->getFormat() != Format::CS8)
+			throw std::runtime_error("Model: the Mode-S demodulator needs CU8 or CS8 input.");
+
+		Connection<RAW> &physical = timerOn ? (*device >> timer).out : device->out;
+		physical >> model >> outputADSB;
+	}
+
+	Setting &ModelModeS::SetKey(AIS::Keys key, const std::string &arg)
+	{
+		return Model::SetKey(key, arg);
+	}
+
+	std::string ModelModeS::Get()
+	{
+		return Model::Get();
+	}
+
 	Setting &ModelExport::SetKey(AIS::Keys key, const std::string &arg)
 	{
 		return Model::SetKey(key, arg);
@@ -26,11 +26,14 @@
 #include "N2K.h"
 #include "Basestation.h"
 #include "Beast.h"
+#include "ModeS.h"
 
 #include "DSP.h"
 #include "Demod.h"
 #include "Decoder/V2/V2Engine.h"
+#include "Decoder/Bank.h"
 #include "StreamHelpers.h"
+#include "Baseband.h"
 
 #include "Device/Device.h"
 
@@ -52,7 +55,8 @@ namespace AIS
 		FM,
 		TXT,
 		N2K,
-		BASESTATION
+		BASESTATION,
+		MODES
 	};
 
 	// The legacy "-m" / "model" selector, which Receiver::addModel() maps to a
@@ -68,7 +72,9 @@ namespace AIS
 		MODEL_BEAST = 8,
 		MODEL_RAW1090 = 10,
 		MODEL_V2_BASE = 11,
-		MODEL_MAX = 11
+		MODEL_EDGE = 12,
+		MODEL_MODES = 13,
+		MODEL_MAX = 13
 	};
 
 
@@ -138,10 +144,14 @@ namespace AIS
 		DSP::FilterCIC5 FCIC5_a, FCIC5_b;
 		DSP::FilterComplex3Tap FDC;
 		DSP::DownsampleMovingAverage DS_MA;
+		DSP::Channelizer PFB;
+		DSP::FusedDownsampleCU8 FUSED;
 		// fixed point downsamplers
 		DSP::Downsample16_CU8 DS16_CU8;
 
 		Util::ConvertRAW convert;
+		// the 48K channels from an edge instead
+		IO::BasebandDecoder baseband;
 
 	protected:
 		bool fixedpointDS = false;
@@ -149,6 +159,8 @@ namespace AIS
 		bool SOXR_DS = false;
 		bool SAMPLERATE_DS = false;
 		bool MA_DS = false;
+		bool PFB_DS = false;
+		bool FUSED_DS = true;
 		bool allowDSK = false;
 
 		Connection<CFLOAT32> *C_a = nullptr, *C_b = nullptr;
@@ -177,7 +189,7 @@ namespace AIS
 
 		DSP::Filter FR_a, FR_b;
 		AIS::Decoder DEC_a[N_SAMPLES_PER_SYMBOL], DEC_b[N_SAMPLES_PER_SYMBOL];
-		DSP::Deinterleave<FLOAT32> S_a, S_b;
+		DSP::DecoderBank S_a, S_b;
 
 	public:
 		void buildModel(char, char, int, bool, Device::Device *);
@@ -192,7 +204,7 @@ namespace AIS
 	private:
 		Demod::FM FM_a, FM_b;
 		DSP::Filter FR_a, FR_b;
-		DSP::SimplePLL sampler_a, sampler_b;
+		DSP::DecoderPLL sampler_a, sampler_b;
 		AIS::Decoder DEC_a, DEC_b;
 
 	public:
@@ -277,6 +289,23 @@ namespace AIS
 		std::string Get();
 	};
 
+	// Edge of an edge/core split: the front-end only, its 48K channels served to a
+	// core that decodes them, at a fraction of the bandwidth of the IQ stream
+	class ModelEdge : public ModelFrontend
+	{
+	public:
+		ModelEdge() { setName("Edge (48K channels out)"); }
+
+	private:
+		IO::BasebandEncoder encoder;
+		IO::BasebandServer server;
+
+	public:
+		void buildModel(char, char, int, bool, Device::Device *);
+		Setting &SetKey(AIS::Keys key, const std::string &arg);
+		std::string Get();
+	};
+
 	// Standard demodulation model for FM discriminator input
 	class ModelDiscriminator : public Model
 	{
@@ -290,7 +319,7 @@ namespace AIS
 
 		DSP::Filter FR_a, FR_b;
 		AIS::Decoder DEC_a[N_SAMPLES_PER_SYMBOL], DEC_b[N_SAMPLES_PER_SYMBOL];
-		DSP::Deinterleave<FLOAT32> S_a, S_b;
+		DSP::DecoderBank S_a, S_b;
 
 		Util::ConvertRAW convert;
 
@@ -307,6 +336,8 @@ namespace AIS
 
 	private:
 		NMEA nmea;
+		// replaces nmea when the input delivers large blocks for several decoders
+		std::unique_ptr<NMEAParallel> parallel;
 
 	public:
 		void buildModel(char, char, int, bool, Device::Device *);
@@ -375,6 +406,22 @@ namespace AIS
 		ModelClass getClass() { return ModelClass::BASESTATION; }
 	};
 
+	// Mode-S/ADS-B straight from 1090 MHz IQ at 2.4 Msps
+	class ModelModeS : public Model
+	{
+	public:
+		ModelModeS() { setName("Mode-S demodulator"); }
+
+	private:
+		ModeS model;
+
+	public:
+		void buildModel(char, char, int, bool, Device::Device *);
+		Setting &SetKey(AIS::Keys key, const std::string &arg);
+		std::string Get();
+		ModelClass getClass() { return ModelClass::MODES; }
+	};
+
 	class ModelExport : public Model
 	{
 	public:
@@ -163,6 +163,14 @@ namespace Device {
 			return getProduct() + ":" + getSerial();
 		}
 
+		// Per-line traffic summary for verbose output, empty when the device
+		// has nothing beyond what the models report.
+		virtual std::vector<std::string> getStatistics() { return {}; }
+
+		// Decoder instances the input is sized for: above 1 it sends large
+		// line-aligned text blocks that a model may split over threads.
+		virtual int getConcurrency() { return 1; }
+
 		virtual void setFormat(Format f) { format = f; }
 		virtual Format getFormat() { return format; }
 		Type getDriver() { return DeviceType; }
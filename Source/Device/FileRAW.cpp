@@ -17,8 +17,12 @@
 
 #include <cstring>
 
+#include <algorithm>
+
 #ifndef _WIN32
 #include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
 #include <sys/stat.h>
 #include <poll.h>
 #include <cerrno>
@@ -26,6 +30,7 @@
 
 #include "FileRAW.h"
 #include "Logger.h"
+#include "ZIP.h"
 
 namespace Device
 {
@@ -33,80 +38,112 @@ namespace Device
 	//---------------------------------------
 	// RAW CU8 file
 
+	// next chunk of input into buffer: bytes read, 0 to try again, -1 at the end
+	long RAWFile::readChunk()
+	{
+#ifndef _WIN32
+		if (use_raw_stdin)
+		{
+			struct pollfd pfd;
+			pfd.fd = STDIN_FILENO;
+			pfd.events = POLLIN;
+			pfd.revents = 0;
+
+			int pr = poll(&pfd, 1, 250);
+			if (pr <= 0)
+			{
+				// timeout or EINTR: re-check isStreaming(); real error: stop
+				return (pr < 0 && errno != EINTR) ? -1 : 0;
+			}
+
+			ssize_t bytesRead = ::read(STDIN_FILENO, buffer.data(), buffer.size());
+			return bytesRead > 0 ? (long)bytesRead : -1;
+		}
+#endif
+		if (!file || file->eof())
+			return -1;
+
+		file->read((char *)buffer.data(), buffer.size());
+		return (long)file->gcount();
+	}
+
 	void RAWFile::ReadAsync()
 	{
+		bool is_text = getFormat() == Format::TXT || getFormat() == Format::BASESTATION || getFormat() == Format::BEAST || getFormat() == Format::RAW1090;
+		bool detect = true;
+		size_t total = 0;
+
+		StreamUnzip unzip;
+		StreamUnzip::Codec codec = StreamUnzip::Codec::NONE;
+
+		// decompressed output goes into the FIFO in pieces it can always take. A
+		// full FIFO drops the piece as it drops an uncompressed block, but the
+		// decoder must still consume its input to stay in sync: only stop on halt.
+		auto push = [&](const char *data, size_t len)
+		{
+			total += len;
+			return fifo.Push((char *)data, (int)len) || !fifo.Halted();
+		};
 
 		try
 		{
-#ifndef _WIN32
-			if (use_raw_stdin)
+			while (Device::isStreaming())
 			{
-				size_t total = 0;
+				long bytesRead = readChunk();
 
-				while (Device::isStreaming())
+				if (bytesRead < 0)
 				{
-					struct pollfd pfd;
-					pfd.fd = STDIN_FILENO;
-					pfd.events = POLLIN;
-					pfd.revents = 0;
-
-					int pr = poll(&pfd, 1, 250);
-					if (pr <= 0)
+					if (loop && file && !use_raw_stdin)
 					{
-						// timeout or EINTR: re-check isStreaming(); real error: stop
-						if (pr < 0 && errno != EINTR)
-							break;
+						file->clear();
+						file->seekg(0, std::ios::beg);
+						detect = true;
 						continue;
 					}
+					break;
+				}
+
+				if (bytesRead == 0)
+					continue;
 
-					ssize_t bytesRead = ::read(STDIN_FILENO, buffer.data(), buffer.size());
-					if (bytesRead <= 0)
-						break;
+				if (detect)
+				{
+					detect = false;
+					codec = StreamUnzip::detect(buffer.data(), bytesRead);
 
-					fifo.Push(buffer.data(), (int)bytesRead);
-					total += bytesRead;
+					if (codec != StreamUnzip::Codec::NONE)
+					{
+						if (!unzip.init(codec, buffer.size()))
+							throw std::runtime_error(std::string("input is ") + StreamUnzip::name(codec) + " compressed, which this build cannot read.");
+						Debug() << "FILE: decompressing " << StreamUnzip::name(codec) << " input.";
+					}
 				}
 
-				// the FIFO only releases whole blocks: pad the I/Q tail, never text
-				bool is_text = getFormat() == Format::TXT || getFormat() == Format::BASESTATION || getFormat() == Format::BEAST || getFormat() == Format::RAW1090;
-				int rem = (int)(total % fifo.BlockSize());
-				if (rem > 0 && !is_text)
+				if (codec != StreamUnzip::Codec::NONE)
 				{
-					std::memset(buffer.data(), 0, fifo.BlockSize() - rem);
-					fifo.Push(buffer.data(), fifo.BlockSize() - rem);
+					if (!unzip.feed(buffer.data(), bytesRead, push))
+						throw std::runtime_error(std::string("corrupt ") + StreamUnzip::name(codec) + " input.");
 				}
-			}
-			else
-#endif
-				while (file && Device::isStreaming())
+				else if (use_raw_stdin)
 				{
+					push(buffer.data(), bytesRead);
+				}
+				else
+				{
+					if (bytesRead < (long)buffer.size())
+						std::memset(buffer.data() + bytesRead, 0, buffer.size() - bytesRead);
 
-					if (!file->eof())
-					{
-						file->read((char *)buffer.data(), buffer.size());
-						std::streamsize bytesRead = file->gcount();
-
-						if (bytesRead > 0)
-						{
-							if (bytesRead < buffer.size())
-								std::memset(buffer.data() + bytesRead, 0, buffer.size() - bytesRead);
-
-							fifo.Push(buffer.data(), buffer.size());
-						}
-					}
-					else
-					{
-						if (loop)
-						{
-							file->clear();
-							file->seekg(0, std::ios::beg);
-						}
-						else
-						{
-							break;
-						}
-					}
+					fifo.Push(buffer.data(), buffer.size());
 				}
+			}
+
+			// the FIFO only releases whole blocks: pad the I/Q tail, never text
+			int rem = (int)(total % fifo.BlockSize());
+			if (rem > 0 && !is_text)
+			{
+				std::memset(buffer.data(), 0, fifo.BlockSize() - rem);
+				fifo.Push(buffer.data(), fifo.BlockSize() - rem);
+			}
 		}
 		catch (std::exception &e)
 		{
@@ -151,6 +188,106 @@ namespace Device
 		}
 	}
 
+	bool RAWFile::isMappable()
+	{
+#ifndef _WIN32
+		if (workers <= 1 || getFormat() != Format::TXT || filename == "." || filename == "stdin")
+			return false;
+
+		// compressed input streams through the reader thread instead
+		char magic[4] = {0};
+		std::ifstream f(filename, std::ios::in | std::ios::binary);
+		f.read(magic, sizeof(magic));
+		return StreamUnzip::detect(magic, (size_t)f.gcount()) == StreamUnzip::Codec::NONE;
+#else
+		return false;
+#endif
+	}
+
+	void RAWFile::mapFile()
+	{
+#ifndef _WIN32
+		int fd = open(filename.c_str(), O_RDONLY);
+		if (fd < 0)
+			throw std::runtime_error("FILE: Cannot open input.");
+
+		struct stat st;
+		if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode))
+		{
+			close(fd);
+			throw std::runtime_error("FILE: parallel decoding needs a regular file.");
+		}
+
+		map_size = (size_t)st.st_size;
+		if (map_size)
+		{
+			void *m = mmap(nullptr, map_size, PROT_READ, MAP_PRIVATE, fd, 0);
+			if (m == MAP_FAILED)
+			{
+				close(fd);
+				map_size = 0;
+				throw std::runtime_error("FILE: cannot map input into memory.");
+			}
+			madvise(m, map_size, MADV_SEQUENTIAL);
+			map = (const char *)m;
+		}
+		close(fd);
+#endif
+	}
+
+	void RAWFile::unmapFile()
+	{
+#ifndef _WIN32
+		if (map)
+			munmap((void *)map, map_size);
+#endif
+		map = nullptr;
+		map_size = 0;
+	}
+
+	void RAWFile::RunMapped()
+	{
+		const size_t slice = (size_t)workers * MAPPED_SLICE;
+		size_t pos = 0;
+
+		try
+		{
+			while (isStreaming())
+			{
+				if (pos >= map_size)
+				{
+					// end of the file: lets the decoder take a last line without newline
+					RAW eof = {Format::TXT, (void *)map, 0};
+					Send(&eof, 1, tag);
+
+					if (loop && map_size)
+					{
+						pos = 0;
+						continue;
+					}
+					done = true;
+					break;
+				}
+
+				size_t end = std::min(map_size, pos + slice);
+				if (end < map_size)
+				{
+					const char *nl = (const char *)memchr(map + end, '\n', map_size - end);
+					end = nl ? (size_t)(nl - map) + 1 : map_size;
+				}
+
+				RAW r = {Format::TXT, (void *)(map + pos), (int)(end - pos)};
+				Send(&r, 1, tag);
+				pos = end;
+			}
+		}
+		catch (std::exception &e)
+		{
+			Error() << "RAWFile Run: " << e.what();
+			StopRequest();
+		}
+	}
+
 	bool RAWFile::isReplay()
 	{
 		bool is_stdin = (filename == "." || filename == "stdin");
@@ -168,6 +305,14 @@ namespace Device
 	{
 		Device::Play();
 
+		if (isMappable())
+		{
+			mapFile();
+			done = false;
+			run_thread = std::thread(&RAWFile::RunMapped, this);
+			return;
+		}
+
 		bool is_text = getFormat() == Format::TXT || getFormat() == Format::BASESTATION || getFormat() == Format::BEAST || getFormat() == Format::RAW1090;
 
 		if (!is_text)
@@ -222,6 +367,8 @@ namespace Device
 
 	void RAWFile::Close()
 	{
+		unmapFile();
+
 		if (file && file != &std::cin)
 		{
 			delete file;
@@ -245,6 +392,10 @@ namespace Device
 		case AIS::KEY_SETTING_LOSSLESS:
 			lossless = Util::Parse::Switch(arg);
 			break;
+		case AIS::KEY_SETTING_WORKERS:
+			if (Util::Parse::AutoInteger(arg, 1, 256, workers))
+				workers = std::max(1, (int)std::thread::hardware_concurrency());
+			break;
 		default:
 			Device::SetKey(key, arg);
 			break;
@@ -254,6 +405,9 @@ namespace Device
 
 	std::string RAWFile::Get()
 	{
-		return Device::Get() + " file " + filename + " loop " + Util::Convert::toString(loop) + " lossless " + Util::Convert::toString(lossless);
+		std::string s = Device::Get() + " file " + filename + " loop " + Util::Convert::toString(loop) + " lossless " + Util::Convert::toString(lossless);
+		if (workers > 1)
+			s += " workers " + std::to_string(workers);
+		return s;
 	}
 }
\ No newline at end of file
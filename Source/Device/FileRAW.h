@@ -45,8 +45,21 @@ namespace Device
 		uint32_t BUFFER_COUNT = 2;
 		int TXT_BLOCK_SIZE = 1;
 
+		// offline mode for text files: the file is memory mapped and handed on
+		// in line-aligned blocks of this size per decoder, bypassing the FIFO
+		static const size_t MAPPED_SLICE = 4 * 1024 * 1024;
+		int workers = 1;
+		const char *map = nullptr;
+		size_t map_size = 0;
+
+		bool isMappable();
+		void mapFile();
+		void unmapFile();
+
+		long readChunk();
 		void ReadAsync();
 		void Run();
+		void RunMapped();
 
 	public:
 		RAWFile() : Device(Format::CU8, 1536000, Type::RAWFILE, "RAW File") {}
@@ -58,6 +71,7 @@ namespace Device
 		bool isCallback() { return true; }
 		bool isStreaming() { return Device::isStreaming() && !done; }
 		bool isReplay();
+		int getConcurrency() { return isMappable() ? workers : 1; }
 
 		// Settings
 		Setting &SetKey(AIS::Keys key, const std::string &arg);
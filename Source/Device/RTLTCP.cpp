@@ -77,7 +77,12 @@ namespace Device
 
 		Device::Play();
 
-		if (getFormat() != Format::TXT && getFormat() != Format::BASESTATION && getFormat() != Format::BEAST && getFormat() != Format::RAW1090)
+		if (getFormat() == Format::BASEBAND)
+		{
+			// a few hundred KB/s from an edge: pass it on per transfer, not per half megabyte
+			fifo.Init(TRANSFER_SIZE, BUFFER_SIZE / TRANSFER_SIZE);
+		}
+		else if (getFormat() != Format::TXT && getFormat() != Format::BASESTATION && getFormat() != Format::BEAST && getFormat() != Format::RAW1090)
 		{
 			fifo.Init(BUFFER_SIZE);
 		}
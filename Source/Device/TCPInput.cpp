@@ -0,0 +1,517 @@
+/*
+	Copyright(c) 2021-2026 jvde.github@gmail.com
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <cstring>
+#include <ctime>
+#include <sstream>
+#ifdef __linux__
+#include <sys/epoll.h>
+#endif
+#ifndef _WIN32
+#include <netinet/in.h>
+#endif
+
+#include "TCPInput.h"
+#include "Logger.h"
+
+namespace Device
+{
+	void TCPInput::StopServer()
+	{
+		for (auto &w : workers)
+		{
+			for (auto &c : w->connections)
+				Net::closeSocket(c.second->sock);
+			w->connections.clear();
+
+			if (w->listener != -1)
+			{
+				Net::closeSocket(w->listener);
+				w->listener = -1;
+			}
+#ifdef __linux__
+			if (w->epfd != -1)
+			{
+				close(w->epfd);
+				w->epfd = -1;
+			}
+#endif
+		}
+		workers.clear();
+
+		if (address != nullptr)
+		{
+			freeaddrinfo(address);
+			address = nullptr;
+		}
+	}
+
+	void TCPInput::StartServer()
+	{
+		struct addrinfo hints;
+		memset(&hints, 0, sizeof(hints));
+
+		hints.ai_family = AF_UNSPEC;
+		hints.ai_socktype = SOCK_STREAM;
+		hints.ai_flags = AI_PASSIVE;
+
+		int r = getaddrinfo(server.empty() ? nullptr : server.c_str(), port.c_str(), &hints, &address);
+		if (r != 0 || address == NULL)
+			throw std::runtime_error("TCP server: cannot resolve address.");
+
+#ifndef SO_REUSEPORT
+		if (n_workers > 1)
+		{
+			StopServer();
+			throw std::runtime_error("TCP server: multiple workers need SO_REUSEPORT, which this platform does not have.");
+		}
+#endif
+
+		for (int i = 0; i < n_workers; i++)
+		{
+			workers.push_back(std::unique_ptr<Worker>(new Worker()));
+			Worker &w = *workers.back();
+
+			w.listener = socket(address->ai_family, SOCK_STREAM, 0);
+			if (w.listener == -1)
+			{
+				StopServer();
+				throw std::runtime_error("TCP server: cannot create socket.");
+			}
+
+#ifndef _WIN32
+			int optval = 1;
+			if (setsockopt(w.listener, SOL_SOCKET, SO_REUSEADDR, &optval, sizeof(optval)) != 0)
+			{
+				StopServer();
+				throw std::runtime_error("TCP server: cannot set socket option.");
+			}
+#endif
+#ifdef SO_REUSEPORT
+			// every worker listens on the port, the kernel deals out new connections
+			if (n_workers > 1 && setsockopt(w.listener, SOL_SOCKET, SO_REUSEPORT, &optval, sizeof(optval)) != 0)
+			{
+				StopServer();
+				throw std::runtime_error("TCP server: cannot set SO_REUSEPORT for multiple workers.");
+			}
+#endif
+
+			if (!Net::setNonBlocking(w.listener))
+			{
+				StopServer();
+				throw std::runtime_error("TCP server: cannot make the socket non-blocking.");
+			}
+
+			if (bind(w.listener, address->ai_addr, address->ai_addrlen) != 0 || listen(w.listener, SOMAXCONN) != 0)
+			{
+				Debug() << "TCP server: binding to " << server << " port " << port << ": " << Net::errorString(Net::lastError());
+				StopServer();
+				throw std::runtime_error("TCP server: cannot bind to port.");
+			}
+
+#ifdef __linux__
+			w.epfd = epoll_create1(EPOLL_CLOEXEC);
+			struct epoll_event ev;
+			memset(&ev, 0, sizeof(ev));
+			ev.events = EPOLLIN;
+			ev.data.fd = w.listener;
+
+			if (w.epfd == -1 || epoll_ctl(w.epfd, EPOLL_CTL_ADD, w.listener, &ev) != 0)
+			{
+				StopServer();
+				throw std::runtime_error("TCP server: cannot set up epoll.");
+			}
+#endif
+			w.buffer.resize(READ_SIZE);
+			w.tag = tag;
+		}
+
+		Debug() << "TCP server: listening on " << server << " port " << port << " with " << n_workers << " worker(s)";
+	}
+
+	void TCPInput::Close()
+	{
+		Device::Close();
+		Stop();
+		StopServer();
+	}
+
+	void TCPInput::Play()
+	{
+		Device::Play();
+
+		StartServer();
+		for (auto &w : workers)
+			w->thread = std::thread(&TCPInput::Run, this, w.get());
+
+		SleepSystem(10);
+	}
+
+	void TCPInput::Stop()
+	{
+		if (Device::isStreaming())
+		{
+			Device::Stop();
+
+			for (auto &w : workers)
+				if (w->thread.joinable())
+					w->thread.join();
+		}
+		StopServer();
+	}
+
+	void TCPInput::acceptConnections(Worker &w)
+	{
+		while (true)
+		{
+			struct sockaddr_storage a;
+			socklen_t len = sizeof(a);
+
+			SOCKET s = accept(w.listener, (struct sockaddr *)&a, &len);
+			if (s == -1)
+				return;
+
+			if (w.connections.size() >= MAX_CONNECTIONS)
+			{
+				Error() << "TCP server: max connections reached (" << MAX_CONNECTIONS << " per worker), closing socket.";
+				Net::closeSocket(s);
+				continue;
+			}
+
+			const int idle = 60, interval = 20, count = 3;
+			Net::setTCPKeepAlive(s, idle, interval, count);
+
+			if (!Net::setNonBlocking(s))
+			{
+				Net::closeSocket(s);
+				continue;
+			}
+
+			std::unique_ptr<Connection> c(new Connection());
+			c->sock = s;
+			c->connected = c->last = std::time(nullptr);
+
+			char host[NI_MAXHOST], serv[NI_MAXSERV];
+			if (getnameinfo((struct sockaddr *)&a, len, host, sizeof(host), serv, sizeof(serv), NI_NUMERICHOST | NI_NUMERICSERV) == 0)
+			{
+				std::string h = host;
+				if (h.compare(0, 7, "::ffff:") == 0)
+					h = h.substr(7);
+
+				c->peer = h + ":" + serv;
+
+				auto it = station_map.find(h);
+				if (it != station_map.end())
+					c->station = it->second;
+			}
+			else
+				c->peer = "?";
+
+			c->id = next_id++;
+			if (!c->id)
+				c->id = next_id++;
+
+#ifdef __linux__
+			struct epoll_event ev;
+			memset(&ev, 0, sizeof(ev));
+			ev.events = EPOLLIN | EPOLLRDHUP;
+			ev.data.fd = s;
+
+			if (epoll_ctl(w.epfd, EPOLL_CTL_ADD, s, &ev) != 0)
+			{
+				Net::closeSocket(s);
+				continue;
+			}
+#endif
+			Info() << "TCP server: connection from " << c->peer << (c->station >= 0 ? " as station " + std::to_string(c->station) : std::string());
+
+			std::lock_guard<std::mutex> lock(mtx);
+			w.connections[s] = std::move(c);
+		}
+	}
+
+	void TCPInput::closeConnection(Worker &w, SOCKET s, const std::string &reason)
+	{
+		std::lock_guard<std::mutex> lock(mtx);
+
+		auto it = w.connections.find(s);
+		if (it == w.connections.end())
+			return;
+
+		Info() << "TCP server: " << it->second->peer << " " << reason;
+
+#ifdef __linux__
+		epoll_ctl(w.epfd, EPOLL_CTL_DEL, s, nullptr);
+#endif
+		Net::closeSocket(s);
+		w.connections.erase(it);
+	}
+
+	// one complete line into the worker's out buffer, tagged with the station
+	// unless the sender already put a tag block in front
+	void TCPInput::addLine(Worker &w, Connection &c, const char *data, size_t len)
+	{
+		if (len == 0)
+			return;
+
+		if (c.station >= 0 && (data[0] == '!' || data[0] == '$'))
+		{
+			std::string t = "s:s" + std::to_string(c.station);
+
+			int cs = 0;
+			for (char ch : t)
+				cs ^= ch;
+
+			static const char hex[] = "0123456789ABCDEF";
+			w.out += '\\';
+			w.out += t;
+			w.out += '*';
+			w.out += hex[(cs >> 4) & 0xF];
+			w.out += hex[cs & 0xF];
+			w.out += '\\';
+		}
+
+		w.out.append(data, len);
+		w.out += '\n';
+		c.lines++;
+	}
+
+	void TCPInput::readConnection(Worker &w, Connection &c)
+	{
+		int n = recv(c.sock, w.buffer.data(), READ_SIZE, 0);
+
+		if (n == 0)
+		{
+			closeConnection(w, c.sock, "disconnected");
+			return;
+		}
+
+		if (n < 0)
+		{
+			int e = Net::lastError();
+			if (!Net::wouldBlock(e))
+				closeConnection(w, c.sock, "dropped: " + Net::errorString(e));
+			return;
+		}
+
+		const char *p = w.buffer.data();
+		const char *end = p + n;
+
+		w.out.clear();
+
+		while (p < end)
+		{
+			const char *nl = (const char *)memchr(p, '\n', end - p);
+
+			if (!nl)
+			{
+				if (!c.skip)
+				{
+					if (c.line.size() + (end - p) > MAX_LINE)
+					{
+						c.line.clear();
+						c.skip = true;
+						c.dropped++;
+					}
+					else
+						c.line.append(p, end - p);
+				}
+				break;
+			}
+
+			if (c.skip)
+				c.skip = false;
+			else if (c.line.empty())
+				addLine(w, c, p, nl - p);
+			else if (c.line.size() + (nl - p) > MAX_LINE)
+			{
+				c.line.clear();
+				c.dropped++;
+			}
+			else
+			{
+				c.line.append(p, nl - p);
+				addLine(w, c, c.line.data(), c.line.size());
+				c.line.clear();
+			}
+
+			p = nl + 1;
+		}
+
+		std::lock_guard<std::mutex> lock(mtx);
+
+		c.bytes += n;
+		c.last = std::time(nullptr);
+
+		if (!w.out.empty())
+		{
+			RAW r = {getFormat(), (void *)w.out.data(), (int)w.out.size()};
+			w.tag.source = c.id;
+			Send(&r, 1, w.tag);
+		}
+	}
+
+	void TCPInput::Run(Worker *w)
+	{
+		Debug() << "TCP server: starting thread.";
+		std::time_t last_sweep = 0;
+
+		while (isStreaming())
+		{
+#ifdef __linux__
+			struct epoll_event events[64];
+			int n = epoll_wait(w->epfd, events, 64, 1000);
+
+			for (int i = 0; i < n && isStreaming(); i++)
+			{
+				int fd = events[i].data.fd;
+
+				if (fd == w->listener)
+				{
+					acceptConnections(*w);
+					continue;
+				}
+
+				auto it = w->connections.find(fd);
+				if (it != w->connections.end())
+					readConnection(*w, *it->second);
+			}
+#else
+			std::vector<pollfd> pfds;
+			pfds.push_back({w->listener, POLLIN, 0});
+			for (auto &c : w->connections)
+				pfds.push_back({c.first, POLLIN, 0});
+
+#ifdef _WIN32
+			int n = WSAPoll(pfds.data(), (ULONG)pfds.size(), 1000);
+#else
+			int n = ::poll(pfds.data(), pfds.size(), 1000);
+#endif
+			for (size_t i = 0; n > 0 && i < pfds.size() && isStreaming(); i++)
+			{
+				if (!pfds[i].revents)
+					continue;
+
+				if (i == 0)
+				{
+					acceptConnections(*w);
+					continue;
+				}
+
+				auto it = w->connections.find(pfds[i].fd);
+				if (it != w->connections.end())
+					readConnection(*w, *it->second);
+			}
+#endif
+
+			std::time_t now = std::time(nullptr);
+			if (timeout && now != last_sweep)
+			{
+				last_sweep = now;
+
+				std::vector<SOCKET> idle;
+				for (auto &c : w->connections)
+					if (now - c.second->last > timeout)
+						idle.push_back(c.first);
+
+				for (SOCKET s : idle)
+					closeConnection(*w, s, "timed out");
+			}
+		}
+		Debug() << "TCP server: ending thread.";
+	}
+
+	void TCPInput::setStationMap(const std::string &arg)
+	{
+		station_map.clear();
+
+		std::stringstream ss(arg);
+		std::string item;
+
+		while (std::getline(ss, item, ','))
+		{
+			std::size_t eq = item.find('=');
+			if (eq == std::string::npos || eq == 0)
+				throw std::runtime_error("TCP server: station map expects address=station pairs, got \"" + item + "\".");
+
+			station_map[item.substr(0, eq)] = Util::Parse::Integer(item.substr(eq + 1), 0, 0x7FFFFFFF);
+		}
+	}
+
+	std::vector<std::string> TCPInput::getStatistics()
+	{
+		std::vector<std::string> lines;
+		std::time_t now = std::time(nullptr);
+
+		std::lock_guard<std::mutex> lock(mtx);
+		for (auto &w : workers)
+		{
+			for (auto &it : w->connections)
+			{
+				const Connection &c = *it.second;
+				lines.push_back("TCP " + c.peer + (c.station >= 0 ? " station " + std::to_string(c.station) : std::string()) +
+								" lines: " + std::to_string(c.lines) + ", bytes: " + std::to_string(c.bytes) +
+								", dropped: " + std::to_string(c.dropped) + ", last: " + std::to_string((long)(now - c.last)) + " s ago");
+			}
+		}
+		return lines;
+	}
+
+	void TCPInput::getDeviceList(std::vector<Description> &DeviceList)
+	{
+		DeviceList.push_back(Description("TCP", "TCP server", "TCPSERVER", (uint64_t)0, Type::TCPSERVER));
+	}
+
+	Setting &TCPInput::SetKey(AIS::Keys key, const std::string &arg)
+	{
+		switch (key)
+		{
+		case AIS::KEY_SETTING_PORT:
+			port = arg;
+			break;
+		case AIS::KEY_SETTING_SERVER:
+			server = arg;
+			break;
+		case AIS::KEY_SETTING_WORKERS:
+			n_workers = Util::Parse::Integer(arg, 1, 64);
+			break;
+		case AIS::KEY_SETTING_TIMEOUT:
+			timeout = Util::Parse::Integer(arg, 0, 86400);
+			break;
+		case AIS::KEY_SETTING_STATION_MAP:
+			setStationMap(arg);
+			break;
+		case AIS::KEY_SETTING_FORMAT:
+			throw std::runtime_error("TCP server: format cannot be changed and need to be TXT.");
+			break;
+		default:
+			Device::SetKey(key, arg);
+			break;
+		}
+		return *this;
+	}
+
+	std::string TCPInput::Get()
+	{
+		std::string s = Device::Get() + " server " + server + " port " + port + " workers " + std::to_string(n_workers);
+		if (timeout)
+			s += " timeout " + std::to_string(timeout);
+		if (!station_map.empty())
+			s += " station_map " + std::to_string(station_map.size()) + " addresses";
+		return s;
+	}
+}
@@ -0,0 +1,124 @@
+/*
+	Copyright(c) 2021-2026 jvde.github@gmail.com
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "SocketUtil.h"
+#include "Device.h"
+
+namespace Device
+{
+
+	// TCP server accepting NMEA feeds from many stations. Connections are
+	// spread over worker threads (SO_REUSEPORT listeners, epoll on Linux)
+	// and each stream is cut into whole lines, so the decoder downstream
+	// never sees two feeds interleaved within a sentence.
+	class TCPInput : public Device
+	{
+		// a line longer than this is dropped, bounding what a connection holds
+		static const int MAX_LINE = 4096;
+		static const int READ_SIZE = 65536;
+		static const int MAX_CONNECTIONS = 1024; // per worker
+
+		std::string port;
+		std::string server;
+
+		int n_workers = 1;
+		int timeout = 0; // idle seconds before a feed is dropped, 0 keeps it
+
+		// numeric peer address to station id, sent on as an NMEA tag block
+		std::map<std::string, int> station_map;
+
+		struct addrinfo *address = nullptr;
+		std::atomic<uint32_t> next_id{1};
+
+		struct Connection
+		{
+			SOCKET sock = -1;
+			std::string peer;
+			uint32_t id = 0; // keys multipart reassembly downstream, unique per connection
+			int station = -1;
+
+			std::string line; // unterminated tail of the stream
+			bool skip = false; // discarding an overlong line up to its end
+
+			std::time_t connected = 0;
+			std::time_t last = 0;
+			uint64_t bytes = 0;
+			uint64_t lines = 0;
+			uint64_t dropped = 0;
+		};
+
+		struct Worker
+		{
+			SOCKET listener = -1;
+#ifdef __linux__
+			int epfd = -1;
+#endif
+			std::thread thread;
+			std::unordered_map<SOCKET, std::unique_ptr<Connection>> connections;
+
+			std::vector<char> buffer;
+			std::string out;
+			TAG tag;
+		};
+		std::vector<std::unique_ptr<Worker>> workers;
+
+		// downstream decoding is single threaded; also guards the connection tables
+		std::mutex mtx;
+
+		void StartServer();
+		void StopServer();
+		void Run(Worker *w);
+
+		void acceptConnections(Worker &w);
+		void readConnection(Worker &w, Connection &c);
+		void closeConnection(Worker &w, SOCKET s, const std::string &reason);
+		void addLine(Worker &w, Connection &c, const char *data, size_t len);
+		void setStationMap(const std::string &arg);
+
+	public:
+		TCPInput() : Device(Format::TXT, 0, Type::TCPSERVER, "TCP server") {};
+		~TCPInput() { StopServer(); }
+
+		// Control
+		void Close();
+		void Play();
+		void Stop();
+
+		bool isCallback() { return true; }
+		void getDeviceList(std::vector<Description> &DeviceList);
+		std::string getRateDescription() { return "N/A"; }
+		std::vector<std::string> getStatistics();
+
+		// Settings
+		Setting &SetKey(AIS::Keys key, const std::string &arg);
+		std::string Get();
+
+		std::string getProduct() { return "TCP server"; }
+		std::string getSerial() { return ""; }
+		std::string getIdentity() { return "TCPSERVER:" + server + ":" + port; }
+		std::string getVendor() { return "Network"; }
+	};
+}
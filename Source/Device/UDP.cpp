@@ -15,9 +15,13 @@
 	along with this program.  If not, see <https://www.gnu.org/licenses/>.
 */
 
+#include <algorithm>
 #include <cstring>
+#include <ctime>
 #ifndef _WIN32
 #include <sys/select.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
 #endif
 
 #include "UDP.h"
@@ -25,13 +29,20 @@
 
 namespace Device
 {
+	// cap on tracked senders, the least recently heard one makes room
+	static const size_t MAX_SOURCES = 4096;
+
 	void UDP::StopServer()
 	{
-		if (sock != -1)
+		for (auto &w : workers)
 		{
-			Net::closeSocket(sock);
-			sock = -1;
+			if (w->sock != -1)
+			{
+				Net::closeSocket(w->sock);
+				w->sock = -1;
+			}
 		}
+		workers.clear();
 
 		if (address != nullptr)
 		{
@@ -56,36 +67,75 @@ namespace Device
 			throw std::runtime_error("UDP: cannot resolve address.");
 		}
 
-		sock = socket(address->ai_family, SOCK_DGRAM, 0);
-		if (sock == -1)
+#ifndef SO_REUSEPORT
+		if (n_workers > 1)
 		{
 			StopServer();
-			throw std::runtime_error("UDP: cannot create socket.");
+			throw std::runtime_error("UDP: multiple workers need SO_REUSEPORT, which this platform does not have.");
 		}
+#endif
 
-#ifndef _WIN32
-		int optval = 1;
-		if (setsockopt(sock, SOL_SOCKET, SO_REUSEADDR, &optval, sizeof(optval)) != 0)
+		for (int i = 0; i < n_workers; i++)
 		{
-			StopServer();
-			throw std::runtime_error("UDP: cannot set socket option.");
-		}
+			workers.push_back(std::unique_ptr<Worker>(new Worker()));
+			Worker &w = *workers.back();
+
+			w.sock = socket(address->ai_family, SOCK_DGRAM, 0);
+			if (w.sock == -1)
+			{
+				StopServer();
+				throw std::runtime_error("UDP: cannot create socket.");
+			}
+
+#ifndef _WIN32
+			int optval = 1;
+			if (setsockopt(w.sock, SOL_SOCKET, SO_REUSEADDR, &optval, sizeof(optval)) != 0)
+			{
+				StopServer();
+				throw std::runtime_error("UDP: cannot set socket option.");
+			}
+#endif
+#ifdef SO_REUSEPORT
+			if (n_workers > 1 && setsockopt(w.sock, SOL_SOCKET, SO_REUSEPORT, &optval, sizeof(optval)) != 0)
+			{
+				StopServer();
+				throw std::runtime_error("UDP: cannot set SO_REUSEPORT for multiple workers.");
+			}
 #endif
 
-		if (!Net::setNonBlocking(sock))
-		{
-			StopServer();
-			throw std::runtime_error("UDP: cannot make the socket non-blocking.");
-		}
+			if (!Net::setNonBlocking(w.sock))
+			{
+				StopServer();
+				throw std::runtime_error("UDP: cannot make the socket non-blocking.");
+			}
 
-		if (bind(sock, address->ai_addr, address->ai_addrlen) != 0)
-		{
-			Debug() << "UDP: binding to " << server << " port " << port << ": " << strerror(errno);
-			StopServer();
-			throw std::runtime_error("UDP: cannot bind to port.");
+			if (bind(w.sock, address->ai_addr, address->ai_addrlen) != 0)
+			{
+				Debug() << "UDP: binding to " << server << " port " << port << ": " << strerror(errno);
+				StopServer();
+				throw std::runtime_error("UDP: cannot bind to port.");
+			}
+
+			w.buffer.resize((size_t)batch * DATAGRAM_SIZE);
+			w.from.resize(batch);
+			w.size.resize(batch);
+#ifdef __linux__
+			w.iov.resize(batch);
+			w.msgs.resize(batch);
+			for (int j = 0; j < batch; j++)
+			{
+				w.iov[j].iov_base = w.buffer.data() + (size_t)j * DATAGRAM_SIZE;
+				w.iov[j].iov_len = DATAGRAM_SIZE;
+
+				memset(&w.msgs[j], 0, sizeof(w.msgs[j]));
+				w.msgs[j].msg_hdr.msg_iov = &w.iov[j];
+				w.msgs[j].msg_hdr.msg_iovlen = 1;
+				w.msgs[j].msg_hdr.msg_name = &w.from[j];
+			}
+#endif
 		}
 		SleepSystem(100);
-		Debug() << "UDP: listening on " << server << " port " << port;
+		Debug() << "UDP: listening on " << server << " port " << port << " with " << n_workers << " worker(s)";
 	}
 	void UDP::Close()
 	{
@@ -101,7 +151,8 @@ namespace Device
 		applySettings();
 
 		StartServer();
-		run_thread = std::thread(&UDP::Run, this);
+		for (auto &w : workers)
+			w->thread = std::thread(&UDP::Run, this, w.get());
 
 		SleepSystem(10);
 	}
@@ -112,48 +163,160 @@ namespace Device
 		{
 			Device::Stop();
 
-			if (run_thread.joinable())
-				run_thread.join();
+			for (auto &w : workers)
+				if (w->thread.joinable())
+					w->thread.join();
 		}
 		StopServer();
 	}
 
-	void UDP::Run()
+	// fills the worker buffers, returns the datagram count, 0 when the socket is drained, -1 on error
+	int UDP::receiveBatch(Worker *w)
+	{
+#ifdef __linux__
+		for (int i = 0; i < batch; i++)
+			w->msgs[i].msg_hdr.msg_namelen = sizeof(struct sockaddr_storage);
+
+		int n = recvmmsg(w->sock, w->msgs.data(), batch, MSG_DONTWAIT, nullptr);
+		if (n < 0)
+			return Net::wouldBlock(Net::lastError()) ? 0 : -1;
+
+		for (int i = 0; i < n; i++)
+			w->size[i] = (int)w->msgs[i].msg_len;
+
+		return n;
+#else
+		int n = 0;
+		while (n < batch)
+		{
+			socklen_t len = sizeof(struct sockaddr_storage);
+			int nread = recvfrom(w->sock, w->buffer.data() + (size_t)n * DATAGRAM_SIZE, DATAGRAM_SIZE, 0, (struct sockaddr *)&w->from[n], &len);
+
+			if (nread < 0)
+			{
+				if (n == 0 && !Net::wouldBlock(Net::lastError()))
+					return -1;
+				break;
+			}
+			w->size[n++] = nread;
+		}
+		return n;
+#endif
+	}
+
+	void UDP::Run(Worker *w)
 	{
 		Debug() << "UDP: starting thread.";
-		char buffer[16384];
-		RAW r = {getFormat(), buffer, 0};
-		int nread;
+
+		// the sender address travels in the tag, NMEA keeps reassembly state per sender
+		TAG t = tag;
+		RAW r = {getFormat(), nullptr, 0};
+		int n;
+
 		while (isStreaming())
 		{
-			do
+			while ((n = receiveBatch(w)) > 0 && isStreaming())
 			{
-				nread = recv(sock, buffer, sizeof(buffer), 0);
+				std::time_t now = std::time(nullptr);
+				std::lock_guard<std::mutex> lock(send_mtx);
 
-				if (nread > 0)
+				for (int i = 0; i < n; i++)
 				{
-					r.size = nread;
-					Send(&r, 1, tag);
-				}
-				else if (nread < 0 && !Net::wouldBlock(Net::lastError()))
-				{
-					Error() << "UDP: receive error: " << Net::errorString(Net::lastError());
-					lost = true;
+					SourceKey key = sourceKey(w->from[i], t.source);
+
+					auto it = sources.find(key);
+					if (it == sources.end())
+					{
+						if (sources.size() >= MAX_SOURCES)
+							sources.erase(std::min_element(sources.begin(), sources.end(),
+														   [](const std::pair<const SourceKey, Source> &a, const std::pair<const SourceKey, Source> &b)
+														   { return a.second.last < b.second.last; }));
+						it = sources.insert({key, Source()}).first;
+					}
+
+					Source &s = it->second;
+					s.datagrams++;
+					s.bytes += w->size[i];
+					s.last = now;
+
+					if (w->size[i] > 0)
+					{
+						r.data = w->buffer.data() + (size_t)i * DATAGRAM_SIZE;
+						r.size = w->size[i];
+						Send(&r, 1, t);
+					}
 				}
-			} while (nread > 0 && isStreaming());
+			}
+
+			if (n < 0)
+			{
+				Error() << "UDP: receive error: " << Net::errorString(Net::lastError());
+				lost = true;
+			}
 
 			struct timeval tv;
 			fd_set fds;
 
 			FD_ZERO(&fds);
-			FD_SET(sock, &fds);
+			FD_SET(w->sock, &fds);
 
 			tv = {1, 0};
-			select(sock + 1, &fds, nullptr, nullptr, &tv);
+			select(w->sock + 1, &fds, nullptr, nullptr, &tv);
 		}
 		Debug() << "UDP: ending thread.";
 	}
 
+	UDP::SourceKey UDP::sourceKey(const struct sockaddr_storage &a, uint32_t &ipv4)
+	{
+		static const uint8_t v4mapped[12] = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0xFF, 0xFF};
+
+		SourceKey k;
+		k.fill(0);
+		ipv4 = 0;
+
+		if (a.ss_family == AF_INET)
+		{
+			memcpy(k.data(), v4mapped, 12);
+			memcpy(k.data() + 12, &((const struct sockaddr_in *)&a)->sin_addr, 4);
+		}
+		else if (a.ss_family == AF_INET6)
+			memcpy(k.data(), &((const struct sockaddr_in6 *)&a)->sin6_addr, 16);
+		else
+			return k;
+
+		if (memcmp(k.data(), v4mapped, 12) == 0)
+			ipv4 = ((uint32_t)k[12] << 24) | ((uint32_t)k[13] << 16) | ((uint32_t)k[14] << 8) | k[15];
+
+		return k;
+	}
+
+	std::string UDP::sourceString(const SourceKey &k)
+	{
+		static const uint8_t v4mapped[12] = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0xFF, 0xFF};
+
+		if (memcmp(k.data(), v4mapped, 12) == 0)
+			return Util::Convert::IPV4toString(((uint32_t)k[12] << 24) | ((uint32_t)k[13] << 16) | ((uint32_t)k[14] << 8) | k[15]);
+
+		char s[INET6_ADDRSTRLEN];
+		if (inet_ntop(AF_INET6, (void *)k.data(), s, sizeof(s)) == nullptr)
+			return "?";
+		return s;
+	}
+
+	std::vector<std::string> UDP::getStatistics()
+	{
+		std::vector<std::string> lines;
+		std::time_t now = std::time(nullptr);
+
+		std::lock_guard<std::mutex> lock(send_mtx);
+		for (const auto &s : sources)
+		{
+			lines.push_back("UDP " + sourceString(s.first) + " datagrams: " + std::to_string(s.second.datagrams) +
+							", bytes: " + std::to_string(s.second.bytes) + ", last: " + std::to_string((long)(now - s.second.last)) + " s ago");
+		}
+		return lines;
+	}
+
 	void UDP::applySettings()
 	{
 	}
@@ -173,6 +336,12 @@ namespace Device
 		case AIS::KEY_SETTING_SERVER:
 			server = arg;
 			break;
+		case AIS::KEY_SETTING_WORKERS:
+			n_workers = Util::Parse::Integer(arg, 1, 64);
+			break;
+		case AIS::KEY_SETTING_BATCH:
+			batch = Util::Parse::Integer(arg, 1, 1024);
+			break;
 		case AIS::KEY_SETTING_FORMAT:
 			throw std::runtime_error("UDP: format cannot be changed and need to be TXT.");
 			break;
@@ -185,6 +354,6 @@ namespace Device
 
 	std::string UDP::Get()
 	{
-		return Device::Get() + " server " + server + " port " + port;
+		return Device::Get() + " server " + server + " port " + port + " workers " + std::to_string(n_workers) + " batch " + std::to_string(batch);
 	}
 }
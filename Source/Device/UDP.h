@@ -17,8 +17,13 @@
 
 #pragma once
 
+#include <array>
 #include <fstream>
 #include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
 
 #include "SocketUtil.h"
 #include "Device.h"
@@ -28,19 +33,56 @@ namespace Device
 
 	class UDP : public Device
 	{
+		static const int DATAGRAM_SIZE = 16384;
+
 		std::string port;
 		std::string server;
 
+		// sockets bound to the same port with SO_REUSEPORT, the kernel spreads
+		// senders over them by address so each sender stays on one worker
+		int n_workers = 1;
+		// datagrams taken per receive call (recvmmsg on Linux)
+		int batch = 32;
+
 		struct addrinfo *address = nullptr;
-		SOCKET sock = -1;
 
-		std::thread run_thread;
+		struct Worker
+		{
+			SOCKET sock = -1;
+			std::thread thread;
+
+			std::vector<char> buffer;
+			std::vector<struct sockaddr_storage> from;
+			std::vector<int> size;
+#ifdef __linux__
+			std::vector<struct iovec> iov;
+			std::vector<struct mmsghdr> msgs;
+#endif
+		};
+		std::vector<std::unique_ptr<Worker>> workers;
+
+		// downstream decoding is single threaded: one lock per batch
+		std::mutex send_mtx;
+
+		// sender address as IPv6 (IPv4 mapped), counters updated under send_mtx
+		typedef std::array<uint8_t, 16> SourceKey;
+		struct Source
+		{
+			uint64_t datagrams = 0;
+			uint64_t bytes = 0;
+			std::time_t last = 0;
+		};
+		std::map<SourceKey, Source> sources;
 
 		void StartServer();
 		void StopServer();
-		void Run();
+		void Run(Worker *w);
+		int receiveBatch(Worker *w);
 		void applySettings();
 
+		static SourceKey sourceKey(const struct sockaddr_storage &a, uint32_t &ipv4);
+		static std::string sourceString(const SourceKey &k);
+
 	public:
 		UDP() : Device(Format::TXT, 0, Type::UDP, "UDP") {};
 		~UDP() { StopServer(); }
@@ -53,6 +95,7 @@ namespace Device
 		bool isCallback() { return true; }
 		void getDeviceList(std::vector<Description> &DeviceList);
 		std::string getRateDescription() { return "N/A"; }
+		std::vector<std::string> getStatistics();
 
 		// Settings
 		Setting &SetKey(AIS::Keys key, const std::string &arg);
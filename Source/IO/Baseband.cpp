@@ -0,0 +1,255 @@
+/*
+	Copyright(c) 2021-2026 jvde.github@gmail.com
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+
+#include "Baseband.h"
+#include "Logger.h"
+
+namespace IO
+{
+	static const uint8_t MAGIC[4] = {'A', 'I', 'S', 'B'};
+
+	static void put16(uint8_t *p, uint16_t v)
+	{
+		p[0] = v & 0xFF;
+		p[1] = v >> 8;
+	}
+
+	static void put32(uint8_t *p, uint32_t v)
+	{
+		for (int i = 0; i < 4; i++)
+			p[i] = (v >> (8 * i)) & 0xFF;
+	}
+
+	static void put64(uint8_t *p, uint64_t v)
+	{
+		for (int i = 0; i < 8; i++)
+			p[i] = (v >> (8 * i)) & 0xFF;
+	}
+
+	static uint16_t get16(const uint8_t *p)
+	{
+		return (uint16_t)(p[0] | (p[1] << 8));
+	}
+
+	static uint32_t get32(const uint8_t *p)
+	{
+		uint32_t v = 0;
+		for (int i = 3; i >= 0; i--)
+			v = (v << 8) | p[i];
+		return v;
+	}
+
+	static uint64_t get64(const uint8_t *p)
+	{
+		uint64_t v = 0;
+		for (int i = 7; i >= 0; i--)
+			v = (v << 8) | p[i];
+		return v;
+	}
+
+	void BasebandEncoder::flush(TAG &tag)
+	{
+		// even lengths only, as the front-end delivers them
+		int n = (int)std::min(a.pending.size(), b.pending.size()) & ~1;
+		int done = 0;
+
+		while (done < n)
+		{
+			const int k = std::min(n - done, Baseband::MAX_SAMPLES);
+			const CFLOAT32 *A = a.pending.data() + done, *B = b.pending.data() + done;
+
+			FLOAT32 peak = 0.0f;
+			for (int i = 0; i < k; i++)
+			{
+				peak = std::max(peak, std::max(std::abs(A[i].real()), std::abs(A[i].imag())));
+				peak = std::max(peak, std::max(std::abs(B[i].real()), std::abs(B[i].imag())));
+			}
+
+			const FLOAT32 full = width == 1 ? 127.0f : 32767.0f;
+			const FLOAT32 scale = peak > 0.0f ? peak / full : 1.0f;
+			const FLOAT32 inv = 1.0f / scale;
+
+			frame.resize(Baseband::HEADER_SIZE + k * 4 * width);
+			uint8_t *p = frame.data();
+
+			uint32_t s;
+			std::memcpy(&s, &scale, sizeof(s));
+
+			std::memcpy(p, MAGIC, 4);
+			put32(p + 4, seq++);
+			put64(p + 8, sample_idx);
+			put16(p + 16, (uint16_t)k);
+			put16(p + 18, (uint16_t)width);
+			put32(p + 20, s);
+			p += Baseband::HEADER_SIZE;
+
+			for (int i = 0; i < k; i++)
+			{
+				const FLOAT32 v[4] = {A[i].real(), A[i].imag(), B[i].real(), B[i].imag()};
+
+				for (int j = 0; j < 4; j++)
+				{
+					const long q = std::lrint(v[j] * inv);
+
+					if (width == 1)
+						*p++ = (uint8_t)(int8_t)std::max(-127L, std::min(127L, q));
+					else
+					{
+						put16(p, (uint16_t)(int16_t)std::max(-32767L, std::min(32767L, q)));
+						p += 2;
+					}
+				}
+			}
+
+			RAW r = {Format::BASEBAND, frame.data(), (int)frame.size()};
+			Send(&r, 1, tag);
+
+			sample_idx += k;
+			done += k;
+		}
+
+		a.pending.erase(a.pending.begin(), a.pending.begin() + done);
+		b.pending.erase(b.pending.begin(), b.pending.begin() + done);
+	}
+
+	void BasebandServer::Start()
+	{
+		// a core only reads, so an idle connection is not a dead one
+		timeout = 0;
+
+		if (!TCPServer::start(port))
+			throw std::runtime_error("Baseband: cannot start server at port " + std::to_string(port) + ".");
+
+		Info() << "Baseband: serving 48K channels at port " << port;
+	}
+
+	void BasebandServer::Receive(const RAW *data, int len, TAG &tag)
+	{
+		for (int i = 0; i < len; i++)
+			SendAll((const char *)data[i].data, data[i].size);
+	}
+
+	// returns the bytes taken from p, 0 if the frame is not complete, -1 if p is not on a frame
+	int BasebandDecoder::decode(const uint8_t *p, int avail, TAG &tag)
+	{
+		if (std::memcmp(p, MAGIC, 4))
+			return -1;
+
+		const int n = get16(p + 16), width = get16(p + 18);
+
+		if (n > Baseband::MAX_SAMPLES || (width != 1 && width != 2))
+			return -1;
+
+		const int size = Baseband::HEADER_SIZE + n * 4 * width;
+		if (avail < size)
+			return 0;
+
+		const uint32_t seq = get32(p + 4);
+		const uint64_t idx = get64(p + 8);
+		const uint32_t s = get32(p + 20);
+
+		FLOAT32 scale;
+		std::memcpy(&scale, &s, sizeof(scale));
+
+		if (started && idx > next_idx)
+		{
+			const int gap = (int)std::min(idx - next_idx, (uint64_t)MAX_GAP);
+
+			Warning() << "Baseband: " << (idx - next_idx) << " samples lost from the edge (frames " << next_seq << " to " << seq << ").";
+
+			output_a.insert(output_a.end(), gap, 0.0f);
+			output_b.insert(output_b.end(), gap, 0.0f);
+		}
+		else if (started && idx < next_idx)
+			Info() << "Baseband: edge restarted.";
+		else if (!started)
+			Info() << "Baseband: receiving from edge at sample " << idx << ".";
+
+		started = synced = true;
+		next_seq = seq + 1;
+		next_idx = idx + n;
+
+		p += Baseband::HEADER_SIZE;
+
+		for (int i = 0; i < n; i++)
+		{
+			FLOAT32 v[4];
+
+			for (int j = 0; j < 4; j++)
+			{
+				if (width == 1)
+					v[j] = (int8_t)*p++ * scale;
+				else
+				{
+					v[j] = (int16_t)get16(p) * scale;
+					p += 2;
+				}
+			}
+
+			output_a.push_back(CFLOAT32(v[0], v[1]));
+			output_b.push_back(CFLOAT32(v[2], v[3]));
+		}
+
+		return size;
+	}
+
+	void BasebandDecoder::Receive(const RAW *data, int len, TAG &tag)
+	{
+		for (int i = 0; i < len; i++)
+		{
+			const uint8_t *d = (const uint8_t *)data[i].data;
+			buffer.insert(buffer.end(), d, d + data[i].size);
+		}
+
+		output_a.clear();
+		output_b.clear();
+
+		int pos = 0;
+		const int size = (int)buffer.size();
+
+		while (size - pos >= Baseband::HEADER_SIZE)
+		{
+			int r = decode(buffer.data() + pos, size - pos, tag);
+
+			if (r == 0)
+				break;
+
+			if (r < 0)
+			{
+				if (synced)
+					Warning() << "Baseband: stream out of sync, searching for the next frame.";
+				synced = false;
+				pos++;
+			}
+			else
+				pos += r;
+		}
+
+		buffer.erase(buffer.begin(), buffer.begin() + pos);
+
+		if (!output_a.empty())
+		{
+			a.Send(output_a.data(), (int)output_a.size(), tag);
+			b.Send(output_b.data(), (int)output_b.size(), tag);
+		}
+	}
+}
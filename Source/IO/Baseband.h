@@ -0,0 +1,124 @@
+/*
+	Copyright(c) 2021-2026 jvde.github@gmail.com
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "Common.h"
+#include "Stream.h"
+#include "TCPServer.h"
+
+// Edge/core split: an edge instance runs only the front-end and sends the two
+// 48K channels on as frames, a core instance reads them (Format::BASEBAND)
+// in place of the front-end. A frame, little endian:
+//
+//   0  "AISB"
+//   4  uint32 sequence number
+//   8  uint64 index of the first sample since the edge started
+//  16  uint16 samples per channel n
+//  18  uint16 bytes per component, 1 or 2
+//  20  float32 scale
+//  24  n x (I_A, Q_A, I_B, Q_B) as int8 or int16, times scale
+//
+// Each frame is scaled to its own peak, so it is short enough to follow the
+// level of a burst.
+namespace IO
+{
+	namespace Baseband
+	{
+		const int HEADER_SIZE = 24;
+		const int MAX_SAMPLES = 1024;
+	}
+
+	// Packs channel A and B, which arrive in separate calls, into frames
+	class BasebandEncoder : public StreamOut<RAW>
+	{
+		struct Port : public StreamIn<CFLOAT32>
+		{
+			BasebandEncoder *encoder = nullptr;
+			std::vector<CFLOAT32> pending;
+
+			void Receive(const CFLOAT32 *data, int len, TAG &tag)
+			{
+				pending.insert(pending.end(), data, data + len);
+				encoder->flush(tag);
+			}
+		};
+
+		int width = 2;
+		uint32_t seq = 0;
+		uint64_t sample_idx = 0;
+		std::vector<uint8_t> frame;
+
+		void flush(TAG &tag);
+
+	public:
+		BasebandEncoder()
+		{
+			a.encoder = this;
+			b.encoder = this;
+		}
+
+		// bytes per component: 1 halves the rate, 2 keeps the detail of weak signals
+		void setWidth(int w) { width = w; }
+		int getWidth() const { return width; }
+
+		// Streams in
+		Port a, b;
+	};
+
+	// Serves the frames to any core that connects
+	class BasebandServer : public StreamIn<RAW>, public IO::TCPServer
+	{
+		int port = 5012;
+
+	public:
+		virtual ~BasebandServer() { stopThread(); }
+
+		void setPort(int p) { port = p; }
+		int getPort() const { return port; }
+		void Start();
+
+		void Receive(const RAW *data, int len, TAG &tag);
+	};
+
+	// Turns the byte stream from an edge back into the two channels. Samples the
+	// edge could not deliver come out as silence so both channels keep their timing.
+	class BasebandDecoder : public StreamIn<RAW>
+	{
+		static const int MAX_GAP = 48000;
+
+		std::vector<uint8_t> buffer;
+		std::vector<CFLOAT32> output_a, output_b;
+
+		bool started = false; // next_idx is known
+		bool synced = false;  // on a frame boundary
+		uint32_t next_seq = 0;
+		uint64_t next_idx = 0;
+
+		int decode(const uint8_t *p, int avail, TAG &tag);
+
+	public:
+		// Streams out
+		Connection<CFLOAT32> a, b;
+
+		void Receive(const RAW *data, int len, TAG &tag);
+	};
+}
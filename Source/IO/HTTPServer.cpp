@@ -17,6 +17,12 @@
 
 #include <cstring>
 
+#ifdef __linux__
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
 #include "HTTPServer.h"
 #include "Logger.h"
 
@@ -459,7 +465,7 @@ namespace IO
 		return common_headers;
 	}
 
-	void HTTPServer::ResponseRaw(IO::TCPServerConnection &c, const std::string &type, const char *data, int len, bool gzip, bool cache, bool cors, int status)
+	std::string HTTPServer::responseHeader(IO::TCPServerConnection &c, const std::string &type, long len, bool gzip, bool cache, bool cors, int status)
 	{
 		std::string header = "HTTP/1.1 " + std::to_string(status) + " " + statusText(status) +
 							 "\r\nContent-Type: " + type + commonHeaders();
@@ -489,6 +495,12 @@ namespace IO
 
 		header += std::string("\r\nConnection: ") + (c.close_after_send ? "close" : "keep-alive") +
 				  "\r\nContent-Length: " + std::to_string(len) + "\r\n\r\n";
+		return header;
+	}
+
+	void HTTPServer::ResponseRaw(IO::TCPServerConnection &c, const std::string &type, const char *data, int len, bool gzip, bool cache, bool cors, int status)
+	{
+		const std::string header = responseHeader(c, type, len, gzip, cache, cors, status);
 
 		if (!Send(c, header.c_str(), header.length()))
 		{
@@ -507,4 +519,51 @@ namespace IO
 			return;
 		}
 	}
+
+	bool HTTPServer::ResponseFile(IO::TCPServerConnection &c, const std::string &type, const std::string &path, bool cache, bool cors)
+	{
+#ifdef __linux__
+		int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+		if (fd < 0)
+			return false;
+
+		struct stat st;
+		if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode))
+		{
+			::close(fd);
+			return false;
+		}
+
+		const std::string header = responseHeader(c, type, (long)st.st_size, false, cache, cors, 200);
+
+		if (!Send(c, header.c_str(), header.length()))
+		{
+			::close(fd);
+			Error() << "Server: closing client socket.";
+			c.Close();
+			return true;
+		}
+
+		if (c.head_request)
+			::close(fd);
+		else if (!SendFile(c, fd, (long)st.st_size))
+		{
+			Error() << "Server: closing client socket.";
+			c.Close();
+		}
+		return true;
+#else
+		std::ifstream file(path.c_str(), std::ios::binary | std::ios::ate);
+		if (!file.is_open())
+			return false;
+
+		std::vector<char> data((size_t)file.tellg());
+		file.seekg(0, std::ios::beg);
+		if (!file.read(data.data(), data.size()))
+			return false;
+
+		ResponseRaw(c, type, data.data(), (int)data.size(), false, cache, cors);
+		return true;
+#endif
+	}
 }
\ No newline at end of file
@@ -194,6 +194,9 @@ namespace IO
 		void Response(IO::TCPServerConnection &c, const std::string &type, const std::string &content, bool gzip = false, bool cache = false, bool cors = false, int status = 200);
 		void Response(IO::TCPServerConnection &c, const std::string &type, const char *data, int len, bool gzip = false, bool cache = false, bool cors = false, int status = 200);
 		void ResponseRaw(IO::TCPServerConnection &c, const std::string &type, const char *data, int len, bool gzip = false, bool cache = false, bool cors = false, int status = 200);
+		// a file sent as is, on Linux without passing through user space;
+		// false, with nothing sent, if it cannot be opened
+		bool ResponseFile(IO::TCPServerConnection &c, const std::string &type, const std::string &path, bool cache = false, bool cors = false);
 
 		// Serve another server's routes under a path prefix, so one listener can
 		// front both. A server can be mounted once: its subscribers are held by
@@ -336,6 +339,7 @@ namespace IO
 		std::vector<std::pair<std::string, HTTPServer *>> mounts;
 		HTTPServer *mounted_on = nullptr;
 		const std::string &commonHeaders();
+		std::string responseHeader(IO::TCPServerConnection &c, const std::string &type, long len, bool gzip, bool cache, bool cors, int status);
 
 		ZIP zip;
 
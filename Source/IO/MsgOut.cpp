@@ -39,7 +39,7 @@ namespace IO
 		{
 			StreamIn<JSON::JSON> *um = (StreamIn<JSON::JSON> *)&*this;
 			if (r.Output(j).canConnect(um->getGroupsIn()))
-				r.OutputJSON(j).Connect(um);
+				r.OutputJSON(j, jsonKeys()).Connect(um);
 		}
 	}
 
@@ -32,6 +32,7 @@
 #include "OutputStats.h"
 #include "JSON/JSON.h"
 #include "JSON/Writer.h"
+#include "JSONAIS.h"
 #include "Logger.h"
 
 class Receiver;
@@ -123,13 +124,7 @@ namespace IO
 			}
 		}
 
-		// usesJSONStream() drives the stream wiring in Connect(), jsonFormat() the GPS encoding
-		bool usesJSONStream() const
-		{
-			return fmt == MessageFormat::JSON_FULL || fmt == MessageFormat::JSON_ANNOTATED ||
-				   fmt == MessageFormat::JSON_SPARSE;
-		}
-
+		// jsonFormat() drives the GPS encoding, usesJSONStream() below the stream wiring
 		bool jsonFormat() const
 		{
 			return usesJSONStream() || fmt == MessageFormat::JSON_NMEA;
@@ -159,12 +154,23 @@ namespace IO
 
 	public:
 		std::vector<std::string> zones;
+		// the config entry this output was built from, for matching on reload
+		std::string spec;
 
 		MessageFormat fmt = MessageFormat::JSON_FULL;
 
+		bool usesJSONStream() const
+		{
+			return fmt == MessageFormat::JSON_FULL || fmt == MessageFormat::JSON_ANNOTATED ||
+				   fmt == MessageFormat::JSON_SPARSE;
+		}
+
 		void ConnectMessage(Receiver &r);
 		void ConnectJSON(Receiver &r);
 
+		// the JSON fields Receive() reads, all of them unless narrowed
+		virtual AIS::KeySet jsonKeys() const { return AIS::KeySet::all(); }
+
 		virtual void Start() {}
 		virtual void Stop() {}
 		bool hasUUID() const { return !uuid.empty(); }
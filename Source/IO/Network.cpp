@@ -557,6 +557,17 @@ namespace IO
 
 	void MQTTStreamer::Stop()
 	{
+		// no sends after this; the destructor calls Stop() again
+		std::lock_guard<std::mutex> lock(session_mtx);
+
+		if (stopped)
+			return;
+
+		stopped = true;
+
+		if (session == &mqtt)
+			mqtt.drain(2);
+
 		session->disconnect();
 	}
 
@@ -234,8 +234,17 @@ namespace IO
 		Util::TemplateString topic_template;
 		std::string topic_buf;
 
+		// receivers send on the session while Stop() drains and disconnects it
+		std::mutex session_mtx;
+		bool stopped = false;
+
 		void sendFormatted(const char *data, int len, const AIS::Message *msg, TAG &tag) override
 		{
+			std::lock_guard<std::mutex> lock(session_mtx);
+
+			if (stopped)
+				return;
+
 			if (session == &mqtt && msg)
 			{
 				topic_template.write(tag, *msg, topic_buf);
@@ -245,7 +254,22 @@ namespace IO
 				session->send(data, len);
 		}
 
-		void batchDone(TAG &) override { session->read(nullptr, 0, 0, false); }
+		// publishes of the batch go out in one write; the acks read after it open the window again
+		void batchDone(TAG &) override
+		{
+			std::lock_guard<std::mutex> lock(session_mtx);
+
+			if (stopped)
+				return;
+
+			if (session == &mqtt)
+				mqtt.flush();
+
+			session->read(nullptr, 0, 0, false);
+
+			if (session == &mqtt)
+				mqtt.flush();
+		}
 
 	public:
 		MQTTStreamer() : OutputMessage("MQTT"), topic_template("ais/data")
@@ -254,6 +278,8 @@ namespace IO
 			forward_gps = false;
 		}
 
+		~MQTTStreamer() { Stop(); }
+
 		void Start() override;
 		void Stop() override;
 
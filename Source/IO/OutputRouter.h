@@ -0,0 +1,97 @@
+/*
+	Copyright(c) 2021-2026 jvde.github@gmail.com
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "Common.h"
+#include "Stream.h"
+#include "MsgOut.h"
+
+// Managed mode connects the receivers to the outputs through a router per
+// model output instead of directly. The routers read the outputs from one
+// shared list that is replaced as a whole, so outputs can be added and removed
+// while the receivers keep streaming. Readers hold the list they loaded until
+// the call returns: once the previous list has expired no receiver thread can
+// be inside a removed output anymore.
+namespace IO
+{
+	typedef std::vector<OutputMessage *> OutputList;
+
+	class OutputTable
+	{
+		std::shared_ptr<const OutputList> list = std::make_shared<const OutputList>();
+
+	public:
+		std::shared_ptr<const OutputList> get() const { return std::atomic_load(&list); }
+		void set(const std::shared_ptr<const OutputList> &l) { std::atomic_store(&list, l); }
+	};
+
+	// Applies the selection OutputMessage::Connect() makes at start-up for every
+	// call: the stream the format needs and the groups the output takes
+	class OutputRouter : public StreamIn<AIS::Message>, public StreamIn<JSON::JSON>, public StreamIn<AIS::GPS>
+	{
+		const OutputTable &table;
+		uint64_t groups, groups_gps;
+
+	public:
+		OutputRouter(const OutputTable &t, uint64_t g, uint64_t g_gps) : table(t), groups(g), groups_gps(g_gps) {}
+		virtual ~OutputRouter() {}
+
+		using StreamIn<AIS::Message>::Receive;
+		using StreamIn<JSON::JSON>::Receive;
+		using StreamIn<AIS::GPS>::Receive;
+
+		void Receive(const AIS::Message *data, int len, TAG &tag) override
+		{
+			std::shared_ptr<const OutputList> l = table.get();
+
+			for (OutputMessage *o : *l)
+			{
+				StreamIn<AIS::Message> *s = o;
+				if (!o->usesJSONStream() && (groups & s->getGroupsIn()))
+					s->ReceiveSafe(data, len, tag);
+			}
+		}
+
+		void Receive(const JSON::JSON *data, int len, TAG &tag) override
+		{
+			std::shared_ptr<const OutputList> l = table.get();
+
+			for (OutputMessage *o : *l)
+			{
+				StreamIn<JSON::JSON> *s = o;
+				if (o->usesJSONStream() && (groups & s->getGroupsIn()))
+					s->ReceiveSafe(data, len, tag);
+			}
+		}
+
+		void Receive(const AIS::GPS *data, int len, TAG &tag) override
+		{
+			std::shared_ptr<const OutputList> l = table.get();
+
+			for (OutputMessage *o : *l)
+			{
+				StreamIn<AIS::GPS> *s = o;
+				if (groups_gps & s->getGroupsIn())
+					s->ReceiveSafe(data, len, tag);
+			}
+		}
+	};
+}
@@ -32,6 +32,11 @@ namespace IO
         uint32_t connected = 0;
         uint64_t dropped = 0;
 
+        // database outputs: rows committed, and the last flush cycle's latency and rate
+        uint64_t rows_out = 0;
+        uint32_t flush_ms = 0;
+        uint32_t rows_per_sec = 0;
+
         void writeJSON(JSON::Writer &w) const
         {
             w.beginObject()
@@ -41,8 +46,12 @@ namespace IO
                 .kv("connect_fail", connect_fail)
                 .kv("reconnects", reconnects)
                 .kv("connected", connected)
-                .kv("dropped", dropped)
-                .endObject();
+                .kv("dropped", dropped);
+            if (rows_out)
+                w.kv("rows_out", rows_out)
+                    .kv("flush_ms", flush_ms)
+                    .kv("rows_per_sec", rows_per_sec);
+            w.endObject();
         }
     };
 }
\ No newline at end of file
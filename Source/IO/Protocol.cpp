@@ -965,7 +965,7 @@ namespace Protocol
 		createPacket(PacketType::SUBSCRIBE, 2);
 		pushVariableLength(packet_length);
 
-		pushInt(packet_id++);
+		pushInt(nextId());
 		pushString(topic);
 		pushByte(qos);
 	}
@@ -975,7 +975,9 @@ namespace Protocol
 		createPacket(PacketType::CONNECT, 0);
 
 		int length = 12 + client_id.length();
-		uint8_t flags = 0x02;
+
+		// a kept session lets the broker recognise the DUP resends after a reconnect
+		uint8_t flags = qos > 0 && !client_id.empty() ? 0x00 : 0x02;
 
 		if (!username.empty())
 		{
@@ -1126,10 +1128,22 @@ namespace Protocol
 	{
 		buffer_ptr = 0;
 
+		// unsent bytes of the old connection: QoS 0 is lost, the rest is resent
+		out.clear();
+
 		performHandshake();
 
 		if (connected)
+		{
+			if (!spill_checked && !spill_path.empty())
+				recoverSpill();
+
+			retransmit();
+			pump();
+			flush();
+
 			ProtocolBase::onConnect();
+		}
 	}
 
 	void MQTT::onDisconnect()
@@ -1161,6 +1175,15 @@ namespace Protocol
 		case AIS::KEY_SETTING_SUBSCRIBE:
 			subscribe = Util::Parse::Switch(value);
 			break;
+		case AIS::KEY_SETTING_WINDOW:
+			window = Util::Parse::Integer(value, 1, 1024);
+			break;
+		case AIS::KEY_SETTING_BACKLOG:
+			max_backlog = Util::Parse::Integer(value, 1, 1000000);
+			break;
+		case AIS::KEY_SETTING_SPILL:
+			spill_path = value;
+			break;
 		default:
 			return false;
 		}
@@ -1174,30 +1197,275 @@ namespace Protocol
 		return prev_connected && connected;
 	}
 
-	int MQTT::send(const void *str, int length, const std::string &tpc)
+	uint16_t MQTT::nextId()
 	{
-		if (!isConnected())
-			return 0;
+		// ids wrap at 16 bits and must not collide with one still in flight
+		while (true)
+		{
+			const uint16_t id = (uint16_t)packet_id;
+			packet_id = packet_id >= 0xFFFF ? 1 : packet_id + 1;
+
+			bool used = false;
+			for (const auto &f : inflight)
+				if (f.id == id)
+				{
+					used = true;
+					break;
+				}
+
+			if (!used)
+				return id;
+		}
+	}
+
+	void MQTT::appendPublish(const Publish &m, uint16_t id, bool dup)
+	{
+		createPacket(PacketType::PUBLISH, (qos << 1) | (dup ? 0x08 : 0));
+
+		pushVariableLength(2 + m.topic.length() + m.payload.length() + (qos > 0 ? 2 : 0));
+		pushString(m.topic);
+
+		if (qos > 0)
+			pushInt(id);
+
+		packet.insert(packet.end(), m.payload.begin(), m.payload.end());
+		out.insert(out.end(), packet.begin(), packet.end());
+	}
+
+	void MQTT::enqueue(const void *str, int length, const std::string &tpc)
+	{
+		Publish m;
+		m.topic = tpc;
+		m.payload.assign((const char *)str, length);
+
+		// once spilling, everything newer goes to disk too so order is kept
+		if ((int)backlog.size() >= max_backlog || spilled > 0)
+		{
+			if (!spill_path.empty())
+			{
+				spill(m);
+				return;
+			}
+
+			backlog.pop_front();
+			if (dropped++ % 1000 == 0)
+				Warning() << "MQTT: backlog full, dropped " << dropped << " messages so far";
+		}
+
+		backlog.push_back(std::move(m));
+	}
+
+	void MQTT::spill(const Publish &m)
+	{
+		if (!spill_out.is_open())
+		{
+			spill_out.open(spill_path.c_str(), std::ios::out | std::ios::app | std::ios::binary);
+			if (!spill_out.is_open())
+			{
+				Error() << "MQTT: cannot open spill file " << spill_path << ", dropping messages";
+				spill_path.clear();
+				dropped++;
+				return;
+			}
+		}
+
+		const uint32_t n[2] = {(uint32_t)m.topic.size(), (uint32_t)m.payload.size()};
+		spill_out.write((const char *)n, sizeof(n));
+		spill_out << m.topic << m.payload;
+		spilled++;
+	}
+
+	void MQTT::unspill()
+	{
+		spill_out.flush();
+
+		std::ifstream in(spill_path.c_str(), std::ios::binary);
+		in.seekg(spill_read);
+
+		// refill half the backlog; the rest stays on disk
+		const long batch = MAX(1, max_backlog / 2);
+		for (long i = 0; i < batch && spilled > 0; i++)
+		{
+			uint32_t n[2];
+			Publish m;
+			if (!in.read((char *)n, sizeof(n)))
+				break;
+
+			m.topic.resize(n[0]);
+			m.payload.resize(n[1]);
+			if (!in.read(&m.topic[0], n[0]) || !in.read(&m.payload[0], n[1]))
+				break;
+
+			backlog.push_back(std::move(m));
+			spilled--;
+			spill_read = in.tellg();
+		}
+
+		// a short file means records were lost; either way start afresh when empty
+		if (spilled > 0 && backlog.empty())
+		{
+			Warning() << "MQTT: spill file " << spill_path << " truncated, " << spilled << " messages lost";
+			dropped += spilled;
+			spilled = 0;
+		}
+
+		if (spilled == 0)
+		{
+			spill_out.close();
+			std::remove(spill_path.c_str());
+			spill_read = 0;
+		}
+	}
+
+	// a spill file left by an earlier run is sent before anything new
+	void MQTT::recoverSpill()
+	{
+		spill_checked = true;
+
+		std::ifstream in(spill_path.c_str(), std::ios::binary | std::ios::ate);
+		if (!in.is_open())
+			return;
+
+		const std::streamoff size = in.tellg();
+		std::streamoff pos = 0;
+		uint32_t n[2];
 
+		// a torn last record is not counted
+		while (pos + (std::streamoff)sizeof(n) <= size && in.seekg(pos) && in.read((char *)n, sizeof(n)))
+		{
+			pos += sizeof(n) + (std::streamoff)n[0] + n[1];
+			if (pos <= size)
+				spilled++;
+		}
+
+		if (spilled)
+			Info() << "MQTT: " << spilled << " messages recovered from spill file " << spill_path;
+	}
+
+	void MQTT::pump()
+	{
+		while ((int)inflight.size() < window)
+		{
+			if (backlog.empty())
+			{
+				if (spilled == 0)
+					return;
+
+				unspill();
+				if (backlog.empty())
+					return;
+			}
+
+			InFlight f;
+			f.id = nextId();
+			f.released = false;
+			f.msg = std::move(backlog.front());
+			backlog.pop_front();
+
+			appendPublish(f.msg, f.id, false);
+			inflight.push_back(std::move(f));
+
+			if (out.size() >= FLUSH_BYTES)
+				flush();
+		}
+	}
+
+	void MQTT::retransmit()
+	{
+		if (inflight.empty())
+			return;
+
+		Debug() << "MQTT: resending " << inflight.size() << " unacknowledged messages";
+
+		for (const auto &f : inflight)
+		{
+			if (f.released)
+			{
+				createPacket(PacketType::PUBREL, 2);
+				pushVariableLength(2);
+				pushInt(f.id);
+				out.insert(out.end(), packet.begin(), packet.end());
+			}
+			else
+				appendPublish(f.msg, f.id, true);
+		}
+	}
+
+	void MQTT::acknowledge(uint16_t id, PacketType type)
+	{
+		// acks come in order as a rule, so the front is checked first
+		for (auto it = inflight.begin(); it != inflight.end(); ++it)
+		{
+			if (it->id != id)
+				continue;
+
+			if (type == PacketType::PUBREC)
+				it->released = true;
+			else if ((type == PacketType::PUBACK && qos == 1) || (type == PacketType::PUBCOMP && qos == 2))
+				inflight.erase(it);
+
+			return;
+		}
+	}
+
+	void MQTT::flush()
+	{
+		if (out.empty())
+			return;
+
+		if (isConnected())
+			prev->send(out.data(), out.size());
+
+		out.clear();
+	}
+
+	void MQTT::drain(int seconds)
+	{
+		const auto t0 = std::chrono::steady_clock::now();
+
+		while ((!inflight.empty() || !backlog.empty() || spilled > 0) && isConnected() &&
+			   std::chrono::steady_clock::now() - t0 < std::chrono::seconds(seconds))
+		{
+			pump();
+			flush();
+			read(nullptr, 0, 1, false);
+		}
+
+		if (!inflight.empty() || !backlog.empty())
+			Warning() << "MQTT: " << inflight.size() + backlog.size() << " messages not acknowledged at shutdown"
+					  << (spilled ? ", " + std::to_string(spilled) + " kept in spill file" : "");
+	}
+
+	int MQTT::send(const void *str, int length, const std::string &tpc)
+	{
 		if (length > 2048)
 		{
 			Warning() << "MQTT: message too long, skipped";
 			return -1;
 		}
 
-		createPacket(PacketType::PUBLISH, qos << 1);
-
-		int packet_length = 2 + tpc.length() + length + (qos > 0 ? 2 : 0);
-
-		pushVariableLength(packet_length);
-		pushString(tpc);
+		if (qos == 0)
+		{
+			if (!isConnected())
+				return 0;
 
-		if (qos > 0)
-			pushInt(packet_id++);
+			Publish m;
+			m.topic = tpc;
+			m.payload.assign((const char *)str, length);
+			appendPublish(m, 0, false);
+		}
+		else
+		{
+			// kept while disconnected; the reconnect sends it
+			enqueue(str, length, tpc);
+			if (isConnected())
+				pump();
+		}
 
-		packet.insert(packet.end(), (char *)str, (char *)str + length);
+		if (out.size() >= FLUSH_BYTES)
+			flush();
 
-		return prev->send(packet.data(), packet.size());
+		return length;
 	}
 
 	int MQTT::send(const void *str, int length)
@@ -1325,6 +1593,8 @@ namespace Protocol
 					disconnect();
 					return -1;
 				}
+				acknowledge((buffer[i] << 8) + buffer[i + 1], PacketType::PUBREC);
+
 				createPacket(PacketType::PUBREL, 2);
 				pushVariableLength(2);
 				pushByte(buffer[i]);
@@ -1349,8 +1619,14 @@ namespace Protocol
 
 				break;
 			case PacketType::PUBACK:
-			case PacketType::DISCONNECT:
 			case PacketType::PUBCOMP:
+				if (length >= 2)
+				{
+					acknowledge((buffer[i] << 8) + buffer[i + 1], (PacketType)(buffer[0] & 0xF0));
+					pump();
+				}
+				break;
+			case PacketType::DISCONNECT:
 			case PacketType::SUBACK:
 				break;
 			default:
@@ -1368,7 +1644,8 @@ namespace Protocol
 
 	std::string MQTT::getValues()
 	{
-		return "topic " + topic + " client_id " + client_id + " username " + username + " password " + password + " qos " + std::to_string(qos);
+		return "topic " + topic + " client_id " + client_id + " username " + username + " password " + password + " qos " + std::to_string(qos) +
+			   " window " + std::to_string(window) + " backlog " + std::to_string(max_backlog) + (spill_path.empty() ? "" : " spill " + spill_path);
 	}
 
 	///  ------WebSocket Implementation------
@@ -22,6 +22,7 @@
 #include <thread>
 #include <mutex>
 #include <array>
+#include <deque>
 #include <vector>
 #include <functional>
 #include <cstring>
@@ -482,6 +483,48 @@ namespace Protocol
 		bool connected = false;
 		bool subscribe = false;
 
+		// QoS 1/2: up to `window` PUBLISHes await their ack at once, later ones
+		// wait in the backlog. Both survive a reconnect; the in-flight ones are
+		// then sent again with DUP set. A full backlog spills to `spill_path`
+		// if set, otherwise its oldest message is dropped.
+		struct Publish
+		{
+			std::string topic, payload;
+		};
+
+		struct InFlight
+		{
+			uint16_t id;
+			bool released; // QoS 2: PUBREC seen, PUBREL sent, PUBCOMP pending
+			Publish msg;
+		};
+
+		std::deque<InFlight> inflight;
+		std::deque<Publish> backlog;
+		int window = 32;
+		int max_backlog = 4096;
+		long dropped = 0;
+
+		std::string spill_path;
+		std::ofstream spill_out;
+		std::streamoff spill_read = 0;
+		long spilled = 0; // records in the spill file not yet read back
+		bool spill_checked = false;
+
+		// packets are collected here and written with one send per flush()
+		std::vector<uint8_t> out;
+		static const size_t FLUSH_BYTES = 16384;
+
+		uint16_t nextId();
+		void appendPublish(const Publish &m, uint16_t id, bool dup);
+		void enqueue(const void *str, int length, const std::string &tpc);
+		void acknowledge(uint16_t id, PacketType type);
+		void pump();
+		void retransmit();
+		void spill(const Publish &m);
+		void unspill();
+		void recoverSpill();
+
 		void pushVariableLength(int length);
 		void pushByte(uint8_t byte);
 		void pushInt(int length);
@@ -501,6 +544,12 @@ namespace Protocol
 		bool isConnected() override;
 		int send(const void *str, int length, const std::string &tpc);
 		int send(const void *str, int length) override;
+
+		// writes the packets collected by send()
+		void flush();
+
+		// at shutdown: wait up to `seconds` for the broker to take what is queued
+		void drain(int seconds);
 		int read(void *data, int data_len, int t = 1, bool wait = false) override;
 
 		std::string getValues() override;
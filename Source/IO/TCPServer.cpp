@@ -27,6 +27,10 @@
 #else
 #include <arpa/inet.h> // For inet_addr() and INADDR_ANY
 #include <netinet/tcp.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <sys/sendfile.h>
+#endif
 #ifdef __ANDROID__
 #include <android/log.h>
 #endif
@@ -107,7 +111,7 @@ namespace IO
 	}
 	void TCPServerConnection::SendBuffer()
 	{
-		if (isConnected() && hasSendBuffer())
+		if (isConnected() && out_pos < out.size())
 		{
 
 			int bytes = ::send(sock, out.data() + out_pos, pending(), 0);
@@ -133,7 +137,85 @@ namespace IO
 				}
 			}
 		}
+
+#ifdef __linux__
+		if (file_fd != -1 && isConnected() && out_pos == out.size())
+		{
+			off_t pos = (off_t)file_pos;
+			ssize_t bytes = ::sendfile(sock, file_fd, &pos, (size_t)(file_end - file_pos));
+
+			if (bytes < 0)
+			{
+				int e = Net::lastError();
+				if (!Net::wouldBlock(e))
+				{
+					if (verbose && !Net::peerGone(e))
+						Error() << "TCP Connection: error sending file to client: " << Net::errorString(e);
+
+					Close();
+				}
+			}
+			else if (bytes == 0)
+			{
+				// the file shrank under us, the promised length cannot be met
+				Close();
+			}
+			else
+			{
+				file_pos = (long)pos;
+				if (file_pos >= file_end)
+					closeFile();
+			}
+		}
+#endif
+	}
+
+	void TCPServerConnection::closeFile()
+	{
+#ifndef _WIN32
+		if (file_fd != -1)
+			::close(file_fd);
+#endif
+		file_fd = -1;
+		file_pos = file_end = 0;
+	}
+
+	bool TCPServerConnection::spillFile()
+	{
+#ifndef _WIN32
+		char buffer[16384];
+		while (file_fd != -1 && file_pos < file_end)
+		{
+			ssize_t n = ::pread(file_fd, buffer, (size_t)std::min<long>(sizeof(buffer), file_end - file_pos), (off_t)file_pos);
+			if (n <= 0 || !queue(buffer, (int)n))
+				return false;
+			file_pos += n;
+		}
+#endif
+		closeFile();
+		return true;
+	}
+
+#ifdef __linux__
+	bool TCPServerConnection::SendFile(int fd, long len)
+	{
+		if (!isConnected() || (file_fd != -1 && !spillFile()))
+		{
+			::close(fd);
+			return false;
+		}
+
+		file_fd = fd;
+		file_pos = 0;
+		file_end = len;
+
+		if (len == 0)
+			closeFile();
+
+		SendBuffer();
+		return isConnected();
 	}
+#endif
 	bool TCPServerConnection::queue(const char *data, int length)
 	{
 		if (out_pos >= OUT_COMPACT_THRESHOLD)
@@ -151,6 +233,12 @@ namespace IO
 		if (!isConnected())
 			return false;
 
+		if (file_fd != -1 && !spillFile())
+		{
+			Close();
+			return false;
+		}
+
 		int bytes = 0;
 
 		if (!hasSendBuffer())
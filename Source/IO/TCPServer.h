@@ -76,10 +76,18 @@ namespace IO
 			shrink(out);
 			shrink(msg);
 			out_pos = 0;
+			closeFile();
 		}
 		// append to the out buffer, compacting first and enforcing the size cap
 		bool queue(const char *data, int length);
 
+		// a file queued behind `out` (Linux only: sent with sendfile)
+		int file_fd = -1;
+		long file_pos = 0, file_end = 0;
+		void closeFile();
+		// later data must not overtake the file, so its rest moves into `out`
+		bool spillFile();
+
 	public:
 		~TCPServerConnection() { Close(); }
 
@@ -112,9 +120,14 @@ namespace IO
 		bool isConnected() const { return sock != -1; }
 		uint32_t getGeneration() const { return generation; }
 		void setNoTimeout() { no_timeout = true; }
-		bool hasSendBuffer() const { return out_pos < out.size(); }
+		bool hasSendBuffer() const { return out_pos < out.size() || file_fd != -1; }
 		void SendBuffer();
 		bool Send(const char *buffer, int length);
+#ifdef __linux__
+		// sends `len` bytes of an open file after anything queued, without
+		// copying it through user space; takes ownership of fd
+		bool SendFile(int fd, long len);
+#endif
 		void Read();
 		void setVerbosity(bool v) { verbose = v; }
 	};
@@ -193,6 +206,19 @@ namespace IO
 			return true;
 		}
 
+#ifdef __linux__
+		bool SendFile(TCPServerConnection &c, int fd, long len)
+		{
+			if (!c.SendFile(fd, len))
+				return false;
+
+			if (pstats)
+				pstats->bytes_out += len;
+
+			return true;
+		}
+#endif
+
 		int findFreeClient();
 		int numberOfClients();
 		void acceptClients();
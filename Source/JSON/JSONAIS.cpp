@@ -47,6 +47,9 @@ namespace AIS
 
 	void JSONAIS::U(const AIS::Message &msg, int p, int start, int len, unsigned undefined)
 	{
+		if (!want(p))
+			return;
+
 		unsigned u = msg.getUint(start, len);
 		if (u != undefined)
 			json.Add(p, (int)u);
@@ -54,6 +57,9 @@ namespace AIS
 
 	void JSONAIS::US(const AIS::Message &msg, int p, int start, int len, int b, unsigned undefined)
 	{
+		if (!want(p))
+			return;
+
 		unsigned u = msg.getUint(start, len);
 		if (u != undefined)
 			json.Add(p, (int)(u + b));
@@ -61,6 +67,9 @@ namespace AIS
 
 	void JSONAIS::UL(const AIS::Message &msg, int p, int start, int len, float a, float b, unsigned undefined)
 	{
+		if (!want(p))
+			return;
+
 		unsigned u = msg.getUint(start, len);
 		if (u != undefined)
 			json.Add(p, u * a + b);
@@ -68,6 +77,9 @@ namespace AIS
 
 	void JSONAIS::S(const AIS::Message &msg, int p, int start, int len, int undefined)
 	{
+		if (!want(p))
+			return;
+
 		int u = msg.getInt(start, len);
 		if (u != undefined)
 			json.Add(p, u);
@@ -75,6 +87,9 @@ namespace AIS
 
 	void JSONAIS::SL(const AIS::Message &msg, int p, int start, int len, float a, float b, int undefined)
 	{
+		if (!want(p))
+			return;
+
 		int s = msg.getInt(start, len);
 		if (s != undefined)
 			json.Add(p, s * a + b);
@@ -82,10 +97,14 @@ namespace AIS
 
 	void JSONAIS::E(const AIS::Message &msg, int p, int start, int len, int pmap)
 	{
+		const bool text = pmap && want(pmap);
+		if (!want(p) && !text)
+			return;
+
 		unsigned u = msg.getUint(start, len);
-		json.Add(p, (int)u);
+		add(p, (int)u);
 		const std::vector<std::string> *map = KeyInfoMap[p].lookup_table;
-		if (map && pmap)
+		if (map && text)
 		{
 			if (u < map->size())
 				json.Add(pmap, &(*map)[u]);
@@ -96,28 +115,34 @@ namespace AIS
 
 	void JSONAIS::TURN(const AIS::Message &msg, int p, int start, int len, unsigned undefined)
 	{
+		if (!want(p) && !want(AIS::KEY_TURN_UNSCALED))
+			return;
+
 		int u = msg.getInt(start, len);
-		json.Add(AIS::KEY_TURN_UNSCALED, u);
+		add(AIS::KEY_TURN_UNSCALED, u);
 
 		if (u > -127 && u < 127)
 		{
 			double rot = u / 4.733;
 			rot = (u < 0) ? -rot * rot : rot * rot;
-			json.Add(p, (int)(rot + 0.5));
+			add(p, (int)(rot + 0.5));
 		}
 		else if (u != -128) // -128 = not available; raw value stays in turn_unscaled
-			json.Add(p, u); // 127/-127: turning right/left > 5 deg/30 s, no TI
+			add(p, u); // 127/-127: turning right/left > 5 deg/30 s, no TI
 	}
 
 	void JSONAIS::B(const AIS::Message &msg, int p, int start, int len)
 	{
+		if (!want(p))
+			return;
+
 		unsigned u = msg.getUint(start, len);
 		json.Add(p, (bool)u);
 	}
 
 	void JSONAIS::TIMESTAMP(const AIS::Message &msg, int p, int start, int len, std::string &str)
 	{
-		if (len != 40)
+		if (len != 40 || !want(p))
 			return;
 
 		auto put2 = [](char *d, unsigned v)
@@ -145,7 +170,7 @@ namespace AIS
 
 	void JSONAIS::ETA(const AIS::Message &msg, int p, int start, int len, std::string &str)
 	{
-		if (len != 20)
+		if (len != 20 || !want(p))
 			return;
 
 		auto put2 = [](char *d, unsigned v)
@@ -167,12 +192,18 @@ namespace AIS
 
 	void JSONAIS::T(const AIS::Message &msg, int p, int start, int len, std::string &str)
 	{
+		if (!want(p))
+			return;
+
 		msg.getText(start, len, str);
 		json.Add(p, &str);
 	}
 
 	void JSONAIS::D(const AIS::Message &msg, int p, int start, int len, std::string &str)
 	{
+		if (!want(p))
+			return;
+
 		str = std::to_string(len) + ':';
 		for (int i = start; i < start + len; i += 4)
 		{
@@ -185,6 +216,9 @@ namespace AIS
 	// Reference: https://www.itu.int/dms_pubrec/itu-r/rec/m/R-REC-M.585-9-202205-I!!PDF-E.pdf
 	void JSONAIS::COUNTRY(const AIS::Message &msg)
 	{
+		if (!want(AIS::KEY_COUNTRY) && !want(AIS::KEY_COUNTRY_CODE))
+			return;
+
 		uint32_t mid = msg.mmsi();
 		while (mid > 1000)
 			mid /= 10;
@@ -211,8 +245,8 @@ namespace AIS
 									   { return c.MID < m; });
 			if (it != JSON_MAP_MID.end() && it->MID == mid)
 			{
-				json.Add(AIS::KEY_COUNTRY, &it->country);
-				json.Add(AIS::KEY_COUNTRY_CODE, &it->code);
+				add(AIS::KEY_COUNTRY, &it->country);
+				add(AIS::KEY_COUNTRY_CODE, &it->code);
 			}
 		}
 	}
@@ -1050,19 +1084,19 @@ namespace AIS
 
 		if (radio_value != 0 && len == 19)
 		{
-			json.Add(AIS::KEY_RADIO, (int)radio_value);
+			add(AIS::KEY_RADIO, (int)radio_value);
 
 			unsigned sync_state = (radio_value >> 17) & 0x03;
-			json.Add(AIS::KEY_SYNC_STATE, (int)sync_state);
+			add(AIS::KEY_SYNC_STATE, (int)sync_state);
 
 			unsigned slot_timeout = (radio_value >> 14) & 0x07;
-			json.Add(AIS::KEY_SLOT_TIMEOUT, (int)slot_timeout);
+			add(AIS::KEY_SLOT_TIMEOUT, (int)slot_timeout);
 
 			unsigned sub_msg = radio_value & 0x3FFF;
 
 			if (slot_timeout == 0)
 			{
-				json.Add(AIS::KEY_SLOT_OFFSET, (int)sub_msg);
+				add(AIS::KEY_SLOT_OFFSET, (int)sub_msg);
 			}
 			else if (slot_timeout == 1)
 			{
@@ -1071,71 +1105,79 @@ namespace AIS
 
 				if (utc_hour < 24 && utc_minute < 60)
 				{
-					json.Add(AIS::KEY_UTC_HOUR, utc_hour);
-					json.Add(AIS::KEY_UTC_MINUTE, utc_minute);
+					add(AIS::KEY_UTC_HOUR, utc_hour);
+					add(AIS::KEY_UTC_MINUTE, utc_minute);
 				}
 			}
 			else if (slot_timeout == 2 || slot_timeout == 4 || slot_timeout == 6)
 			{
-				json.Add(AIS::KEY_SLOT_NUMBER, (int)sub_msg);
+				add(AIS::KEY_SLOT_NUMBER, (int)sub_msg);
 			}
 			else if (slot_timeout == 3 || slot_timeout == 5 || slot_timeout == 7)
 			{
-				json.Add(AIS::KEY_RECEIVED_STATIONS, (int)sub_msg);
+				add(AIS::KEY_RECEIVED_STATIONS, (int)sub_msg);
 			}
 		}
 		else
 		{
-			json.Add(AIS::KEY_RADIO, 0);
+			add(AIS::KEY_RADIO, 0);
 		}
 	}
 	void JSONAIS::ProcessMsg(const AIS::Message &msg, TAG &tag)
 	{
+		full = !declared || demand.hasType(msg.type());
+
 		channel = std::string(1, msg.getChannel());
 
-		json.Add(AIS::KEY_CLASS, &class_str);
-		json.Add(AIS::KEY_DEVICE, &device);
-		json.Add(AIS::KEY_VERSION, tag.version);
-		json.Add(AIS::KEY_DRIVER, (int)tag.driver);
-		json.Add(AIS::KEY_HARDWARE, &tag.hardware);
+		add(AIS::KEY_CLASS, &class_str);
+		add(AIS::KEY_DEVICE, &device);
+		add(AIS::KEY_VERSION, tag.version);
+		add(AIS::KEY_DRIVER, (int)tag.driver);
+		add(AIS::KEY_HARDWARE, &tag.hardware);
 
 		if (tag.mode & 2)
 		{
-			rxtime = msg.getRxTime();
-			json.Add(AIS::KEY_RXTIME, &rxtime);
-			json.Add(AIS::KEY_RXUXTIME, (double)msg.getRxTimeMicros() / 1000000.0);
+			if (want(AIS::KEY_RXTIME))
+			{
+				rxtime = msg.getRxTime();
+				json.Add(AIS::KEY_RXTIME, &rxtime);
+			}
+			add(AIS::KEY_RXUXTIME, (double)msg.getRxTimeMicros() / 1000000.0);
 		}
 
 		if (msg.getTOA())
-			json.Add(AIS::KEY_TOA, (double)msg.getTOA() / 1000000.0);
+			add(AIS::KEY_TOA, (double)msg.getTOA() / 1000000.0);
 
-		json.Add(AIS::KEY_SCALED, true);
+		add(AIS::KEY_SCALED, true);
 
 		if (tag.error != MESSAGE_ERROR_NONE)
-			json.Add(AIS::KEY_ERROR, (int)tag.error);
+			add(AIS::KEY_ERROR, (int)tag.error);
 
-		json.Add(AIS::KEY_CHANNEL, &channel);
+		add(AIS::KEY_CHANNEL, &channel);
 
-		nmea_values.clear();
-		for (const auto &s : msg.sentences())
+		if (want(AIS::KEY_NMEA))
 		{
-			JSON::Value v;
-			v.setString(const_cast<std::string *>(&s));
-			nmea_values.push_back(v);
+			nmea_values.clear();
+			for (const auto &s : msg.sentences())
+			{
+				JSON::Value v;
+				v.setString(const_cast<std::string *>(&s));
+				nmea_values.push_back(v);
+			}
+			JSON::Value arr;
+			arr.setArray(&nmea_values);
+			json.Add(AIS::KEY_NMEA, arr);
 		}
-		JSON::Value arr;
-		arr.setArray(&nmea_values);
-		json.Add(AIS::KEY_NMEA, arr);
 
 		if (tag.mode & 1)
 		{
-			if (tag.level != LEVEL_UNDEFINED) json.Add(AIS::KEY_SIGNAL_POWER, tag.level);
-			if (tag.ppm != PPM_UNDEFINED) json.Add(AIS::KEY_PPM, tag.ppm);
+			if (tag.level != LEVEL_UNDEFINED) add(AIS::KEY_SIGNAL_POWER, tag.level);
+			if (tag.ppm != PPM_UNDEFINED) add(AIS::KEY_PPM, tag.ppm);
 		}
 
 		if (msg.getStation())
 		{
-			json.Add(AIS::KEY_STATION_ID, msg.getStation());
+			add(AIS::KEY_STATION_ID, msg.getStation());
 		}
 
 		if (msg.getLength() > 0)
@@ -1222,7 +1264,8 @@ namespace AIS
 			X(msg, AIS::KEY_SPARE, 71, 1);
 			U(msg, AIS::KEY_DAC, 72, 10);
 			U(msg, AIS::KEY_FID, 82, 6);
-			ProcessMsg6Data(msg);
+			if (full)
+				ProcessMsg6Data(msg);
 			break;
 		case 7:
 		case 13:
@@ -1245,7 +1288,8 @@ namespace AIS
 		case 8:
 			U(msg, AIS::KEY_DAC, 40, 10);
 			U(msg, AIS::KEY_FID, 50, 6);
-			ProcessMsg8Data(msg);
+			if (full)
+				ProcessMsg8Data(msg);
 			break;
 		case 9:
 			U(msg, AIS::KEY_ALT, 38, 12, 4095);
@@ -1471,7 +1515,7 @@ namespace AIS
 				U(msg, AIS::KEY_DEST_MMSI, 40, 30);
 				X(msg, AIS::KEY_SPARE, 70, 2);
 			}
-			if (structured)
+			if (structured && full)
 			{
 				if (addressed)
 				{
@@ -1514,7 +1558,7 @@ namespace AIS
 			U(msg, AIS::KEY_RESTRICTED_USE, 99, 2);
 			U(msg, AIS::KEY_ATON_STATION_TYPE, 101, 3);
 			// station_type==4 means Virtual AtoN — mirror msg 21's virtual_aid flag.
-			json.Add(AIS::KEY_VIRTUAL_AID, (bool)(msg.getUint(101, 3) == 4));
+			add(AIS::KEY_VIRTUAL_AID, (bool)(msg.getUint(101, 3) == 4));
 			E(msg, AIS::KEY_AID_TYPE, 104, 7, AIS::KEY_AID_TYPE_TEXT);
 			U(msg, AIS::KEY_IALA_MRN, 111, 17);
 			U(msg, AIS::KEY_DIM_TYPE, 128, 4);
@@ -23,10 +23,74 @@
 #include "AIS.h"
 
 namespace AIS {
+	// The fields a consumer of the JSON reads. Messages of a type added with
+	// addType() are built in full; the ASM fields of messages 6, 8, 25 and 26
+	// are only built that way, never for single keys.
+	class KeySet {
+		std::vector<bool> keys;
+		uint32_t types = 0;
+		bool everything = false;
+
+	public:
+		KeySet() : keys(KEY_COUNT, false) {}
+
+		static KeySet all() {
+			KeySet k;
+			k.everything = true;
+			return k;
+		}
+
+		KeySet& add(int key) {
+			keys[key] = true;
+			return *this;
+		}
+
+		KeySet& add(const int* k, int n) {
+			for (int i = 0; i < n; i++) keys[k[i]] = true;
+			return *this;
+		}
+
+		KeySet& addType(int type) {
+			types |= 1u << type;
+			return *this;
+		}
+
+		void merge(const KeySet& other) {
+			everything |= other.everything;
+			types |= other.types;
+			for (int i = 0; i < KEY_COUNT; i++)
+				if (other.keys[i]) keys[i] = true;
+		}
+
+		// every key and type other reads is in here as well
+		bool covers(const KeySet& other) const {
+			if (everything) return true;
+			if (other.everything || (other.types & ~types)) return false;
+			for (int i = 0; i < KEY_COUNT; i++)
+				if (other.keys[i] && !keys[i]) return false;
+			return true;
+		}
+
+		bool has(int key) const { return everything || keys[key]; }
+		bool hasType(int type) const { return everything || (type >= 0 && type < 32 && (types >> type) & 1); }
+	};
+
 	class JSONAIS : public SimpleStreamInOut<Message, JSON::JSON> {
 		JSON::JSON json;
 		std::vector<JSON::Value> nmea_values;
 
+		// union of what the consumers read; until one declares, everything
+		KeySet demand;
+		bool declared = false;
+		bool full = true; // the current message is built in full
+
+		bool want(int key) const { return full || demand.has(key); }
+
+		template <typename T>
+		void add(int key, T value) {
+			if (want(key)) json.Add(key, value);
+		}
+
 		void ProcessMsg(const AIS::Message& msg, TAG& tag);
 
 		const std::string class_str = "AIS";
@@ -109,6 +173,15 @@ namespace AIS {
 	public:
 		virtual ~JSONAIS() {}
 
+		// Each consumer declares what it reads when it is wired up
+		void require(const KeySet& keys) {
+			if (declared)
+				demand.merge(keys);
+			else
+				demand = keys;
+			declared = true;
+		}
+
 		void Receive(const AIS::Message* data, int len, TAG& tag);
 	};
 }
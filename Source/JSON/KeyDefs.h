@@ -80,6 +80,9 @@ X(KEY_SETTING_CRC_CHECK, "", "", "", "", "crc_check", "", "", "", nullptr)
 X(KEY_SETTING_CUTOFF, "", "", "", "", "cutoff", "", "", "", nullptr)
 X(KEY_SETTING_TRACK_MEMORY, "", "", "", "", "track_memory", "", "KB", "Memory budget for ship tracks", nullptr)
 X(KEY_SETTING_TRACK_TIME, "", "", "", "", "track_time", "", "sec", "How far back tracks and replay reach, 0 for no limit", nullptr)
+X(KEY_SETTING_EVENTS_MAX, "", "", "", "", "events_max", "", "", "Ship changes and binary messages kept for event polling", nullptr)
+X(KEY_SETTING_EVENTS_KB, "", "", "", "", "events_kb", "", "KB", "Memory budget for the event log", nullptr)
+X(KEY_SETTING_TRACK_DIR, "", "", "", "", "track_dir", "", "", "Directory keeping track history beyond memory for replay", nullptr)
 X(KEY_SETTING_DECODER, "", "", "", "", "decoder", "", "", "", nullptr)
 X(KEY_SETTING_DESCRIPTION, "", "", "", "", "description", "", "", "", nullptr)
 X(KEY_SETTING_DESC, "", "", "", "", "desc", "", "", "", nullptr)
@@ -101,6 +104,8 @@ X(KEY_SETTING_FLOWCONTROL, "", "", "", "", "flowcontrol", "", "", "", nullptr)
 X(KEY_SETTING_OWN_INTERVAL, "", "", "", "", "own_interval", "", "seconds", "Minimum interval for own vessel messages", nullptr)
 X(KEY_SETTING_CAPACITY, "", "", "", "", "capacity", "", "", "Maximum number of targets kept in the CSV state table", nullptr)
 X(KEY_SETTING_RETENTION, "", "", "", "", "retention", "", "days", "Days of history a database output keeps, 0 for all", nullptr)
+X(KEY_SETTING_BULK, "", "", "", "", "bulk", "", "", "PostgreSQL: stream each flush with COPY and client-side ids", nullptr)
+X(KEY_SETTING_READERS, "", "", "", "", "readers", "", "", "SQLite: read-only connections kept open for queries against the log", nullptr)
 X(KEY_SETTING_DB, "", "", "", "", "db", "", "", "Write messages to a database", nullptr)
 X(KEY_SETTING_POSITION, "", "", "", "", "position", "", "", "Log position reports to the database", nullptr)
 X(KEY_SETTING_POSITION_INTERVAL, "", "", "", "", "position_interval", "", "seconds", "Minimum interval for position messages per MMSI", nullptr)
@@ -111,6 +116,7 @@ X(KEY_SETTING_FREQOFFSET, "", "", "", "", "freqoffset", "", "", "", nullptr)
 X(KEY_SETTING_FREQUENCY, "", "", "", "", "frequency", "", "", "", nullptr)
 X(KEY_SETTING_FSOVERLAY, "", "", "", "", "fsoverlay", "", "", "", nullptr)
 X(KEY_SETTING_FSTILES, "", "", "", "", "fstiles", "", "", "", nullptr)
+X(KEY_SETTING_FUSED, "", "", "", "", "fused", "", "", "", nullptr)
 X(KEY_SETTING_GAIN, "", "", "", "", "gain", "", "", "", nullptr)
 X(KEY_SETTING_GAIN_MODE, "", "", "", "", "gain_mode", "", "", "", nullptr)
 X(KEY_SETTING_GEOJSON, "", "", "", "", "geojson", "", "", "", nullptr)
@@ -169,6 +175,7 @@ X(KEY_SETTING_OUTPUT, "", "", "", "", "output", "", "", "", nullptr)
 X(KEY_SETTING_OWN_MMSI, "", "", "", "", "own_mmsi", "", "", "", nullptr)
 X(KEY_SETTING_PASSWORD, "", "", "", "", "password", "", "", "", nullptr)
 X(KEY_SETTING_PERSIST, "", "", "", "", "persist", "", "", "", nullptr)
+X(KEY_SETTING_PFB, "", "", "", "", "pfb", "", "", "", nullptr)
 X(KEY_SETTING_PLUGIN, "", "", "", "", "plugin", "", "", "", nullptr)
 X(KEY_SETTING_PLUGIN_DIR, "", "", "", "", "plugin_dir", "", "", "", nullptr)
 X(KEY_SETTING_PORT, "", "", "", "", "port", "", "", "", nullptr)
@@ -179,6 +186,7 @@ X(KEY_SETTING_PRINT, "", "", "", "", "print", "", "", "", nullptr)
 X(KEY_SETTING_PROBE, "", "", "", "", "probe", "", "", "", nullptr)
 X(KEY_SETTING_PROGRAM, "", "", "", "", "program", "", "", "", nullptr)
 X(KEY_SETTING_PROME, "", "", "", "", "prome", "", "", "", nullptr)
+X(KEY_SETTING_PROME_SAMPLES, "", "", "", "", "prome_samples", "", "", "", nullptr)
 X(KEY_SETTING_PROTOCOL, "", "", "", "", "protocol", "", "", "", nullptr)
 X(KEY_SETTING_PRODUCT, "", "", "", "", "product", "", "", "", nullptr)
 X(KEY_SETTING_PROTOCOLS, "", "", "", "", "protocols", "", "", "", nullptr)
@@ -242,6 +250,7 @@ X(KEY_SETTING_TUNER, "", "", "", "", "tuner", "", "", "", nullptr)
 X(KEY_SETTING_TXT_BLOCK_SIZE, "", "", "", "", "txt_block_size", "", "", "", nullptr)
 X(KEY_SETTING_UDP, "", "", "", "", "udp", "", "", "", nullptr)
 X(KEY_SETTING_UDPSERVER, "", "", "", "", "udpserver", "", "", "", nullptr)
+X(KEY_SETTING_TCPSERVER, "", "", "", "", "tcpserver", "", "", "", nullptr)
 X(KEY_SETTING_URL, "", "", "", "", "url", "", "", "", nullptr)
 X(KEY_SETTING_USE_GPS, "", "", "", "", "use_gps", "", "", "", nullptr)
 X(KEY_SETTING_USERNAME, "", "", "", "", "username", "", "", "", nullptr)
@@ -264,6 +273,12 @@ X(KEY_SETTING_WIZARD, "", "", "", "", "wizard", "", "", "", nullptr)
 X(KEY_SETTING_LEGACY_CONFIG, "", "", "", "", "legacy_config", "", "", "", nullptr)
 X(KEY_SETTING_FRAME_ANCESTORS, "", "", "", "", "frame_ancestors", "", "", "", nullptr)
 X(KEY_SETTING_QOS, "", "", "", "", "qos", "", "", "", nullptr)
+X(KEY_SETTING_WINDOW, "", "", "", "", "window", "", "messages", "MQTT QoS 1/2 publishes awaiting acknowledgement at once", nullptr)
+X(KEY_SETTING_BACKLOG, "", "", "", "", "backlog", "", "messages", "MQTT QoS 1/2 messages held while the window is full or the broker is away", nullptr)
+X(KEY_SETTING_SPILL, "", "", "", "", "spill", "", "", "File a full MQTT backlog overflows to instead of dropping messages", nullptr)
+X(KEY_SETTING_WORKERS, "", "", "", "", "workers", "", "", "UDP input: sockets sharing the port, each on its own thread", nullptr)
+X(KEY_SETTING_STATION_MAP, "", "", "", "", "station_map", "", "", "TCP server input: address=station pairs, comma separated", nullptr)
+X(KEY_SETTING_BATCH, "", "", "", "", "batch", "", "datagrams", "UDP input: datagrams taken per receive call", nullptr)
 X(KEY_SETTING_ZLIB, "", "", "", "", "zlib", "", "", "", nullptr)
 X(KEY_SETTING_ZMQ, "", "", "", "", "zmq", "", "", "", nullptr)
 X(KEY_SETTING_AIS, "", "", "", "", "ais", "", "", "", nullptr)
@@ -100,7 +100,8 @@ enum class Format
 	S16,
 	UNKNOWN,
 	F32_FS4,
-	DC16H
+	DC16H,
+	BASEBAND
 };
 
 enum class PROTOCOL
@@ -138,7 +139,8 @@ enum class Type
 	ZMQ = 12,
 	SPYSERVER = 13,
 	N2K = 14,
-	HYDRASDR = 15
+	HYDRASDR = 15,
+	TCPSERVER = 16
 };
 
 enum class MessageFormat
@@ -263,6 +265,8 @@ struct TAG
 	long long sample_idx = 0;
 	long long msg_idx_start = 0, msg_idx_end = 0;
 	uint32_t ipv4 = 0;
+	// sender of the input for per-sender reassembly; kept by clear() and never written out
+	uint32_t source = 0;
 	uint32_t error = MESSAGE_ERROR_NONE;
 	bool replay = false;
 
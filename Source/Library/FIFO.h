@@ -131,6 +131,13 @@ public:
 		return blocks_filled == N_BLOCKS;
 	}
 
+	bool Halted()
+	{
+		std::unique_lock<std::mutex> lock(fifo_mutex);
+
+		return blocks_filled == -1;
+	}
+
 	void setWait(bool b) { default_wait = b; }
 
 	bool Push(char *data, int sz) { return Push(data, sz, default_wait); }
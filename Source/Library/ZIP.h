@@ -19,10 +19,14 @@
 
 #include <vector>
 #include <string>
+#include <cstdint>
 
 #ifdef HASZLIB
 #include <zlib.h>
 #endif
+#ifdef HASZSTD
+#include <zstd.h>
+#endif
 
 class ZIP
 {
@@ -76,4 +80,183 @@ public:
 		return false;
 #endif
 	}
-};
\ No newline at end of file
+
+	// inverse of zip(); `size` is the inflated length, known to the caller
+	bool unzip(const char *data, size_t len, size_t size)
+	{
+		output.clear();
+#ifdef HASZLIB
+		z_stream strm = {};
+		if (inflateInit2(&strm, 15 | 16) != Z_OK)
+			return false;
+
+		output.resize(size);
+		strm.next_in = (unsigned char *)data;
+		strm.avail_in = (uInt)len;
+		strm.next_out = output.data();
+		strm.avail_out = (uInt)output.size();
+
+		bool ok = inflate(&strm, Z_FINISH) == Z_STREAM_END && strm.total_out == size;
+		if (!ok)
+			output.clear();
+
+		inflateEnd(&strm);
+		return ok;
+#else
+		return false;
+#endif
+	}
+};
+
+// Streaming decompression of a gzip or zstd stream, chosen by its magic
+// bytes. Concatenated members/frames are followed through to the end.
+class StreamUnzip
+{
+public:
+	enum class Codec
+	{
+		NONE,
+		GZIP,
+		ZSTD
+	};
+
+private:
+	Codec codec = Codec::NONE;
+	std::vector<char> output;
+#ifdef HASZLIB
+	z_stream strm = {};
+#endif
+#ifdef HASZSTD
+	ZSTD_DStream *zstd = nullptr;
+#endif
+
+public:
+	~StreamUnzip() { reset(); }
+
+	static Codec detect(const char *p, size_t n)
+	{
+		const unsigned char *u = (const unsigned char *)p;
+		if (n >= 2 && u[0] == 0x1F && u[1] == 0x8B)
+			return Codec::GZIP;
+		if (n >= 4 && u[0] == 0x28 && u[1] == 0xB5 && u[2] == 0x2F && u[3] == 0xFD)
+			return Codec::ZSTD;
+		return Codec::NONE;
+	}
+
+	static const char *name(Codec c) { return c == Codec::GZIP ? "gzip" : c == Codec::ZSTD ? "zstd" : "none"; }
+
+	// false when this build has no library for the codec
+	bool init(Codec c, size_t chunk)
+	{
+		reset();
+		output.resize(chunk);
+
+		switch (c)
+		{
+#ifdef HASZLIB
+		case Codec::GZIP:
+			strm = {};
+			if (inflateInit2(&strm, 15 | 32) != Z_OK)
+				return false;
+			codec = c;
+			return true;
+#endif
+#ifdef HASZSTD
+		case Codec::ZSTD:
+			zstd = ZSTD_createDStream();
+			if (!zstd || ZSTD_isError(ZSTD_initDStream(zstd)))
+				return false;
+			codec = c;
+			return true;
+#endif
+		default:
+			return false;
+		}
+	}
+
+	void reset()
+	{
+#ifdef HASZLIB
+		if (codec == Codec::GZIP)
+			inflateEnd(&strm);
+#endif
+#ifdef HASZSTD
+		if (zstd)
+		{
+			ZSTD_freeDStream(zstd);
+			zstd = nullptr;
+		}
+#endif
+		codec = Codec::NONE;
+	}
+
+	// decompresses `n` input bytes, handing each filled output chunk (at most
+	// the `chunk` passed to init) to out(data, len); false on corrupt input.
+	// out() returns false to abandon the stream: the input is then left half
+	// read, so it must only do so when no further feed() will follow.
+	template <typename F>
+	bool feed(const char *p, size_t n, F out)
+	{
+#ifdef HASZLIB
+		if (codec == Codec::GZIP)
+		{
+			strm.next_in = (Bytef *)p;
+			strm.avail_in = (uInt)n;
+
+			// a full output buffer may leave decoded bytes inside zlib, so go round again
+			bool full = false;
+			while (strm.avail_in > 0 || full)
+			{
+				strm.next_out = (Bytef *)output.data();
+				strm.avail_out = (uInt)output.size();
+
+				int r = inflate(&strm, Z_NO_FLUSH);
+				size_t have = output.size() - strm.avail_out;
+				full = strm.avail_out == 0;
+
+				if (have && !out(output.data(), have))
+					return true;
+
+				if (r == Z_STREAM_END)
+				{
+					// next member of a concatenated .gz
+					if (inflateReset(&strm) != Z_OK)
+						return false;
+				}
+				else if (r == Z_BUF_ERROR)
+				{
+					// no progress possible: wait for more input
+					if (!have)
+						break;
+				}
+				else if (r != Z_OK)
+					return false;
+			}
+			return true;
+		}
+#endif
+#ifdef HASZSTD
+		if (codec == Codec::ZSTD)
+		{
+			ZSTD_inBuffer in = {p, n, 0};
+			bool full = false;
+
+			while (in.pos < in.size || full)
+			{
+				ZSTD_outBuffer o = {output.data(), output.size(), 0};
+
+				size_t r = ZSTD_decompressStream(zstd, &o, &in);
+				if (ZSTD_isError(r))
+					return false;
+
+				full = o.pos == o.size;
+
+				if (o.pos && !out(output.data(), o.pos))
+					return true;
+			}
+			return true;
+		}
+#endif
+		return false;
+	}
+};
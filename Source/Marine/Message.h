@@ -54,6 +54,8 @@ namespace AIS
 
 		float getLat() const { return lat; }
 		float getLon() const { return lon; }
+		const std::string &getSource() const { return source; }
+		bool getIsJSON() const { return isJSON; }
 
 		const std::string getNMEA() const;
 		const std::string getJSON() const;
@@ -23,6 +23,8 @@
 #include "Logger.h"
 #include <cmath>
 #include <cstdint>
+#include <cstring>
+#include <thread>
 
 namespace AIS
 {
@@ -38,13 +40,38 @@ namespace AIS
 		line.clear();
 	}
 
+	void NMEA::switchSource(uint32_t s)
+	{
+		if (state != ParseState::FIND_START)
+		{
+			if (partial.size() >= 1024)
+				partial.clear();
+
+			Partial &p = partial[source];
+			p.state = state;
+			p.line.swap(line);
+			p.count = count;
+		}
+		reset();
+
+		auto it = partial.find(s);
+		if (it != partial.end())
+		{
+			state = it->second.state;
+			line.swap(it->second.line);
+			count = it->second.count;
+			partial.erase(it);
+		}
+		source = s;
+	}
+
 	void NMEA::clean(const AIVDM &ref)
 	{
 		auto i = queue.begin();
 		uint64_t now = (uint64_t)rxtime_cache;
 		while (i != queue.end())
 		{
-			if ((ref.match_key & 0xFFFFFF00) == (i->match_key & 0xFFFFFF00) || (i->timestamp + 3 < now))
+			if (((ref.match_key & 0xFFFFFF00) == (i->match_key & 0xFFFFFF00) && ref.source == i->source) || (i->timestamp + 3 < now))
 				i = queue.erase(i);
 			else
 				i++;
@@ -479,6 +506,7 @@ namespace AIS
 		aivdm.reset(rxtime_cache);
 		aivdm.count = p[7] - '0';
 		aivdm.number = p[9] - '0';
+		aivdm.source = source;
 		uint8_t id = id_ch ? (id_ch - '0') : 0;
 
 		if (mctx.groupId != 0)
@@ -1117,6 +1145,9 @@ namespace AIS
 	{
 		std::time(&rxtime_cache);
 
+		if (tag.source != source)
+			switchSource(tag.source);
+
 		for (int j = 0; j < len; j++)
 		{
 			buf = (const char *)data[j].data;
@@ -1155,4 +1186,405 @@ namespace AIS
 			}
 		}
 	}
+	void NMEA::copySettings(const NMEA &o)
+	{
+		station = o.station;
+		uuid = o.uuid;
+		own_mmsi = o.own_mmsi;
+
+		cfg_regenerate = o.cfg_regenerate;
+		cfg_crc_check = o.cfg_crc_check;
+		cfg_JSON_input = o.cfg_JSON_input;
+		cfg_VDO = o.cfg_VDO;
+		cfg_warnings = o.cfg_warnings;
+		cfg_GPS = o.cfg_GPS;
+	}
+
+	void NMEA::fragment(const char *p, const char *end, int &count, int &number, uint32_t &key)
+	{
+		count = number = 0;
+		key = 0;
+
+		// skip a tag block, keeping its group id
+		if (p < end && *p == '\\')
+		{
+			p++;
+			while (p < end && *p != '\\' && *p != '\n')
+			{
+				if (p[0] == 'g' && p + 1 < end && p[1] == ':')
+				{
+					// g:number-count-id
+					const char *q = p + 2;
+					int dashes = 0;
+					uint32_t id = 0;
+					while (q < end && *q != ',' && *q != '*' && *q != '\\' && *q != '\n')
+					{
+						if (*q == '-')
+							dashes++;
+						else if (dashes == 2 && *q >= '0' && *q <= '9')
+							id = id * 10 + (*q - '0');
+						q++;
+					}
+					if (dashes == 2)
+						key = (1u << 31) | (id & 0x7FFFFFFF);
+				}
+				p++;
+			}
+			if (p >= end || *p != '\\')
+				return;
+			p++;
+		}
+
+		if (p >= end || *p != '!')
+			return;
+
+		const char *s = p;
+		while (p < end && *p != ',' && *p != '\n')
+			p++;
+
+		if (end - p < 5 || p[2] != ',' || p[4] != ',')
+			return;
+
+		if (p[1] >= '1' && p[1] <= '9' && p[3] >= '1' && p[3] <= '9')
+		{
+			count = p[1] - '0';
+			number = p[3] - '0';
+
+			// as the match key in processAIS: talker, channel, count and sequence id
+			if (!key && end - p > 5)
+			{
+				char id = p[5] >= '0' && p[5] <= '9' ? p[5] : '0';
+				const char *c = p[5] == ',' ? p + 6 : p + 7;
+				char channel = c < end && *c != ',' && *c != '\n' ? *c : '?';
+
+				key = ((uint32_t)(uint8_t)s[1] << 24) | ((uint32_t)(uint8_t)s[2] << 16) | ((uint32_t)(uint8_t)channel << 8) | ((uint32_t)count << 4) | (uint32_t)(id - '0');
+			}
+		}
+	}
+
+	bool NMEA::canCut(const char *lo, const char *c, const char *hi, bool final)
+	{
+		struct Group
+		{
+			uint32_t key;
+			bool open;	// last fragment before c is not the final one
+			bool ahead; // a fragment after c was seen
+		};
+
+		Group groups[2 * CUT_WINDOW];
+		int n = 0;
+
+		auto find = [&](uint32_t key) -> Group *
+		{
+			for (int i = 0; i < n; i++)
+				if (groups[i].key == key)
+					return &groups[i];
+			return nullptr;
+		};
+
+		// the lines before c, oldest first
+		const char *starts[CUT_WINDOW];
+		int lines = 0;
+		const char *b = c;
+		while (b > lo && lines < CUT_WINDOW)
+		{
+			b--;
+			while (b > lo && b[-1] != '\n')
+				b--;
+			starts[CUT_WINDOW - 1 - lines++] = b;
+		}
+		const bool history = lines == CUT_WINDOW; // the window before c is complete
+
+		for (int i = CUT_WINDOW - lines; i < CUT_WINDOW; i++)
+		{
+			int count, number;
+			uint32_t key;
+			fragment(starts[i], c, count, number, key);
+			if (count < 2)
+				continue;
+
+			Group *g = find(key);
+			if (!g)
+			{
+				g = &groups[n++];
+				g->key = key;
+				g->ahead = false;
+			}
+			g->open = number < count;
+		}
+
+		// the lines from c on: a message must not continue across c
+		const char *f = c;
+		lines = 0;
+		while (f < hi && lines < CUT_WINDOW)
+		{
+			const char *nl = (const char *)memchr(f, '\n', hi - f);
+			const char *next = nl ? nl + 1 : hi;
+
+			int count, number;
+			uint32_t key;
+			fragment(f, next, count, number, key);
+			f = next;
+			lines++;
+
+			if (count < 2)
+				continue;
+
+			Group *g = find(key);
+			if (g && g->ahead)
+				continue;
+
+			if (number > 1)
+			{
+				// continues a message begun before c, or one beyond the window
+				if ((g && g->open) || (!g && !history))
+					return false;
+			}
+
+			if (!g)
+			{
+				g = &groups[n++];
+				g->key = key;
+				g->open = false;
+			}
+			g->ahead = true;
+		}
+
+		// a message open before c may continue in input not seen yet
+		if (!final && lines < CUT_WINDOW)
+			for (int i = 0; i < n; i++)
+				if (groups[i].open && !groups[i].ahead)
+					return false;
+
+		return true;
+	}
+
+	const char *NMEA::nextCut(const char *lo, const char *p, const char *hi, bool final)
+	{
+		while (p < hi && !canCut(lo, p, hi, final))
+		{
+			const char *nl = (const char *)memchr(p, '\n', hi - p);
+			p = nl ? nl + 1 : hi;
+		}
+		return p;
+	}
+
+	const char *NMEA::prevCut(const char *lo, const char *p, const char *hi, bool final)
+	{
+		while (p > lo && !canCut(lo, p, hi, final))
+		{
+			p--;
+			while (p > lo && p[-1] != '\n')
+				p--;
+		}
+		return p;
+	}
+
+	void NMEAParallel::Worker::Receive(const Message *data, int len, TAG &tag)
+	{
+		for (int i = 0; i < len; i++)
+		{
+			if (count == msgs.size())
+				msgs.emplace_back();
+
+			msgs[count].msg = data[i];
+			msgs[count].tag = tag;
+			count++;
+		}
+	}
+
+	void NMEAParallel::Worker::Receive(const GPS *data, int len, TAG &tag)
+	{
+		for (int i = 0; i < len; i++)
+			fixes.push_back({data[i].getLat(), data[i].getLon(), data[i].getSource(), data[i].getIsJSON(), tag, count});
+	}
+
+	void NMEAParallel::Worker::decode(const char *p, size_t len, const TAG &tag)
+	{
+		count = 0;
+		fixes.clear();
+
+		if (!len)
+			return;
+
+		TAG t = tag;
+		RAW r = {Format::TXT, (void *)p, (int)len};
+		nmea.Receive(&r, 1, t);
+	}
+
+	NMEAParallel::NMEAParallel(const NMEA &settings, int n)
+	{
+		for (int i = 0; i < n; i++)
+		{
+			workers.push_back(std::unique_ptr<Worker>(new Worker()));
+			Worker &w = *workers.back();
+
+			w.nmea.copySettings(settings);
+			w.nmea.out.Connect(static_cast<StreamIn<Message> *>(&w));
+			w.nmea.outGPS.Connect(static_cast<StreamIn<GPS> *>(&w));
+		}
+
+		for (int i = 1; i < n; i++)
+			threads.push_back(std::thread(&NMEAParallel::run, this, std::ref(*workers[i])));
+	}
+
+	NMEAParallel::~NMEAParallel()
+	{
+		{
+			std::lock_guard<std::mutex> lock(mtx);
+			stopping = true;
+		}
+		cv_work.notify_all();
+
+		for (auto &t : threads)
+			t.join();
+	}
+
+	void NMEAParallel::run(Worker &w)
+	{
+		uint64_t seen = 0;
+
+		while (true)
+		{
+			{
+				std::unique_lock<std::mutex> lock(mtx);
+				cv_work.wait(lock, [&]
+							 { return stopping || round != seen; });
+				if (stopping)
+					return;
+				seen = round;
+			}
+
+			w.decode(w.data, w.size, *round_tag);
+
+			{
+				std::lock_guard<std::mutex> lock(mtx);
+				busy--;
+			}
+			cv_done.notify_one();
+		}
+	}
+
+	void NMEAParallel::decodeAll(const TAG &tag)
+	{
+		{
+			std::lock_guard<std::mutex> lock(mtx);
+			round_tag = &tag;
+			busy = (int)threads.size();
+			round++;
+		}
+		cv_work.notify_all();
+
+		workers[0]->decode(workers[0]->data, workers[0]->size, tag);
+
+		std::unique_lock<std::mutex> lock(mtx);
+		cv_done.wait(lock, [&]
+					 { return busy == 0; });
+	}
+
+	void NMEAParallel::emit(Worker &w)
+	{
+		size_t f = 0;
+		for (size_t i = 0; i <= w.count; i++)
+		{
+			for (; f < w.fixes.size() && w.fixes[f].before == i; f++)
+			{
+				GPS gps(w.fixes[f].lat, w.fixes[f].lon, w.fixes[f].source, w.fixes[f].json);
+				outGPS.Send(&gps, 1, w.fixes[f].tag);
+			}
+
+			if (i < w.count)
+				Send(&w.msgs[i].msg, 1, w.msgs[i].tag);
+		}
+	}
+
+	void NMEAParallel::flush(TAG &tag)
+	{
+		if (carry.empty())
+			return;
+
+		// the last line of a file need not end in a newline
+		carry += '\n';
+		workers[0]->decode(carry.data(), carry.size(), tag);
+		emit(*workers[0]);
+		carry.clear();
+	}
+
+	void NMEAParallel::Receive(const RAW *data, int len, TAG &tag)
+	{
+		// a carried group that never completes is decoded as it is
+		const size_t MAX_CARRY = 1 << 20;
+
+		for (int j = 0; j < len; j++)
+		{
+			if (data[j].size == 0)
+			{
+				flush(tag);
+				continue;
+			}
+
+			const char *p = (const char *)data[j].data;
+			const char *end = p + data[j].size;
+
+			// hold back an unterminated last line and what may continue in the next block
+			const char *tail = end;
+			while (tail > p && tail[-1] != '\n')
+				tail--;
+			tail = NMEA::prevCut(p, tail, tail, false);
+
+			if (tail == p)
+			{
+				carry.append(p, end - p);
+				if (carry.size() > MAX_CARRY)
+				{
+					size_t keep = carry.size() - carry.rfind('\n') - 1;
+					workers[0]->decode(carry.data(), carry.size() - keep, tag);
+					emit(*workers[0]);
+					carry.erase(0, carry.size() - keep);
+				}
+				continue;
+			}
+
+			// cut the rest into one piece per worker
+			size_t n = workers.size();
+			std::vector<const char *> cuts(n + 1, tail);
+			cuts[0] = p;
+
+			for (size_t i = 1; i < n; i++)
+			{
+				const char *c = p + (tail - p) * i / n;
+				if (c < cuts[i - 1])
+					c = cuts[i - 1];
+
+				const char *nl = (const char *)memchr(c, '\n', tail - c);
+				cuts[i] = NMEA::nextCut(p, nl ? nl + 1 : tail, tail, true);
+			}
+
+			// the carried lines go ahead of the first piece
+			if (!carry.empty())
+			{
+				carry.append(p, cuts[1] - p);
+				workers[0]->data = carry.data();
+				workers[0]->size = carry.size();
+			}
+			else
+			{
+				workers[0]->data = cuts[0];
+				workers[0]->size = cuts[1] - cuts[0];
+			}
+
+			for (size_t i = 1; i < n; i++)
+			{
+				workers[i]->data = cuts[i];
+				workers[i]->size = cuts[i + 1] - cuts[i];
+			}
+
+			decodeAll(tag);
+
+			for (size_t i = 0; i < n; i++)
+				emit(*workers[i]);
+
+			carry.assign(tail, end - tail);
+		}
+	}
 }
@@ -19,6 +19,11 @@
 
 #include <iomanip>
 #include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#include <unordered_map>
 
 #include "Convert.h"
 #include "Message.h"
@@ -53,6 +58,7 @@ namespace AIS
 			std::string sentence;
 			uint64_t timestamp = 0;
 			uint32_t match_key = 0;
+			uint32_t source = 0;
 			uint32_t message_error = 0;
 			uint16_t data_offset = 0;
 			uint16_t data_len = 0;
@@ -65,6 +71,7 @@ namespace AIS
 				sentence.clear();
 				timestamp = (uint64_t)rx;
 				match_key = 0;
+				source = 0;
 				message_error = 0;
 				data_offset = 0;
 				data_len = 0;
@@ -78,7 +85,7 @@ namespace AIS
 
 		static bool matches(const AIVDM &a, const AIVDM &b)
 		{
-			return a.match_key == b.match_key;
+			return a.match_key == b.match_key && a.source == b.source;
 		}
 
 		// Zero-allocation field splitter: stores delimiter positions into source string
@@ -99,6 +106,18 @@ namespace AIS
 
 		ParseState state = ParseState::FIND_START;
 		std::string line;
+
+		// Sender of the current input (tag.source on entry, 0 when unknown). A line
+		// split over datagrams is parked per sender while another one is read.
+		struct Partial
+		{
+			ParseState state = ParseState::FIND_START;
+			std::string line;
+			int count = 0;
+		};
+		uint32_t source = 0;
+		std::unordered_map<uint32_t, Partial> partial;
+		void switchSource(uint32_t s);
 		std::string gps_line; // reused buffer: GPS needs a std::string (split + source ref)
 		int count = 0;
 
@@ -209,6 +228,89 @@ namespace AIS
 		void setStamp(bool b);
 		void setOwnMMSI(int m) { own_mmsi = m; }
 
+		// take over the configuration of another instance (not its state)
+		void copySettings(const NMEA &o);
+
+		// fragment number and count of the multipart sentence on the line at p, 0 if
+		// none, and a key shared by the fragments of one message
+		static void fragment(const char *p, const char *end, int &count, int &number, uint32_t &key);
+
+		// Cutting text input at the line start c keeps every multipart message in
+		// one piece, also when other sentences sit between its fragments. Looks
+		// at up to CUT_WINDOW lines on either side within [lo, hi); unless final
+		// the input continues after hi.
+		static const int CUT_WINDOW = 16;
+		static bool canCut(const char *lo, const char *c, const char *hi, bool final);
+		// first cut at or after the line start p, hi if none
+		static const char *nextCut(const char *lo, const char *p, const char *hi, bool final);
+		// last cut at or before the line start p, lo if none
+		static const char *prevCut(const char *lo, const char *p, const char *hi, bool final);
+
+		Connection<GPS> outGPS;
+	};
+
+	// Decodes large blocks of text input on several NMEA instances at once.
+	// Blocks are cut where NMEA::canCut() allows, the pieces decoded in
+	// parallel on threads that live as long as the decoder and the results
+	// sent on in input order. Lines at the end of a block that may belong to
+	// a message continued in the next one are carried into it.
+	class NMEAParallel : public SimpleStreamInOut<RAW, Message>
+	{
+		struct Fix
+		{
+			float lat, lon;
+			std::string source;
+			bool json;
+			TAG tag;
+			size_t before; // messages decoded ahead of it
+		};
+
+		struct Decoded
+		{
+			Message msg;
+			TAG tag;
+		};
+
+		struct Worker : public StreamIn<Message>, public StreamIn<GPS>
+		{
+			NMEA nmea;
+			std::vector<Decoded> msgs; // slots reused between blocks
+			size_t count = 0;
+			std::vector<Fix> fixes;
+
+			// the piece of the current round
+			const char *data = nullptr;
+			size_t size = 0;
+
+			void Receive(const Message *data, int len, TAG &tag);
+			void Receive(const GPS *data, int len, TAG &tag);
+			void decode(const char *p, size_t len, const TAG &tag);
+		};
+
+		std::vector<std::unique_ptr<Worker>> workers;
+		std::string carry;
+
+		// workers[1..] decode on their own thread, one round per block
+		std::vector<std::thread> threads;
+		std::mutex mtx;
+		std::condition_variable cv_work, cv_done;
+		uint64_t round = 0;
+		int busy = 0;
+		bool stopping = false;
+		const TAG *round_tag = nullptr;
+
+		void run(Worker &w);
+		void decodeAll(const TAG &tag);
+		void emit(Worker &w);
+		void flush(TAG &tag);
+
+	public:
+		NMEAParallel(const NMEA &settings, int n);
+		~NMEAParallel();
+
+		// an empty block marks the end of the input and decodes what is held back
+		void Receive(const RAW *data, int len, TAG &tag);
+
 		Connection<GPS> outGPS;
 	};
 }
@@ -47,14 +47,44 @@ void DB::setup()
 	int path_blocks = paths.setup((long)track_memory_kb * 1024, nships);
 	Debug() << "DB: track store " << track_memory_kb << " KB (" << path_blocks << " blocks)";
 
+	// runs under mtx from eviction and claimShip, where the record still names the ship
+	paths.setSpill([this](int ptr, const PathStore::Point *pts, int n) {
+		if (archive.isOpen())
+			archive.add(ships[ptr].mmsi, pts, n);
+	});
+
 	changes.setup(nships, nships / 4);
+	events.clear();
+	events.setLimits(events_max, (std::size_t)events_kb * 1024);
 
-	for (int i = 0; i < MAX_BINARY_MESSAGES; i++)
-		binary_messages[i].Clear();
-	binary_msg_index = 0;
 	evict_horizon = 0;
 }
 
+void DB::setEventLimits(int entries, int kb)
+{
+	std::lock_guard<std::mutex> lock(mtx);
+
+	events_max = entries;
+	events_kb = kb;
+	events.setLimits(events_max, (std::size_t)events_kb * 1024);
+}
+
+void DB::setTrackDir(const std::string &dir)
+{
+	std::lock_guard<std::mutex> lock(mtx);
+
+	if (dir == track_dir && archive.isOpen() == !dir.empty())
+		return;
+
+	archive.close();
+	track_dir = dir;
+	if (!dir.empty())
+	{
+		archive.setKeep(track_time);
+		archive.open(dir);
+	}
+}
+
 std::string DB::getJSONcompact(bool full, std::time_t since)
 {
 	std::lock_guard<std::mutex> lock(mtx);
@@ -215,7 +245,8 @@ std::string DB::getAllPathJSON()
 // its [time, end] span touches. A windowed walk (until > 0) also emits the
 // first point wholly before the window — where the vessel was when it opened —
 // without which a chunk cannot draw a ship that last reported before it began.
-void DB::writeSinglePathJSONCompact(int ptr, JSON::Writer &w, std::time_t since, std::time_t until)
+// `older` continues the walk with archived points, ptr < 0 walks them alone.
+void DB::writeSinglePathJSONCompact(int ptr, JSON::Writer &w, std::time_t since, std::time_t until, const std::vector<PathStore::Point> *older)
 {
 	auto emit = [&](const PathStore::Point &p) {
 		w.beginArray().val(p.lat).val(p.lon).val(p.time).val(p.end())
@@ -225,25 +256,49 @@ void DB::writeSinglePathJSONCompact(int ptr, JSON::Writer &w, std::time_t since,
 			.endArray();
 	};
 
-	w.beginArray();
-	for (uint32_t r = paths.tail(ptr); PathStore::isPoint(r); r = paths.at(r).prev)
-	{
-		const PathStore::Point &p = paths.at(r);
+	auto visit = [&](const PathStore::Point &p) {
 		if ((std::time_t)p.end() < since)
 		{
 			if (until > 0)
 				emit(p);
-			break;
+			return false;
 		}
 
 		if (until <= 0 || (std::time_t)p.time <= until)
 			emit(p);
-	}
+		return true;
+	};
+
+	bool more = true;
+	w.beginArray();
+	if (ptr >= 0)
+		paths.walk(ptr, [&](const PathStore::Point &p) { return more = visit(p); });
+	if (more && older)
+		for (const auto &p : *older)
+			if (!visit(p))
+				break;
 	w.endArray();
 }
 
+// Archived tracks of the ships written so far continue their walk, the rest
+// are written once the ships in memory are done.
+void DB::writeArchivedPaths(JSON::Writer &w, TrackArchive::Tracks &disk, std::time_t since, std::time_t until, std::time_t from)
+{
+	for (const auto &t : disk)
+		if ((std::time_t)t.second.front().end() >= from)
+		{
+			w.key(t.first);
+			writeSinglePathJSONCompact(-1, w, since, until, &t.second);
+		}
+}
+
 std::string DB::getAllPathJSONSince(std::time_t since)
 {
+	// the disk is read before the lock, the window start is clamped after it
+	TrackArchive::Tracks disk;
+	if (archive.isOpen())
+		archive.read(since, 0, disk);
+
 	std::lock_guard<std::mutex> lock(mtx);
 
 	since = MAX(since, pathFloor(time(nullptr)));
@@ -254,12 +309,18 @@ std::string DB::getAllPathJSONSince(std::time_t since)
 		w.beginObject();
 
 		forEachRecent(time(nullptr), true, since, [&](int ptr, const Ship &ship, long int) {
-			if (paths.hasSince(ptr, since))
+			auto it = disk.find(ship.mmsi);
+			const std::vector<PathStore::Point> *older = it != disk.end() ? &it->second : nullptr;
+
+			if (paths.hasSince(ptr, since) || older)
 			{
 				w.key(ship.mmsi);
-				writeSinglePathJSONCompact(ptr, w, since);
+				writeSinglePathJSONCompact(ptr, w, since, 0, older);
 			}
+			if (older)
+				disk.erase(it);
 		});
+		writeArchivedPaths(w, disk, since, 0, since);
 		w.endObject().raw("\n\n");
 	}
 	return content;
@@ -279,11 +340,9 @@ std::string DB::getReplayInfoJSON(std::time_t block)
 		// `now` while the feed is quiet
 		uint32_t oldest = 0, newest = 0;
 		ships.forEach([&](int ptr) {
-			uint32_t h = paths.head(ptr);
-			if (PathStore::isPoint(h))
+			uint32_t t, e;
+			if (paths.span(ptr, t, e))
 			{
-				uint32_t t = paths.at(h).time;
-				uint32_t e = paths.at(paths.tail(ptr)).end();
 				if (oldest == 0 || t < oldest)
 					oldest = t;
 				if (e > newest)
@@ -293,6 +352,10 @@ std::string DB::getReplayInfoJSON(std::time_t block)
 		});
 
 		// the client only asks for blocks within the bounds it is given
+		uint32_t archived = archive.isOpen() ? archive.oldest() : 0;
+		if (archived && (oldest == 0 || archived < oldest))
+			oldest = archived;
+
 		std::time_t cutoff = pathFloor(now);
 		if (oldest && (std::time_t)oldest < cutoff)
 			oldest = (uint32_t)cutoff;
@@ -335,17 +398,30 @@ std::string DB::getReplayShipsJSON(std::time_t since, std::time_t lookback)
 
 std::string DB::getReplayJSON(std::time_t since, std::time_t until, std::time_t lookback)
 {
-	return getReplayObjectJSON(since, lookback, until, [this, until](JSON::Writer &w, int ptr, const Ship &ship, std::time_t from) {
+	TrackArchive::Tracks disk;
+	if (archive.isOpen())
+		archive.read(since > lookback ? since - lookback : 0, until, disk);
+
+	return getReplayObjectJSON(since, lookback, until, [&](JSON::Writer &w, int ptr, const Ship &ship, std::time_t from) {
+		auto it = disk.find(ship.mmsi);
 		w.key(ship.mmsi);
-		writeSinglePathJSONCompact(ptr, w, from, until);
+		writeSinglePathJSONCompact(ptr, w, from, until, it != disk.end() ? &it->second : nullptr);
+		if (it != disk.end())
+			disk.erase(it);
+	}, [&](JSON::Writer &w, std::time_t start, std::time_t from) {
+		writeArchivedPaths(w, disk, start, until, from);
 	});
 }
 
 template <typename F>
 static void walkPath(const PathStore &paths, int ptr, std::time_t floor, F emit)
 {
-	for (uint32_t r = paths.tail(ptr); PathStore::isPoint(r) && (std::time_t)paths.at(r).end() >= floor; r = paths.at(r).prev)
-		emit(paths.at(r));
+	paths.walk(ptr, [&](const PathStore::Point &p) {
+		if ((std::time_t)p.end() < floor)
+			return false;
+		emit(p);
+		return true;
+	});
 }
 
 void DB::writeSinglePathGeoJSON(int ptr, JSON::Writer &w, std::time_t floor)
@@ -466,7 +542,52 @@ static bool carriesOwnPosition(int type)
 void DB::logTextChange(const Ship &ship, int field, const char *old_value, const std::string &value)
 {
 	if (old_value[0] && value != old_value)
-		changes.addText(ship.mmsi, (StaticHistory::Field)field, value.c_str(), ship.last_signal);
+		logText(ship, (StaticHistory::Field)field, value.c_str());
+}
+
+// what the change history takes also goes to the event log, in the same shape
+void DB::logText(const Ship &ship, StaticHistory::Field field, const char *value)
+{
+	if (!changes.addText(ship.mmsi, field, value, ship.last_signal))
+		return;
+
+	std::string data;
+	JSON::Writer w(data);
+	w.beginObject().kv("f", (int)field).kv("to", value).endObject();
+	w.finish();
+	events.add(ship.mmsi, (uint32_t)ship.last_signal, EventLog::CHANGE, std::move(data));
+}
+
+void DB::logNumericChange(const Ship &ship, StaticHistory::Field field, uint8_t from, uint8_t to, bool initial)
+{
+	if (!changes.addNumeric(ship.mmsi, field, from, to, ship.last_signal, initial))
+		return;
+
+	std::string data;
+	JSON::Writer w(data);
+	w.beginObject().kv("f", (int)field).kv("from", (int)from).kv("to", (int)to);
+	if (initial)
+		w.kv("i", 1);
+	w.endObject();
+	w.finish();
+	events.add(ship.mmsi, (uint32_t)ship.last_signal, EventLog::CHANGE, std::move(data));
+}
+
+AIS::KeySet DB::jsonKeys()
+{
+	static const int keys[] = {
+		AIS::KEY_LAT, AIS::KEY_LON, AIS::KEY_SPEED, AIS::KEY_COURSE, AIS::KEY_HEADING, AIS::KEY_STATUS, AIS::KEY_ALT,
+		AIS::KEY_MANEUVER, AIS::KEY_RAIM, AIS::KEY_ASSIGNED, AIS::KEY_OFF_POSITION, AIS::KEY_VIRTUAL_AID,
+		AIS::KEY_CS, AIS::KEY_DISPLAY, AIS::KEY_DSC, AIS::KEY_BAND, AIS::KEY_MSG22, AIS::KEY_DTE,
+		AIS::KEY_RECEIVED_STATIONS, AIS::KEY_COUNTRY_CODE,
+		AIS::KEY_SHIPNAME, AIS::KEY_NAME, AIS::KEY_CALLSIGN, AIS::KEY_IMO, AIS::KEY_SHIPTYPE, AIS::KEY_DESTINATION,
+		AIS::KEY_DRAUGHT, AIS::KEY_TO_BOW, AIS::KEY_TO_STERN, AIS::KEY_TO_PORT, AIS::KEY_TO_STARBOARD,
+		AIS::KEY_MONTH, AIS::KEY_DAY, AIS::KEY_HOUR, AIS::KEY_MINUTE,
+		AIS::KEY_VENDORID, AIS::KEY_MODEL, AIS::KEY_SERIAL, AIS::KEY_VIN};
+
+	AIS::KeySet k;
+	k.add(keys, sizeof(keys) / sizeof(keys[0])).addType(6).addType(8);
+	return k;
 }
 
 void DB::updateFields(const JSON::Member &p, const AIS::Message *msg, Ship &ship, bool allowApproximate, bool &positionUpdated, bool &staticUpdated)
@@ -517,9 +638,9 @@ void DB::updateFields(const JSON::Member &p, const AIS::Message *msg, Ship &ship
 		if (d != 0 && (inland || !ship.getInlandDraught()))
 		{
 			const bool first = ship.draught == DRAUGHT_UNDEFINED || ship.draught <= 0;
-			changes.addNumeric(ship.mmsi, StaticHistory::DRAUGHT,
-							   first ? (uint8_t)(d * 10 + 0.5f) : (uint8_t)(ship.draught * 10 + 0.5f),
-							   (uint8_t)(d * 10 + 0.5f), ship.last_signal, first);
+			logNumericChange(ship, StaticHistory::DRAUGHT,
+							 first ? (uint8_t)(d * 10 + 0.5f) : (uint8_t)(ship.draught * 10 + 0.5f),
+							 (uint8_t)(d * 10 + 0.5f), first);
 			ship.draught = d;
 			ship.setInlandDraught(inland);
 			staticUpdated = true;
@@ -539,7 +660,7 @@ void DB::updateFields(const JSON::Member &p, const AIS::Message *msg, Ship &ship
 	{
 		const int st = p.Get().getInt();
 		if (ship.status != STATUS_UNDEFINED)
-			changes.addNumeric(ship.mmsi, StaticHistory::STATUS, (uint8_t)ship.status, (uint8_t)st, ship.last_signal);
+			logNumericChange(ship, StaticHistory::STATUS, (uint8_t)ship.status, (uint8_t)st);
 		ship.status = st;
 	}
 	break;
@@ -714,7 +835,7 @@ bool DB::updateShip(const JSON::JSON &data, TAG &tag, Ship &ship)
 		char eta[21];
 		std::snprintf(eta, sizeof(eta), "%02d-%02d %02d:%02d",
 					  (int)ship.month, (int)ship.day, (int)ship.hour, (int)ship.minute);
-		changes.addText(ship.mmsi, StaticHistory::ETA, eta, ship.last_signal);
+		logText(ship, StaticHistory::ETA, eta);
 	}
 
 	ship.setType();
@@ -755,7 +876,6 @@ void DB::processBinaryMessage(const JSON::JSON &data)
 {
 	const AIS::Message *msg = (AIS::Message *)data.binary;
 	int type = msg->type();
-	FLOAT32 loc_lat = LAT_UNDEFINED, loc_lon = LON_UNDEFINED;
 	bool has_content = false;
 
 	if (type != 6 && type != 8)
@@ -773,12 +893,6 @@ void DB::processBinaryMessage(const JSON::JSON &data)
 		case AIS::KEY_FID:
 			fi = p.Get().getInt();
 			break;
-		case AIS::KEY_LAT:
-			loc_lat = p.Get().getFloat();
-			break;
-		case AIS::KEY_LON:
-			loc_lon = p.Get().getFloat();
-			break;
 		case AIS::KEY_TEXT:
 		{
 			// getText trims the '@'/space padding, so a pure-padding broadcast is
@@ -834,21 +948,16 @@ void DB::processBinaryMessage(const JSON::JSON &data)
 	const bool is_stored_type = is_text || (dac == 1 && fi == 31) || (dac == 200 && fi == 55);
 	if (is_stored_type && has_content)
 	{
-		BinaryMessage &binmsg = binary_messages[binary_msg_index];
-		binmsg.Clear();
-		binmsg.type = type;
-		binmsg.dac = dac;
-		binmsg.fi = fi;
-		binmsg.json.clear();
-		builder.stringify(data, binmsg.json);
-		binmsg.used = true;
-		if (isValidCoord(loc_lat, loc_lon))
-		{
-			binmsg.lat = loc_lat;
-			binmsg.lon = loc_lon;
-		}
-		binmsg.timestamp = msg->getRxTimeUnix();
-		binary_msg_index = (binary_msg_index + 1) % MAX_BINARY_MESSAGES;
+		std::string json;
+		builder.stringify(data, json);
+
+		// the record binmsgs.json has always listed, so it is written as stored
+		const std::time_t timestamp = msg->getRxTimeUnix();
+		std::string record;
+		JSON::Writer w(record);
+		w.beginObject().kv("type", type).kv("dac", dac).kv("fi", fi).kv("timestamp", timestamp).kv_raw("message", json).endObject();
+		w.finish();
+		events.add(msg->mmsi(), (uint32_t)timestamp, EventLog::BINARY, std::move(record));
 	}
 }
 
@@ -862,25 +971,52 @@ std::string DB::getBinaryMessagesJSON(std::time_t since)
 
 		w.beginObject().kv("time", now).kv("timeout", time_history).key("messages").beginArray();
 
-		int startIndex = (binary_msg_index + MAX_BINARY_MESSAGES - 1) % MAX_BINARY_MESSAGES;
+		int left = MAX_BINARY_MESSAGES;
+		events.forEachNewest([&](const EventLog::Event &e) {
+			if ((long int)now - (long int)e.time > time_history || (since > 0 && (std::time_t)e.time < since))
+				return false;
 
-		for (int i = 0; i < MAX_BINARY_MESSAGES; i++)
-		{
-			int idx = (startIndex - i + MAX_BINARY_MESSAGES) % MAX_BINARY_MESSAGES;
-			const BinaryMessage &msg = binary_messages[idx];
-
-			if (!msg.used)
-				continue;
+			if (e.kind == EventLog::BINARY)
+			{
+				w.raw_val(e.data);
+				left--;
+			}
+			return left > 0;
+		});
+		w.endArray().endObject();
+	}
+	return content;
+}
 
-			if ((long int)now - (long int)msg.timestamp > time_history)
-				break;
+// Events from `cursor` on, oldest first; `cursor` in the reply is what the next
+// poll sends. `first` above the cursor asked for means events were dropped
+// before the caller saw them. `kind` 0 selects every kind.
+std::string DB::getEventsJSON(uint64_t cursor, std::size_t max, int kind)
+{
+	std::lock_guard<std::mutex> lock(mtx);
 
-			if (since > 0 && msg.timestamp < since)
-				break;
+	content.clear();
+	{
+		JSON::Writer w(content, 16384);
+
+		const uint64_t first = events.first();
+		w.beginObject().kv("time", time(nullptr)).kv("first", (unsigned long long)first).key("events").beginArray();
+
+		uint64_t next = events.forEachFrom(cursor, max, [&](const EventLog::Event &e) {
+			if (kind && e.kind != kind)
+				return false;
+
+			w.beginObject()
+				.kv("seq", (unsigned long long)e.seq)
+				.kv("t", e.time)
+				.kv("mmsi", e.mmsi)
+				.kv("kind", EventLog::kindName(e.kind))
+				.kv_raw("data", e.data)
+				.endObject();
+			return true;
+		});
 
-			w.beginObject().kv("type", msg.type).kv("dac", msg.dac).kv("fi", msg.fi).kv("timestamp", msg.timestamp).kv_raw("message", msg.json).endObject();
-		}
-		w.endArray().endObject();
+		w.endArray().kv("cursor", (unsigned long long)next).kv("gap", cursor > 0 && cursor < first).endObject().raw("\n\n");
 	}
 	return content;
 }
@@ -34,33 +34,14 @@
 #include "Ships.h"
 #include "SlotTable.h"
 #include "PathStore.h"
+#include "TrackArchive.h"
 #include "StaticHistory.h"
+#include "EventLog.h"
 
 class DB : public StreamIn<JSON::JSON>,
 		   public StreamIn<AIS::GPS>,
 		   public StreamOut<JSON::JSON>
 {
-	struct BinaryMessage
-	{
-		std::string json;
-		int type;
-		int dac;
-		int fi;
-		FLOAT32 lat, lon;
-		time_t timestamp = 0;
-		bool used;
-
-		BinaryMessage() { Clear(); }
-
-		void Clear()
-		{
-			used = false;
-			type = dac = fi = -1;
-			lat = LAT_UNDEFINED;
-			lon = LON_UNDEFINED;
-		};
-	};
-
 	JSON::Serializer builder{JSON_DICT_FULL};
 
 	std::string content;
@@ -89,6 +70,12 @@ class DB : public StreamIn<JSON::JSON>,
 	SlotTable<Ship, uint32_t> ships;
 	PathStore paths;
 	StaticHistory changes;
+	// changes and binary messages for cursor polling
+	EventLog events;
+	int events_max = 4096, events_kb = 1024;
+	// history evicted from `paths`, when a track directory is set
+	TrackArchive archive;
+	std::string track_dir;
 
 	std::mutex mtx;
 
@@ -114,15 +101,17 @@ class DB : public StreamIn<JSON::JSON>,
 		});
 	}
 
-	void writeSinglePathJSONCompact(int ptr, JSON::Writer &w, std::time_t since = 0, std::time_t until = 0);
+	void writeSinglePathJSONCompact(int ptr, JSON::Writer &w, std::time_t since = 0, std::time_t until = 0, const std::vector<PathStore::Point> *older = nullptr);
 	void writeSinglePathGeoJSON(int ptr, JSON::Writer &w, std::time_t floor);
+	void writeArchivedPaths(JSON::Writer &w, TrackArchive::Tracks &disk, std::time_t since, std::time_t until, std::time_t from);
 
 	// Oldest time any path data is served: the track_time cap, never reaching
-	// past the eviction horizon into scenes that are missing recycled vessels.
-	std::time_t pathFloor(std::time_t now) const
+	// past the eviction horizon into scenes that are missing recycled vessels,
+	// unless their history went to the archive.
+	std::time_t pathFloor(std::time_t now)
 	{
 		std::time_t cutoff = track_time > 0 && now > track_time ? now - track_time : 0;
-		return MAX(cutoff, evict_horizon);
+		return archive.isOpen() ? cutoff : MAX(cutoff, evict_horizon);
 	}
 
 	// Shared scaffolding for the replay endpoints: eligibility reaches back by
@@ -130,9 +119,16 @@ class DB : public StreamIn<JSON::JSON>,
 	// window still shows for as long as the viewer keeps it on the map, and
 	// `emit` writes the per-ship value. The window start is clamped here, under
 	// the lock that guards the horizon it is clamped to, and handed to `emit`;
-	// `until` is the window end, 0 for an unbounded one.
-	template <typename F>
-	std::string getReplayObjectJSON(std::time_t since, std::time_t lookback, std::time_t until, F emit)
+	// `until` is the window end, 0 for an unbounded one. `rest`, if given,
+	// follows the ships in memory with any further members, given the clamped
+	// window.
+	struct NoRest
+	{
+		void operator()(JSON::Writer &, std::time_t, std::time_t) const {}
+	};
+
+	template <typename F, typename G = NoRest>
+	std::string getReplayObjectJSON(std::time_t since, std::time_t lookback, std::time_t until, F emit, G rest = G())
 	{
 		std::lock_guard<std::mutex> lock(mtx);
 
@@ -154,6 +150,7 @@ class DB : public StreamIn<JSON::JSON>,
 					if (paths.hasSince(ptr, from))
 						emit(w, ptr, ship, since);
 				});
+				rest(w, since, from);
 			}
 			w.endObject().raw("\n\n");
 		}
@@ -162,11 +159,12 @@ class DB : public StreamIn<JSON::JSON>,
 
 	AIS::Filter filter;
 
+	// the newest binary messages listed by getBinaryMessagesJSON
 	static const int MAX_BINARY_MESSAGES = 10;
-	BinaryMessage binary_messages[MAX_BINARY_MESSAGES];
-	int binary_msg_index = 0;
 
 	void processBinaryMessage(const JSON::JSON &data);
+	void logNumericChange(const Ship &ship, StaticHistory::Field field, uint8_t from, uint8_t to, bool initial = false);
+	void logText(const Ship &ship, StaticHistory::Field field, const char *value);
 #ifdef CHECK_DB_INTEGRITY
 	void checkIntegrity();
 	std::time_t last_check = 0;
@@ -176,9 +174,14 @@ public:
 	void setup();
 	void tick(std::time_t now);
 	void setTimeHistory(int t) { time_history = t; }
-	void setTrackTime(int t) { track_time = t; }
+	void setTrackTime(int t)
+	{
+		track_time = t;
+		archive.setKeep(t);
+	}
 	void setExpireFields(bool b) { expire_fields = b; }
 	void setTrackMemory(int kb) { if (kb > 0) track_memory_kb = kb; }
+	void setTrackDir(const std::string &dir);
 	void setShareLatLon(bool b) { latlon_share = b; }
 	bool getShareLatLon() { return latlon_share; }
 
@@ -205,6 +208,9 @@ public:
 
 	void setOwnMMSI(uint32_t mmsi) { own_mmsi = mmsi; }
 
+	// the JSON fields updateFields() reads, plus 6 and 8 in full for the binary messages
+	static AIS::KeySet jsonKeys();
+
 	using StreamIn<JSON::JSON>::Receive;
 	using StreamIn<AIS::GPS>::Receive;
 
@@ -247,6 +253,8 @@ public:
 	void setFilter(const AIS::Filter &f) { filter = f; }
 
 	std::string getBinaryMessagesJSON(std::time_t since = 0);
+	std::string getEventsJSON(uint64_t cursor, std::size_t max, int kind);
+	void setEventLimits(int entries, int kb);
 
 	// Persistence functions for ship database
 	bool Save(std::ofstream &file);
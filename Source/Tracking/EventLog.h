@@ -0,0 +1,123 @@
+/*
+	Copyright(c) 2021-2026 jvde.github@gmail.com
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <string>
+
+// What happened to vessels, in arrival order: static changes, status flips and
+// the binary messages worth listing, each serialised once when it is logged.
+// Every event takes the next sequence number, so a poller hands back the cursor
+// it was given and is sent exactly what is new; the oldest events go once the
+// log is over its entry or byte budget.
+class EventLog
+{
+public:
+	enum Kind : uint8_t
+	{
+		CHANGE = 1,
+		BINARY = 2
+	};
+
+	struct Event
+	{
+		uint64_t seq;
+		uint32_t time;
+		uint32_t mmsi;
+		Kind kind;
+		std::string data; // a JSON value
+	};
+
+	static const char *kindName(Kind k) { return k == BINARY ? "binary" : "change"; }
+
+	// a budget of 0 lifts that limit; at least one event is always kept
+	void setLimits(std::size_t entries, std::size_t bytes)
+	{
+		max_entries = entries;
+		max_bytes = bytes;
+		trim();
+	}
+
+	// sequence numbers carry on, so a cursor from before reads as a gap
+	void clear()
+	{
+		events.clear();
+		bytes = 0;
+	}
+
+	uint64_t add(uint32_t mmsi, uint32_t time, Kind kind, std::string data)
+	{
+		events.push_back({next_seq, time, mmsi, kind, std::move(data)});
+		bytes += cost(events.back());
+		trim();
+		return next_seq++;
+	}
+
+	// oldest sequence number held, and the one the next event gets
+	uint64_t first() const { return events.empty() ? next_seq : events.front().seq; }
+	uint64_t next() const { return next_seq; }
+
+	// Events from `cursor` on, oldest first, at most `max`. Sequence numbers are
+	// contiguous, so the start is found by subtraction rather than a search.
+	// A cursor past the end is one from an earlier run and starts over.
+	template <typename F>
+	uint64_t forEachFrom(uint64_t cursor, std::size_t max, F f) const
+	{
+		if (cursor > next_seq || cursor < first())
+			cursor = first();
+
+		std::size_t i = (std::size_t)(cursor - first());
+		for (; i < events.size() && max; i++)
+		{
+			if (f(events[i]))
+				max--;
+		}
+		return i < events.size() ? events[i].seq : next_seq;
+	}
+
+	// Newest first until `f` returns false.
+	template <typename F>
+	void forEachNewest(F f) const
+	{
+		for (auto it = events.rbegin(); it != events.rend(); ++it)
+			if (!f(*it))
+				return;
+	}
+
+private:
+	// the deque node and string header an event costs beyond its text
+	static const std::size_t OVERHEAD = sizeof(Event) + 16;
+
+	std::deque<Event> events;
+	std::size_t bytes = 0;
+	std::size_t max_entries = 4096;
+	std::size_t max_bytes = 1024 * 1024;
+	uint64_t next_seq = 1;
+
+	static std::size_t cost(const Event &e) { return OVERHEAD + e.data.size(); }
+
+	void trim()
+	{
+		while (events.size() > 1 && ((max_entries && events.size() > max_entries) || (max_bytes && bytes > max_bytes)))
+		{
+			bytes -= cost(events.front());
+			events.pop_front();
+		}
+	}
+};
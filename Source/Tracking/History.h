@@ -20,24 +20,44 @@
 #include <fstream>
 #include <string.h>
 #include <memory>
+#include <atomic>
 
 #include "Statistics.h"
 #include "Writer.h"
 
+// Receive() only takes the lock to open a new interval, once per INTERVAL;
+// otherwise it adds to the current slot lock-free. The lock orders the ring
+// rotation with Clear(), Load() and the readers.
 template <int N, int INTERVAL>
 class History : public StreamIn<JSON::JSON> {
 	std::mutex mtx;
 
 	struct {
-		long int time = {};
+		std::atomic<long int> time{ 0 };
 		MessageStatistics stat;
 	} history[N];
 
-	int start, end;
+	int start;
+	std::atomic<int> end{ 0 };
 
-	void create(long int t) {
-		history[end].time = t;
-		history[end].stat.Clear();
+	// caller holds mtx; the slot is filled before it is published as the end
+	void create(int idx, long int t) {
+		history[idx].stat.Clear();
+		history[idx].time.store(t, std::memory_order_relaxed);
+		end.store(idx, std::memory_order_release);
+	}
+
+	// a message for a later interval than the current slot
+	int rotate(long int tm) {
+		std::lock_guard<std::mutex> l{ this->mtx };
+
+		int e = end.load(std::memory_order_relaxed);
+		if (history[e].time.load(std::memory_order_relaxed) < tm) {
+			e = (e + 1) % N;
+			if (start == e) start = (start + 1) % N;
+			create(e, tm);
+		}
+		return e;
 	}
 
 	bool readInteger(std::ifstream& file, int& dest, int check = -1) {
@@ -60,13 +80,11 @@ public:
 	void Clear() {
 		std::lock_guard<std::mutex> l{ this->mtx };
 
-		start = end = 0;
-		create((long int)time(nullptr) / (long int)INTERVAL);
+		start = 0;
+		create(0, (long int)time(nullptr) / (long int)INTERVAL);
 	}
 
 	void Receive(const JSON::JSON* j, int len, TAG& tag) {
-		std::lock_guard<std::mutex> l{ this->mtx };
-
 		for (int i = 0; i < len; i++) {
 			if (!j[i].binary) return;
 
@@ -74,13 +92,11 @@ public:
 			long int tm = ((long int)msg->getRxTimeUnix()) / (long int)INTERVAL;
 			long int tp = ((long int)tag.previous_signal) / (long int)INTERVAL;
 
-			if (history[end].time < tm) {
-				end = (end + 1) % N;
-				create(tm);
-				if (start == end) start = (start + 1) % N;
-			}
+			int e = end.load(std::memory_order_acquire);
+			if (history[e].time.load(std::memory_order_relaxed) < tm)
+				e = rotate(tm);
 
-			history[end].stat.Add(*msg, tag, tm != tp);
+			history[e].stat.Add(*msg, tag, tm != tp);
 		}
 	}
 
@@ -92,6 +108,7 @@ public:
 		int i = INTERVAL;
 		int n = N;
 		int s = sizeof(history);
+		int e = end.load(std::memory_order_relaxed);
 
 		file.write((const char*)&magic, sizeof(int));
 		file.write((const char*)&version, sizeof(int));
@@ -99,10 +116,11 @@ public:
 		file.write((const char*)&i, sizeof(int));
 		file.write((const char*)&n, sizeof(int));
 		file.write((const char*)&start, sizeof(int));
-		file.write((const char*)&end, sizeof(int));
+		file.write((const char*)&e, sizeof(int));
 
 		for (int i = 0; i < N; i++) {
-			file.write((const char*)&history[i].time, sizeof(history[i].time));
+			long int t = history[i].time.load(std::memory_order_relaxed);
+			file.write((const char*)&t, sizeof(t));
 			history[i].stat.Save(file);
 		}
 
@@ -123,15 +141,17 @@ public:
 		if (start_in < 0 || start_in >= N || end_in < 0 || end_in >= N) return false;
 
 		start = start_in;
-		end = end_in;
+		end.store(end_in, std::memory_order_release);
 
 		for (int i = 0; i < N; i++) {
-			if (!file.read((char*)&history[i].time, sizeof(history[i].time))) return false;
+			long int t;
+			if (!file.read((char*)&t, sizeof(t))) return false;
+			history[i].time.store(t, std::memory_order_relaxed);
 			if (!history[i].stat.Load(file)) return false;
 		}
 
 		// as database is not persistent we cannot combine old and new
-		history[end].stat.clearVessels();
+		history[end_in].stat.clearVessels();
 		return true;
 	}
 
@@ -16,25 +16,34 @@
 */
 
 #pragma once
+#include <algorithm>
 #include <cstdint>
 #include <cstdlib>
+#include <cstring>
 #include <cmath>
 #include <ctime>
 #include <string>
 #include <vector>
 #include <deque>
+#include <functional>
 
 #include "Geodesy.h"
 
-// Tiered block store for ship tracks. Points live in blocks and form a
-// doubly-linked, time-ordered list per ship, circular through a per-ship
-// anchor: a reference packs (block << BLOCK_SHIFT | slot) in a uint32_t, the
-// top bit marks a ship anchor, prev == NIL marks a dead slot. A point covers
-// [time, time + dur]: a stationary ship extends its newest point's dwell
-// instead of adding points. Blocks chain into three tiers (head = newest): RT
-// holds full resolution for roughly the last hour, HIST older history thinned
-// to one point per GRANULARITY, FREE recycled blocks. Under memory pressure
-// young RT blocks are force-compacted first, then the oldest HIST history is
+// Tiered block store for ship tracks. Blocks chain into three tiers (head =
+// newest): RT holds full resolution for roughly the last hour, HIST older
+// history thinned to one point per GRANULARITY, FREE recycled blocks.
+//
+// RT points form a doubly-linked, time-ordered list per ship, circular
+// through a per-ship anchor: a reference packs (block << BLOCK_SHIFT | slot)
+// in a uint32_t, the top bit marks a ship anchor, prev == NIL marks a dead
+// slot. A point covers [time, time + dur]: a stationary ship extends its
+// newest point's dwell instead of adding points.
+//
+// A HIST block is cut into slabs. A slab belongs to one ship, which appends
+// its points to it delta and varint coded until it is full and then opens a
+// new one; a ship's slabs are linked oldest to newest ahead of its RT list
+// and decoded on the fly while a track is walked. Under memory pressure young
+// RT blocks are force-compacted first, then the oldest HIST history is
 // overwritten.
 
 class PathStore
@@ -54,6 +63,9 @@ public:
 
 	static const uint16_t NA = 0xFFFF;
 
+	// receives history about to leave memory, oldest point first
+	typedef std::function<void(int ship, const Point *pts, int n)> Spill;
+
 	// silence that ends a dwell, and so how long a point's end can still grow
 	static const uint32_t DWELL_GAP = 900;
 
@@ -71,6 +83,14 @@ private:
 	static const int DEADBAND = 40;			 // meters a ship must move to count as significant
 	static const uint16_t IDLE_SOG = 5;		 // 0.1 knot units, at or below this a ship is not making way
 
+	// a slab pays a 20 byte header, smaller ones waste more on ships heard briefly
+	static const int SLAB_BYTES = 128;
+	// a point codes to at least 7 bytes
+	static const int SLAB_POINTS = 16;
+	static const int MAX_POINT_BYTES = 30;
+	// HIST positions in 1/10000 minute, the resolution AIS reports in
+	static const int COORD_SCALE = 600000;
+
 	enum Tier
 	{
 		RT = 0,
@@ -78,6 +98,7 @@ private:
 		FREE = 2
 	};
 
+	// in a HIST block `count` is the slabs handed out and `live` those not wiped
 	struct Block
 	{
 		Point pts[BLOCK_SIZE];
@@ -85,14 +106,44 @@ private:
 		uint16_t count = 0, live = 0;
 	};
 
+	// a slab reference is block * SLABS + index
+	static const int SLABS = (int)sizeof(Point) * BLOCK_SIZE / SLAB_BYTES;
+
+	// stored unaligned in front of its coded points
+	struct Slab
+	{
+		uint32_t ship;		 // NIL once wiped
+		uint32_t prev, next; // the ship's older and newer slab
+		uint32_t first;		 // time of the first point
+		uint16_t last_dur;	 // the newest point's dwell can still grow, so it is not coded yet
+		uint8_t count;
+		uint8_t bytes; // coded points following the header
+	};
+
+	// running values the next point is coded against
+	struct Coder
+	{
+		uint32_t t;
+		int32_t lat, lon, cog, hdg, sog;
+	};
+
 	struct List
 	{
 		int head = -1, tail = -1;
 	};
 
+	// head/tail is the RT list, hist_head/hist_tail the slab list
 	struct Anchor
 	{
 		uint32_t head, tail;
+		uint32_t hist_head, hist_tail;
+	};
+
+	struct Pending
+	{
+		int ship;
+		bool newest;
+		Point p;
 	};
 
 	// deque, not vector: growth must not move a Block, deref() hands out Point&.
@@ -101,11 +152,101 @@ private:
 	int block_cap = 0;
 	List lists[3];
 
+	std::vector<Pending> pending; // compaction scratch, kept to avoid reallocating
+	Spill spill;
+
 	static uint32_t ref(int b, int i) { return ((uint32_t)b << BLOCK_SHIFT) | i; }
 	static int blockOf(uint32_t r) { return (int)(r >> BLOCK_SHIFT); }
 	static int slotOf(uint32_t r) { return (int)(r & (BLOCK_SIZE - 1)); }
 
 	Point &deref(uint32_t r) { return const_cast<Point &>(at(r)); }
+	const Point &at(uint32_t r) const { return blocks[blockOf(r)].pts[slotOf(r)]; }
+	static bool isPoint(uint32_t r) { return !(r & SHIP_BIT); }
+
+	uint8_t *slabData(uint32_t s) { return (uint8_t *)blocks[s / SLABS].pts + (s % SLABS) * SLAB_BYTES; }
+	const uint8_t *slabData(uint32_t s) const { return (const uint8_t *)blocks[s / SLABS].pts + (s % SLABS) * SLAB_BYTES; }
+
+	Slab slab(uint32_t s) const
+	{
+		Slab h;
+		std::memcpy(&h, slabData(s), sizeof(h));
+		return h;
+	}
+
+	void putSlab(uint32_t s, const Slab &h) { std::memcpy(slabData(s), &h, sizeof(h)); }
+
+	static void putVarint(uint8_t *&p, uint32_t v)
+	{
+		while (v >= 0x80)
+		{
+			*p++ = (uint8_t)(v | 0x80);
+			v >>= 7;
+		}
+		*p++ = (uint8_t)v;
+	}
+
+	static uint32_t getVarint(const uint8_t *&p)
+	{
+		uint32_t v = 0;
+		for (int shift = 0;; shift += 7)
+		{
+			uint8_t b = *p++;
+			v |= (uint32_t)(b & 0x7F) << shift;
+			if (!(b & 0x80))
+				return v;
+		}
+	}
+
+	static uint32_t zigzag(int32_t v) { return ((uint32_t)v << 1) ^ (uint32_t)(v >> 31); }
+	static int32_t unzigzag(uint32_t v) { return (int32_t)(v >> 1) ^ -(int32_t)(v & 1); }
+
+	// NA codes as 0 so unknown fields delta to nothing
+	static int32_t field(uint16_t v) { return v == NA ? 0 : (int32_t)v + 1; }
+	static uint16_t unfield(int32_t v) { return v == 0 ? NA : (uint16_t)(v - 1); }
+
+	// a point is coded as the dwell of the point before it (none for the first
+	// in a slab), then time, lat, lon, cog, hdg and sog as deltas to that point
+	static int encode(const Point &q, Coder &c, bool first, uint16_t prev_dur, uint8_t *out)
+	{
+		uint8_t *p = out;
+		int32_t lat = (int32_t)std::lround(q.lat * (double)COORD_SCALE);
+		int32_t lon = (int32_t)std::lround(q.lon * (double)COORD_SCALE);
+
+		if (!first)
+			putVarint(p, prev_dur);
+		putVarint(p, q.time - c.t);
+		putVarint(p, zigzag(lat - c.lat));
+		putVarint(p, zigzag(lon - c.lon));
+		putVarint(p, zigzag(field(q.cog) - c.cog));
+		putVarint(p, zigzag(field(q.hdg) - c.hdg));
+		putVarint(p, zigzag(field(q.sog) - c.sog));
+
+		c = {q.time, lat, lon, field(q.cog), field(q.hdg), field(q.sog)};
+		return (int)(p - out);
+	}
+
+	int decode(uint32_t s, const Slab &h, Point *out, Coder *state = nullptr) const
+	{
+		const uint8_t *p = slabData(s) + sizeof(Slab);
+		Coder c = {h.first, 0, 0, 0, 0, 0};
+
+		for (int k = 0; k < h.count; k++)
+		{
+			if (k > 0)
+				out[k - 1].dur = (uint16_t)getVarint(p);
+			c.t += getVarint(p);
+			c.lat += unzigzag(getVarint(p));
+			c.lon += unzigzag(getVarint(p));
+			c.cog += unzigzag(getVarint(p));
+			c.hdg += unzigzag(getVarint(p));
+			c.sog += unzigzag(getVarint(p));
+
+			out[k] = {(float)(c.lat / (double)COORD_SCALE), (float)(c.lon / (double)COORD_SCALE), c.t, NIL, NIL, h.last_dur, unfield(c.cog), unfield(c.hdg), unfield(c.sog)};
+		}
+		if (state)
+			*state = c;
+		return h.count;
+	}
 
 	void setNext(uint32_t r, uint32_t v)
 	{
@@ -183,66 +324,189 @@ private:
 		return b;
 	}
 
-	// only ever called on the HIST tail
+	// only ever called on the HIST tail: slabs are handed out oldest first,
+	// so each live one is still the oldest of its ship
 	int evictBlock(int b)
 	{
 		Block &blk = blocks[b];
+		Point buf[SLAB_POINTS];
+
 		for (int i = 0; i < blk.count; i++)
-			if (blk.pts[i].prev != NIL)
-				unlink(ref(b, i));
+		{
+			uint32_t s = (uint32_t)b * SLABS + i;
+			Slab h = slab(s);
+			if (h.ship == NIL)
+				continue;
+
+			if (spill)
+				spill((int)h.ship, buf, decode(s, h, buf));
+
+			Anchor &a = anchors[h.ship];
+			a.hist_head = h.next;
+			if (h.next != NIL)
+			{
+				Slab n = slab(h.next);
+				n.prev = NIL;
+				putSlab(h.next, n);
+			}
+			else
+				a.hist_tail = NIL;
+		}
 		detachBlock(HIST, b);
 		blk.count = blk.live = 0;
 		return b;
 	}
 
-	void moveToHistory(uint32_t r)
+	uint32_t allocSlab()
 	{
 		int d = lists[HIST].head;
-
-		if (d == -1 || blocks[d].count == BLOCK_SIZE)
+		if (d == -1 || blocks[d].count == SLABS)
 		{
 			d = popFreeBlock();
 			if (d == -1 && lists[HIST].tail != -1)
 				d = evictBlock(lists[HIST].tail);
 
 			if (d == -1)
+				return NIL;
+			pushBlockHead(HIST, d);
+		}
+
+		blocks[d].live++;
+		return (uint32_t)d * SLABS + blocks[d].count++;
+	}
+
+	// appends to the ship's newest slab while it has room
+	void appendHistory(int ship, const Point *pts, int n)
+	{
+		Point buf[SLAB_POINTS];
+		uint8_t coded[MAX_POINT_BYTES];
+		Coder c;
+
+		uint32_t s = anchors[ship].hist_tail;
+		Slab h;
+		if (s != NIL)
+		{
+			h = slab(s);
+			decode(s, h, buf, &c);
+		}
+
+		for (int k = 0; k < n; k++)
+		{
+			const Point &q = pts[k];
+
+			if (s != NIL && h.count < SLAB_POINTS)
 			{
-				unlink(r);
+				Coder next = c;
+				int len = encode(q, next, false, h.last_dur, coded);
+
+				if (sizeof(Slab) + h.bytes + len <= (size_t)SLAB_BYTES)
+				{
+					std::memcpy(slabData(s) + sizeof(Slab) + h.bytes, coded, len);
+					h.count++;
+					h.bytes += (uint8_t)len;
+					h.last_dur = q.dur;
+					putSlab(s, h);
+					c = next;
+					continue;
+				}
+			}
+
+			s = allocSlab();
+			if (s == NIL)
 				return;
+
+			// the allocation above may have evicted this ship's older slabs
+			Anchor &a = anchors[ship];
+
+			c = {q.time, 0, 0, 0, 0, 0};
+			int len = encode(q, c, true, 0, coded);
+
+			h.ship = (uint32_t)ship;
+			h.prev = a.hist_tail;
+			h.next = NIL;
+			h.first = q.time;
+			h.last_dur = q.dur;
+			h.count = 1;
+			h.bytes = (uint8_t)len;
+
+			putSlab(s, h);
+			std::memcpy(slabData(s) + sizeof(Slab), coded, len);
+
+			if (a.hist_tail != NIL)
+			{
+				Slab p = slab(a.hist_tail);
+				p.next = s;
+				putSlab(a.hist_tail, p);
 			}
-			pushBlockHead(HIST, d);
+			else
+				a.hist_head = s;
+			a.hist_tail = s;
 		}
+	}
 
-		// the eviction above may have respliced this point's neighbours
-		Point &p = deref(r);
-		Block &dst = blocks[d];
-		int j = dst.count++;
-		dst.live++;
-
-		uint32_t nr = ref(d, j);
-		dst.pts[j] = p;
-		setNext(p.prev, nr);
-		setPrev(p.next, nr);
+	// the ship's newest HIST point, false without one
+	bool lastHistory(int ship, Point &last) const
+	{
+		uint32_t s = anchors[ship].hist_tail;
+		if (s == NIL)
+			return false;
+
+		Point buf[SLAB_POINTS];
+		last = buf[decode(s, slab(s), buf) - 1];
+		return true;
 	}
 
 	void compactBlock(int b)
 	{
 		Block &blk = blocks[b];
+
+		pending.clear();
 		for (int i = 0; i < blk.count; i++)
 		{
 			Point &p = blk.pts[i];
 			if (p.prev == NIL)
 				continue;
-			// prev is the last kept point of this ship since drops unlink as we go;
-			// a ship's newest point always survives, its dwell may still be extending
-			if ((p.next & SHIP_BIT) || (p.prev & SHIP_BIT) || p.time - deref(p.prev).time >= GRANULARITY)
-				moveToHistory(ref(b, i));
-			else
-				unlink(ref(b, i));
+			// this is the oldest RT block and slots are in time order, so every
+			// live point is the head of its ship's RT list once those before it unlinked
+			pending.push_back({(int)(p.prev & ~SHIP_BIT), (p.next & SHIP_BIT) != 0, p});
+			unlink(ref(b, i));
 		}
 		detachBlock(RT, b);
 		blk.count = blk.live = 0;
 		pushBlockHead(FREE, b);
+
+		// runs per ship, each still in time order
+		std::stable_sort(pending.begin(), pending.end(), [](const Pending &x, const Pending &y) { return x.ship < y.ship; });
+
+		Point run[SLAB_POINTS];
+		for (size_t k = 0; k < pending.size();)
+		{
+			int ship = pending[k].ship;
+			Point q;
+			bool has = lastHistory(ship, q);
+			uint32_t last = has ? q.time : 0;
+			int n = 0;
+
+			for (; k < pending.size() && pending[k].ship == ship; k++)
+			{
+				const Point &p = pending[k].p;
+				// a ship's newest point always survives, its dwell may still be extending
+				if (!pending[k].newest && has && p.time - last < GRANULARITY)
+					continue;
+
+				run[n++] = p;
+				last = p.time;
+				has = true;
+
+				if (n == SLAB_POINTS)
+				{
+					appendHistory(ship, run, n);
+					n = 0;
+				}
+			}
+			if (n)
+				appendHistory(ship, run, n);
+		}
 	}
 
 	uint32_t newestTime(int b) { return blocks[b].pts[blocks[b].count - 1].time; }
@@ -259,14 +523,11 @@ private:
 	{
 		int b = popFreeBlock();
 
-		if (b == -1 && lists[RT].tail != lists[RT].head)
+		// thinning a young block into HIST beats overwriting history; the block
+		// freed can go to HIST itself, hence a second pass
+		for (int k = 0; k < 2 && b == -1 && lists[RT].tail != lists[RT].head; k++)
 		{
-			// thinning a young block into HIST beats overwriting history
 			compactBlock(lists[RT].tail);
-			// a second pass lets the block just freed seed an empty HIST tier
-			if (lists[HIST].head == -1 && lists[RT].tail != lists[RT].head)
-				compactBlock(lists[RT].tail);
-
 			b = popFreeBlock();
 		}
 
@@ -327,7 +588,10 @@ public:
 		anchors.resize(nships);
 
 		for (int i = 0; i < nships; i++)
+		{
 			anchors[i].head = anchors[i].tail = SHIP_BIT | i;
+			anchors[i].hist_head = anchors[i].hist_tail = NIL;
+		}
 
 		lists[RT] = lists[HIST] = lists[FREE] = List();
 
@@ -340,17 +604,31 @@ public:
 		uint32_t t = now > 0 ? (uint32_t)now : 0;
 		uint16_t c = encodeCOG(cog), h = encodeHDG(heading), s = encodeSOG(sog);
 
-		if (isPoint(anchors[ship].tail))
+		Anchor &a = anchors[ship];
+		Point last;
+		Point *q = nullptr;
+
+		if (isPoint(a.tail))
+			q = &deref(a.tail);
+		else if (lastHistory(ship, last))
+			q = &last; // quiet long enough for all its points to be compacted
+
+		if (q)
 		{
-			Point &q = deref(anchors[ship].tail);
-			uint32_t qe = q.end();
+			uint32_t qe = q->end();
 			if (t < qe)
 				t = qe; // time cannot run backwards within a track
 
 			// stationary and continuous: extend the dwell of the newest point
-			if (t - qe <= DWELL_GAP && t - q.time < DWELL_MAX && !significant(q, lat, lon, c, s, idle_band))
+			if (t - qe <= DWELL_GAP && t - q->time < DWELL_MAX && !significant(*q, lat, lon, c, s, idle_band))
 			{
-				q.dur = (uint16_t)(t - q.time);
+				q->dur = (uint16_t)(t - q->time);
+				if (!isPoint(a.tail))
+				{
+					Slab hs = slab(a.hist_tail);
+					hs.last_dur = q->dur;
+					putSlab(a.hist_tail, hs);
+				}
 				return;
 			}
 		}
@@ -380,26 +658,140 @@ public:
 		anchors[ship].tail = r;
 	}
 
+	void setSpill(const Spill &s) { spill = s; }
+
 	void wipe(int ship)
 	{
+		Anchor &a = anchors[ship];
+
+		if (spill)
+		{
+			Point buf[SLAB_POINTS];
+			for (uint32_t s = a.hist_head; s != NIL; s = slab(s).next)
+				spill(ship, buf, decode(s, slab(s), buf));
+
+			std::vector<Point> rt;
+			for (uint32_t r = a.head; isPoint(r); r = at(r).next)
+				rt.push_back(at(r));
+			if (!rt.empty())
+				spill(ship, rt.data(), (int)rt.size());
+		}
+
 		// unlinking the head advances the anchor until it is self-referential
-		while (isPoint(anchors[ship].head))
-			unlink(anchors[ship].head);
+		while (isPoint(a.head))
+			unlink(a.head);
+
+		// the slabs stay handed out until their block is evicted
+		for (uint32_t s = a.hist_head; s != NIL;)
+		{
+			Slab h = slab(s);
+			h.ship = NIL;
+			putSlab(s, h);
+			blocks[s / SLABS].live--;
+			s = h.next;
+		}
+		a.hist_head = a.hist_tail = NIL;
 	}
 
-	// newest-first traversal: for (r = tail(ship); isPoint(r); r = at(r).prev)
-	uint32_t tail(int ship) const { return anchors[ship].tail; }
-	// a chain is time-ordered, so head is the ship's oldest surviving point
-	uint32_t head(int ship) const { return anchors[ship].head; }
-	static bool isPoint(uint32_t r) { return !(r & SHIP_BIT); }
-	const Point &at(uint32_t r) const { return blocks[blockOf(r)].pts[slotOf(r)]; }
+	// A run of points, oldest first, in the slab coding behind its count,
+	// first time and final dwell; the disk tier stores history this way.
+	static void encodeRun(const Point *pts, int n, std::string &out)
+	{
+		uint8_t coded[MAX_POINT_BYTES];
+		uint8_t *p = coded;
+		putVarint(p, (uint32_t)n);
+		putVarint(p, pts[0].time);
+		out.append((const char *)coded, p - coded);
+
+		Coder c = {pts[0].time, 0, 0, 0, 0, 0};
+		for (int k = 0; k < n; k++)
+			out.append((const char *)coded, encode(pts[k], c, k == 0, k ? pts[k - 1].dur : 0, coded));
+
+		p = coded;
+		putVarint(p, pts[n - 1].dur);
+		out.append((const char *)coded, p - coded);
+	}
+
+	// appends the run at `p` to `out` oldest first; false once past `end`,
+	// which the caller pads so a corrupt run cannot read beyond its buffer
+	static bool decodeRun(const uint8_t *&p, const uint8_t *end, std::vector<Point> &out)
+	{
+		uint32_t n = getVarint(p);
+		if (n == 0 || n > (uint32_t)(end - p))
+			return false;
+
+		Coder c = {getVarint(p), 0, 0, 0, 0, 0};
+		size_t base = out.size();
+		for (uint32_t k = 0; k < n; k++)
+		{
+			if (k > 0)
+				out.back().dur = (uint16_t)getVarint(p);
+			c.t += getVarint(p);
+			c.lat += unzigzag(getVarint(p));
+			c.lon += unzigzag(getVarint(p));
+			c.cog += unzigzag(getVarint(p));
+			c.hdg += unzigzag(getVarint(p));
+			c.sog += unzigzag(getVarint(p));
+
+			out.push_back({(float)(c.lat / (double)COORD_SCALE), (float)(c.lon / (double)COORD_SCALE), c.t, NIL, NIL, 0, unfield(c.cog), unfield(c.hdg), unfield(c.sog)});
+			if (p > end)
+				break;
+		}
+		out.back().dur = (uint16_t)getVarint(p);
+
+		if (p > end)
+		{
+			out.resize(base);
+			return false;
+		}
+		return true;
+	}
+
+	// Visits a ship's points newest first until `fn` returns false. HIST
+	// points are decoded into a copy, so `fn` must not hold on to them.
+	template <typename F>
+	void walk(int ship, F fn) const
+	{
+		const Anchor &a = anchors[ship];
+
+		for (uint32_t r = a.tail; isPoint(r); r = at(r).prev)
+			if (!fn(at(r)))
+				return;
+
+		Point buf[SLAB_POINTS];
+		for (uint32_t s = a.hist_tail; s != NIL;)
+		{
+			Slab h = slab(s);
+			for (int k = decode(s, h, buf) - 1; k >= 0; k--)
+				if (!fn(buf[k]))
+					return;
+			s = h.prev;
+		}
+	}
+
+	// start of the oldest and end of the newest point; false without points
+	bool span(int ship, uint32_t &first, uint32_t &last) const
+	{
+		const Anchor &a = anchors[ship];
+
+		Point q;
+		if (isPoint(a.tail))
+			last = at(a.tail).end();
+		else if (lastHistory(ship, q))
+			last = q.end();
+		else
+			return false;
+
+		first = a.hist_head != NIL ? slab(a.hist_head).first : at(a.head).time;
+		return true;
+	}
 
 	// only the newest point's dwell can still extend, so an end older than
 	// `since` means nothing newer exists
 	bool hasSince(int ship, std::time_t since) const
 	{
-		uint32_t r = tail(ship);
-		return isPoint(r) && (std::time_t)at(r).end() >= since;
+		uint32_t first, last;
+		return span(ship, first, last) && (std::time_t)last >= since;
 	}
 
 	// Structural invariants. Returns the number of problems found and appends a
@@ -408,7 +800,7 @@ public:
 	{
 		int e = 0;
 		int nblocks = (int)blocks.size();
-		std::vector<int> seen(nblocks, 0);
+		std::vector<int> seen(nblocks, 0), tier(nblocks, -1);
 
 		auto fail = [&](const std::string &msg) {
 			errors.push_back("path store: " + msg);
@@ -425,6 +817,7 @@ public:
 					fail("invalid or repeated block " + std::to_string(b) + " in tier " + std::to_string(t));
 					break;
 				}
+				tier[b] = t;
 				if (blocks[b].prev != prev)
 					fail("block " + std::to_string(b) + " prev mismatch");
 				if (t != FREE && blocks[b].count == 0)
@@ -441,20 +834,70 @@ public:
 				fail("block " + std::to_string(b) + " in " + std::to_string(seen[b]) + " tiers");
 
 			int live = 0;
-			for (int i = 0; i < blocks[b].count; i++)
-				if (blocks[b].pts[i].prev != NIL)
-					live++;
+			if (tier[b] == HIST)
+			{
+				if (blocks[b].count > SLABS)
+					fail("block " + std::to_string(b) + " slab count " + std::to_string(blocks[b].count));
+				for (int i = 0; i < blocks[b].count && i < SLABS; i++)
+					if (slab((uint32_t)b * SLABS + i).ship != NIL)
+						live++;
+			}
+			else
+			{
+				for (int i = 0; i < blocks[b].count; i++)
+					if (blocks[b].pts[i].prev != NIL)
+						live++;
+			}
 			if (live != blocks[b].live)
 				fail("block " + std::to_string(b) + " live " + std::to_string(blocks[b].live) + " != " + std::to_string(live));
 		}
 
+		Point buf[SLAB_POINTS];
 		for (int ship = 0; ship < (int)anchors.size(); ship++)
 		{
 			uint32_t self = SHIP_BIT | ship;
-			uint32_t back = self, r = anchors[ship].head;
 			uint32_t prev_end = 0;
 			long steps = 0;
 
+			uint32_t back = NIL, s = anchors[ship].hist_head;
+			while (s != NIL)
+			{
+				int b = (int)(s / SLABS);
+				if (b >= nblocks || tier[b] != HIST || (int)(s % SLABS) >= blocks[b].count)
+				{
+					fail("ship " + std::to_string(ship) + " bad slab " + std::to_string(s));
+					break;
+				}
+				Slab h = slab(s);
+				if (h.ship != (uint32_t)ship || h.prev != back || h.count == 0 || h.count > SLAB_POINTS ||
+					sizeof(Slab) + h.bytes > (size_t)SLAB_BYTES)
+				{
+					fail("ship " + std::to_string(ship) + " slab chain broken at " + std::to_string(s));
+					break;
+				}
+				int n = decode(s, h, buf);
+				for (int k = 0; k < n; k++)
+				{
+					if (buf[k].time < prev_end)
+						fail("ship " + std::to_string(ship) + " slab " + std::to_string(s) + " out of order");
+					prev_end = buf[k].end();
+				}
+
+				back = s;
+				s = h.next;
+				if (++steps > (long)nblocks * SLABS)
+				{
+					fail("ship " + std::to_string(ship) + " slab chain has cycle");
+					break;
+				}
+			}
+			if (s == NIL && anchors[ship].hist_tail != back)
+				fail("ship " + std::to_string(ship) + " hist tail anchor mismatch");
+
+			back = self;
+			uint32_t r = anchors[ship].head;
+			steps = 0;
+
 			while (r != self)
 			{
 				if (!isPoint(r) || blockOf(r) >= nblocks || slotOf(r) >= blocks[blockOf(r)].count)
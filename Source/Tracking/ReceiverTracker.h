@@ -50,6 +50,11 @@ struct TrackingConfig
 	int cutoff = 0;
 	// kilobytes of track storage; 0 keeps the default
 	int track_memory = 0;
+	// directory receiving history evicted from memory, empty keeps none
+	std::string track_dir;
+	// budget of the event log behind the cursor API, 0 lifts a limit
+	int events_max = 4096;
+	int events_kb = 1024;
 };
 
 // Bundles all per-receiver (or aggregate) state: ship DB, counters, history.
@@ -84,6 +89,8 @@ public:
 	// Config
 	void applyConfig(const TrackingConfig &cfg, const AIS::Filter &f);
 	void setStationPosition(float lat, float lon, bool use_gps) { ships.setConfigPosition(lat, lon, use_gps); }
+	// not part of applyConfig: per-receiver trackers must not share the directory
+	void setTrackDir(const std::string &dir) { ships.setTrackDir(dir); }
 
 	// Lifecycle
 	void setup();
@@ -100,6 +107,9 @@ public:
 
 	// Connect incoming data sources (ships as sink)
 	void connectJSON(Connection<JSON::JSON> &c) { c.Connect((StreamIn<JSON::JSON> *)&ships); }
+	// What the ships read from the JSON. The sinks behind them (histories,
+	// counters, SSE, Prometheus) only look at the message it carries.
+	static AIS::KeySet jsonKeys() { return DB::jsonKeys(); }
 	void connectGPS(Connection<AIS::GPS> &c) { c.Connect((StreamIn<AIS::GPS> *)&ships); }
 
 	// Connect outgoing sinks (ships as source)
@@ -121,6 +131,7 @@ public:
 	std::string getShipsJSON(bool full = false) { return ships.getJSON(full); }
 	std::string getShipsJSONcompact(std::time_t since = 0) { return ships.getJSONcompact(false, since); }
 	std::string getBinaryMessagesJSON(std::time_t since = 0) { return ships.getBinaryMessagesJSON(since); }
+	std::string getEventsJSON(uint64_t cursor, std::size_t max, int kind) { return ships.getEventsJSON(cursor, max, kind); }
 	std::string getKML() { return ships.getKML(); }
 	std::string getGeoJSON() { return ships.getGeoJSON(); }
 	std::string getAllPathJSON() { return ships.getAllPathJSON(); }
@@ -65,11 +65,12 @@ public:
 	}
 
 	// `initial` marks the first value ever seen rather than a change, so a vessel
-	// that never alters course still has a baseline to draw from
-	void addNumeric(uint32_t mmsi, Field field, uint8_t from, uint8_t to, std::time_t now, bool initial = false)
+	// that never alters course still has a baseline to draw from; false when the
+	// entry was not taken
+	bool addNumeric(uint32_t mmsi, Field field, uint8_t from, uint8_t to, std::time_t now, bool initial = false)
 	{
 		if (num.empty() || !valid(mmsi) || (!initial && from == to) || recent(num, num_next, mmsi, field, now))
-			return;
+			return false;
 
 		NumChange &e = num[num_next];
 		e.mmsi = mmsi;
@@ -79,12 +80,13 @@ public:
 		e.to = to;
 		e.flags = initial ? INITIAL : 0;
 		num_next = next(num_next, num.size());
+		return true;
 	}
 
-	void addText(uint32_t mmsi, Field field, const char *value, std::time_t now, bool initial = false)
+	bool addText(uint32_t mmsi, Field field, const char *value, std::time_t now, bool initial = false)
 	{
 		if (txt.empty() || !valid(mmsi) || !value || !*value || recent(txt, txt_next, mmsi, field, now))
-			return;
+			return false;
 
 		TextChange &e = txt[txt_next];
 		e.mmsi = mmsi;
@@ -94,6 +96,7 @@ public:
 		std::strncpy(e.value, value, sizeof(e.value) - 1);
 		e.value[sizeof(e.value) - 1] = '\0';
 		txt_next = next(txt_next, txt.size());
+		return true;
 	}
 
 	// Newest first, so the reader can stop early; matches the path endpoint. The
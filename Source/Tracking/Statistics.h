@@ -36,68 +36,147 @@ const int LONG_RANGE_CUTOFF_DEFAULT = 2500;
 
 // ----------------------------
 // Class to log message count stat
+//
+// Add() is called from the decoder threads of every receiver feeding a
+// tracker, so it takes no lock: counters are relaxed atomics, spread over
+// a few shards picked per thread so that writers do not share cache lines.
+// Readers sum the shards; a snapshot can be a message out of step between
+// fields, which is harmless for statistics.
 
 class MessageStatistics {
 
-	std::mutex mtx;
-
 	static const int _MAGIC = 0x4f82b;
 	static const int _VERSION = 3;
 	static const int _RADAR_BUCKETS = 18;
+	static const int _SHARDS = 4;
 
 	int _LONG_RANGE_CUTOFF = LONG_RANGE_CUTOFF_DEFAULT;
 
-	int _count, _exclude, _vessels;
-	int _msg[28];
-	int _channel[4];
+	struct Shard {
+		std::atomic<int> count, exclude, vessels;
+		std::atomic<int> msg[28];
+		std::atomic<int> channel[4];
+
+		std::atomic<float> level_min, level_max, ppm, distance;
+		// sum in 1/100 nm, split like ByteCounter so armv6 needs no libatomic
+		std::atomic<uint32_t> distance_lo, distance_hi;
+		std::atomic<int> distance_count;
+		std::atomic<float> radarA[_RADAR_BUCKETS];
+		std::atomic<float> radarB[_RADAR_BUCKETS];
+
+		char pad[64]; // keep the next shard off this one's cache lines
+	} shards[_SHARDS];
+
+	// aggregate of all shards, in the layout of the backup file
+	struct Totals {
+		int count = 0, exclude = 0, vessels = 0;
+		int msg[28] = {};
+		int channel[4] = {};
+		float level_min = 1e6, level_max = -1e6, ppm = 0, distance = 0;
+		double distance_sum = 0.0;
+		int distance_count = 0;
+		float radarA[_RADAR_BUCKETS] = {};
+		float radarB[_RADAR_BUCKETS] = {};
+	};
+
+	static const std::memory_order relaxed = std::memory_order_relaxed;
+
+	static int shardIndex() {
+		static std::atomic<unsigned> next{ 0 };
+		static thread_local int idx = (int)(next.fetch_add(1, relaxed) % _SHARDS);
+		return idx;
+	}
+
+	static void atomicAdd(std::atomic<float>& a, float v) {
+		float c = a.load(relaxed);
+		while (!a.compare_exchange_weak(c, c + v, relaxed)) {}
+	}
+
+	static void atomicMin(std::atomic<float>& a, float v) {
+		float c = a.load(relaxed);
+		while (v < c && !a.compare_exchange_weak(c, v, relaxed)) {}
+	}
 
-	float _level_min, _level_max, _ppm, _distance;
-	double _distance_sum;
-	int _distance_count;
-	float _radarA[_RADAR_BUCKETS];
-	float _radarB[_RADAR_BUCKETS];
+	static void atomicMax(std::atomic<float>& a, float v) {
+		float c = a.load(relaxed);
+		while (v > c && !a.compare_exchange_weak(c, v, relaxed)) {}
+	}
+
+	void clearShard(Shard& s) {
+		s.count.store(0, relaxed);
+		s.exclude.store(0, relaxed);
+		s.vessels.store(0, relaxed);
+		for (auto& m : s.msg) m.store(0, relaxed);
+		for (auto& c : s.channel) c.store(0, relaxed);
+		s.level_min.store(1e6, relaxed);
+		s.level_max.store(-1e6, relaxed);
+		s.ppm.store(0, relaxed);
+		s.distance.store(0, relaxed);
+		s.distance_lo.store(0, relaxed);
+		s.distance_hi.store(0, relaxed);
+		s.distance_count.store(0, relaxed);
+		for (auto& r : s.radarA) r.store(0, relaxed);
+		for (auto& r : s.radarB) r.store(0, relaxed);
+	}
+
+	Totals sum() const {
+		Totals t;
+		for (const Shard& s : shards) {
+			t.count += s.count.load(relaxed);
+			t.exclude += s.exclude.load(relaxed);
+			t.vessels += s.vessels.load(relaxed);
+			for (int i = 0; i < 28; i++) t.msg[i] += s.msg[i].load(relaxed);
+			for (int i = 0; i < 4; i++) t.channel[i] += s.channel[i].load(relaxed);
+			t.level_min = MIN(t.level_min, s.level_min.load(relaxed));
+			t.level_max = MAX(t.level_max, s.level_max.load(relaxed));
+			t.ppm += s.ppm.load(relaxed);
+			t.distance = MAX(t.distance, s.distance.load(relaxed));
+			uint64_t d = ((uint64_t)s.distance_hi.load(relaxed) << 32) | s.distance_lo.load(relaxed);
+			t.distance_sum += d / 100.0;
+			t.distance_count += s.distance_count.load(relaxed);
+			for (int i = 0; i < _RADAR_BUCKETS; i++) {
+				t.radarA[i] = MAX(t.radarA[i], s.radarA[i].load(relaxed));
+				t.radarB[i] = MAX(t.radarB[i], s.radarB[i].load(relaxed));
+			}
+		}
+		return t;
+	}
 
 public:
 	MessageStatistics() { Clear(); }
 
-	int getCount() { return _count; }
+	int getCount() const {
+		int c = 0;
+		for (const Shard& s : shards) c += s.count.load(relaxed);
+		return c;
+	}
 	void setCutoff(int cutoff) { _LONG_RANGE_CUTOFF = cutoff; }
-	void clearVessels() { _vessels = 0; }
+	void clearVessels() {
+		for (Shard& s : shards) s.vessels.store(0, relaxed);
+	}
 
 	void Clear() {
-		std::lock_guard<std::mutex> l{ this->mtx };
-
-		std::memset(_msg, 0, sizeof(_msg));
-		std::memset(_channel, 0, sizeof(_channel));
-		std::memset(_radarA, 0, sizeof(_radarA));
-		std::memset(_radarB, 0, sizeof(_radarB));
-
-		_count = _vessels = _exclude = 0;
-		_distance = _ppm = 0;
-		_distance_sum = 0.0;
-		_distance_count = 0;
-		_level_min = 1e6;
-		_level_max = -1e6;
+		for (Shard& s : shards) clearShard(s);
 	}
 
 	void Add(const AIS::Message& m, const TAG& tag, bool new_vessel = false) {
 
-		std::lock_guard<std::mutex> l{ this->mtx };
-
 		if (m.type() > 28 || m.type() < 1) return;
 
-		_count++;
-		if (new_vessel) _vessels++;
+		Shard& s = shards[shardIndex()];
+
+		s.count.fetch_add(1, relaxed);
+		if (new_vessel) s.vessels.fetch_add(1, relaxed);
 
-		_msg[m.type() - 1]++;
-		if (m.getChannel() >= 'A' && m.getChannel() <= 'D') _channel[m.getChannel() - 'A']++;
+		s.msg[m.type() - 1].fetch_add(1, relaxed);
+		if (m.getChannel() >= 'A' && m.getChannel() <= 'D') s.channel[m.getChannel() - 'A'].fetch_add(1, relaxed);
 
 		if (tag.level == LEVEL_UNDEFINED || tag.ppm == PPM_UNDEFINED)
-			_exclude++;
+			s.exclude.fetch_add(1, relaxed);
 		else {
-			_level_min = MIN(_level_min, tag.level);
-			_level_max = MAX(_level_max, tag.level);
-			_ppm += tag.ppm;
+			atomicMin(s.level_min, tag.level);
+			atomicMax(s.level_max, tag.level);
+			atomicAdd(s.ppm, tag.ppm);
 		}
 
 		// for range we ignore atons
@@ -106,100 +185,100 @@ public:
 		if (!tag.validated || tag.distance > _LONG_RANGE_CUTOFF || (m.repeat() > 0 && m.type() != 27))
 			return;
 
-		if (tag.distance > _distance) {
-			_distance = tag.distance;
-		}
-		_distance_sum += tag.distance;
-		_distance_count++;
+		atomicMax(s.distance, tag.distance);
+
+		uint32_t add = (uint32_t)(tag.distance * 100.0f + 0.5f);
+		uint32_t before = s.distance_lo.fetch_add(add, relaxed);
+		if (before + add < before)
+			s.distance_hi.fetch_add(1, relaxed);
+		s.distance_count.fetch_add(1, relaxed);
 
 		if (m.type() == 18 || m.type() == 19 || m.type() == 24) {
 			if (tag.angle >= 0 && tag.angle < 360) {
 				int bucket = tag.angle / (360 / _RADAR_BUCKETS);
-				if (tag.distance > _radarB[bucket])
-					_radarB[bucket] = tag.distance;
+				atomicMax(s.radarB[bucket], tag.distance);
 			}
 		}
 		else if (m.type() <= 3 || m.type() == 5 || m.type() == 27) {
 			if (tag.angle >= 0 && tag.angle < 360) {
 				int bucket = tag.angle / (360 / _RADAR_BUCKETS);
-				if (tag.distance > _radarA[bucket])
-					_radarA[bucket] = tag.distance;
+				atomicMax(s.radarA[bucket], tag.distance);
 			}
 		}
 	}
 
-	void writeJSON(JSON::Writer &w, bool empty = false) {
-		std::lock_guard<std::mutex> l{ this->mtx };
+	void writeJSON(JSON::Writer &w, bool empty = false) const {
+		Totals t = sum();
 
-		int c = _count - _exclude;
-		bool has_level = c > 0 && _level_min <= _level_max;
+		int c = t.count - t.exclude;
+		bool has_level = c > 0 && t.level_min <= t.level_max;
 
 		w.beginObject();
-		w.kv("count", empty ? 0 : _count);
-		w.kv("vessels", empty ? 0 : _vessels);
+		w.kv("count", empty ? 0 : t.count);
+		w.kv("vessels", empty ? 0 : t.vessels);
 		if (empty || !has_level) {
 			w.kv_null("level_min");
 			w.kv_null("level_max");
 			w.kv_null("ppm");
 		} else {
-			w.kv("level_min", _level_min);
-			w.kv("level_max", _level_max);
-			w.kv("ppm", _ppm / c);
+			w.kv("level_min", t.level_min);
+			w.kv("level_max", t.level_max);
+			w.kv("ppm", t.ppm / c);
 		}
 		if (empty)
 			w.kv_null("dist");
 		else
-			w.kv("dist", _distance);
+			w.kv("dist", t.distance);
 
 		w.key("channel").beginArray();
-		for (int i = 0; i < 4; i++) w.val(empty ? 0 : _channel[i]);
+		for (int i = 0; i < 4; i++) w.val(empty ? 0 : t.channel[i]);
 		w.endArray();
 
 		w.key("radar_a").beginArray();
-		for (int i = 0; i < _RADAR_BUCKETS; i++) w.val(empty ? 0.0f : _radarA[i]);
+		for (int i = 0; i < _RADAR_BUCKETS; i++) w.val(empty ? 0.0f : t.radarA[i]);
 		w.endArray();
 
 		w.key("radar_b").beginArray();
-		for (int i = 0; i < _RADAR_BUCKETS; i++) w.val(empty ? 0.0f : _radarB[i]);
+		for (int i = 0; i < _RADAR_BUCKETS; i++) w.val(empty ? 0.0f : t.radarB[i]);
 		w.endArray();
 
 		w.key("msg").beginArray();
-		for (int i = 0; i < 28; i++) w.val(empty ? 0 : _msg[i]);
+		for (int i = 0; i < 28; i++) w.val(empty ? 0 : t.msg[i]);
 		w.endArray();
 
 		w.endObject();
 	}
 
-	void print(std::ostream &out, const char *indent = "") {
-		std::lock_guard<std::mutex> l{ this->mtx };
+	void print(std::ostream &out, const char *indent = "") const {
+		Totals t = sum();
 
-		int c = _count - _exclude;
-		bool has_level = c > 0 && _level_min <= _level_max;
+		int c = t.count - t.exclude;
+		bool has_level = c > 0 && t.level_min <= t.level_max;
 
-		out << indent << "messages: " << _count << "\n";
-		if (_distance_count > 0) {
-			out << indent << "distance: max=" << _distance
-				<< " avg=" << (_distance_sum / _distance_count)
-				<< " (n=" << _distance_count << ")\n";
+		out << indent << "messages: " << t.count << "\n";
+		if (t.distance_count > 0) {
+			out << indent << "distance: max=" << t.distance
+				<< " avg=" << (t.distance_sum / t.distance_count)
+				<< " (n=" << t.distance_count << ")\n";
 		}
 		if (has_level) {
-			out << indent << "signal:   min=" << _level_min
-				<< " max=" << _level_max
-				<< " ppm=" << (_ppm / c) << "\n";
+			out << indent << "signal:   min=" << t.level_min
+				<< " max=" << t.level_max
+				<< " ppm=" << (t.ppm / c) << "\n";
 		}
-		out << indent << "channel:  A=" << _channel[0] << " B=" << _channel[1];
-		if (_channel[2]) out << " C=" << _channel[2];
-		if (_channel[3]) out << " D=" << _channel[3];
+		out << indent << "channel:  A=" << t.channel[0] << " B=" << t.channel[1];
+		if (t.channel[2]) out << " C=" << t.channel[2];
+		if (t.channel[3]) out << " D=" << t.channel[3];
 		out << "\n";
 
 		bool any_type = false;
 		for (int i = 0; i < 28; i++)
-			if (_msg[i] > 0) { any_type = true; break; }
+			if (t.msg[i] > 0) { any_type = true; break; }
 		if (any_type) {
 			out << indent << "by type: ";
 			for (int i = 0; i < 28; i++)
-				if (_msg[i] > 0)
-					out << " " << (i + 1) << "=" << _msg[i];
+				if (t.msg[i] > 0)
+					out << " " << (i + 1) << "=" << t.msg[i];
 			out << "\n";
 		}
 	}
@@ -207,37 +286,54 @@ public:
 #define W(x) file.write((const char*)&(x), sizeof(x))
 #define R(x) file.read((char*)&(x), sizeof(x))
 
-	bool Save(std::ofstream& file) {
-		std::lock_guard<std::mutex> l{ this->mtx };
+	bool Save(std::ofstream& file) const {
+		Totals t = sum();
 
 		int magic = _MAGIC;
 		int version = _VERSION;
 
-		return (bool)(W(magic) && W(version) && W(_count) && W(_vessels)
-			&& W(_msg) && W(_channel)
-			&& W(_level_min) && W(_level_max) && W(_ppm) && W(_distance)
-			&& W(_radarA) && W(_radarB));
+		return (bool)(W(magic) && W(version) && W(t.count) && W(t.vessels)
+			&& W(t.msg) && W(t.channel)
+			&& W(t.level_min) && W(t.level_max) && W(t.ppm) && W(t.distance)
+			&& W(t.radarA) && W(t.radarB));
 	}
 
+	// restored totals go into the first shard; only called while nothing is receiving
 	bool Load(std::ifstream& file) {
-		std::lock_guard<std::mutex> l{ this->mtx };
+		Totals t;
 
 		int magic = 0, version = 0;
-		if (!(R(magic) && R(version) && R(_count))) return false;
+		if (!(R(magic) && R(version) && R(t.count))) return false;
 		if (magic != _MAGIC) return false;
 		if (version != 1 && version != 2 && version != _VERSION) return false;
 
-		if (version >= 2 && !R(_vessels)) return false;
-		if (version < 2) _vessels = 0;
+		if (version >= 2 && !R(t.vessels)) return false;
 
 		// v3 grew _msg from 27 to 28 entries to include type 28 (AtoN single-slot report).
 		int n = (version >= 3) ? 28 : 27;
-		if (!file.read((char *)_msg, n * sizeof(int))) return false;
-		if (version < 3) _msg[27] = 0;
-
-		return (bool)(R(_channel)
-			&& R(_level_min) && R(_level_max) && R(_ppm) && R(_distance)
-			&& R(_radarA) && R(_radarB));
+		if (!file.read((char *)t.msg, n * sizeof(int))) return false;
+
+		if (!(R(t.channel)
+			&& R(t.level_min) && R(t.level_max) && R(t.ppm) && R(t.distance)
+			&& R(t.radarA) && R(t.radarB)))
+			return false;
+
+		Clear();
+
+		Shard& s = shards[0];
+		s.count.store(t.count, relaxed);
+		s.vessels.store(t.vessels, relaxed);
+		for (int i = 0; i < 28; i++) s.msg[i].store(t.msg[i], relaxed);
+		for (int i = 0; i < 4; i++) s.channel[i].store(t.channel[i], relaxed);
+		s.level_min.store(t.level_min, relaxed);
+		s.level_max.store(t.level_max, relaxed);
+		s.ppm.store(t.ppm, relaxed);
+		s.distance.store(t.distance, relaxed);
+		for (int i = 0; i < _RADAR_BUCKETS; i++) {
+			s.radarA[i].store(t.radarA[i], relaxed);
+			s.radarB[i].store(t.radarB[i], relaxed);
+		}
+		return true;
 	}
 
 #undef W
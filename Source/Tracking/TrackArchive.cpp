@@ -0,0 +1,495 @@
+/*
+	Copyright(c) 2021-2026 jvde.github@gmail.com
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+
+#ifdef __linux__
+#include <fcntl.h>
+#endif
+
+#include "TrackArchive.h"
+#include "Logger.h"
+#include "Convert.h"
+#include "Helper.h"
+
+// File layout, integers little-endian:
+//   records: "TRK1", u32 t_min, u32 t_max, u32 length, payload
+//   payload: runs of varint mmsi followed by a PathStore::encodeRun run
+// A file holds the records whose t_max falls on its (UTC) day. A record cut
+// short by a crash is skipped by searching for the next magic.
+
+static const char RECORD_MAGIC[] = "TRK1";
+static const long RECORD_HEADER = 16;
+
+static const char *FILE_PREFIX = "tracks-";
+static const char *FILE_EXT = ".trk";
+
+// zeros behind a payload stop any varint a corrupt run starts
+static const size_t PAD = 64;
+
+static void put32(char *p, uint32_t v)
+{
+	for (int i = 0; i < 4; i++)
+		p[i] = (char)(v >> (8 * i));
+}
+
+static uint32_t get32(const char *p)
+{
+	uint32_t v = 0;
+	for (int i = 0; i < 4; i++)
+		v |= (uint32_t)(uint8_t)p[i] << (8 * i);
+	return v;
+}
+
+static void putVarint(std::string &out, uint32_t v)
+{
+	while (v >= 0x80)
+	{
+		out += (char)(v | 0x80);
+		v >>= 7;
+	}
+	out += (char)v;
+}
+
+static uint32_t getVarint(const uint8_t *&p)
+{
+	uint32_t v = 0;
+	for (int shift = 0; shift < 35; shift += 7)
+	{
+		uint8_t b = *p++;
+		v |= (uint32_t)(b & 0x7F) << shift;
+		if (!(b & 0x80))
+			break;
+	}
+	return v;
+}
+
+// the page cache should not fill with history nobody is replaying
+static void dropCache(FILE *f)
+{
+#ifdef __linux__
+	posix_fadvise(fileno(f), 0, 0, POSIX_FADV_DONTNEED);
+#endif
+}
+
+bool TrackArchive::open(const std::string &d)
+{
+	close();
+
+	dir = d.empty() ? "." : d;
+	while (dir.size() > 1 && (dir.back() == '/' || dir.back() == '\\'))
+		dir.pop_back();
+
+	const std::string probe = dir + "/.aiscatcher-tracks";
+	FILE *t = fopen(probe.c_str(), "wb");
+	if (!t)
+		throw std::runtime_error("Tracks: cannot write to directory \"" + dir + "\", does it exist?");
+	fclose(t);
+	std::remove(probe.c_str());
+
+	std::vector<std::string> files = Util::Helper::getFilesWithExtension(dir, FILE_EXT);
+	std::sort(files.begin(), files.end());
+	for (const auto &path : files)
+		scan(path);
+
+	Info() << "Tracks: evicted history archived to " << dir << " (" << index.size() << " records on disk)";
+
+	std::lock_guard<std::mutex> lock(mtx);
+	running = true;
+	stopping = false;
+	writer = std::thread(&TrackArchive::run, this);
+	return true;
+}
+
+void TrackArchive::close()
+{
+	{
+		std::lock_guard<std::mutex> lock(mtx);
+		if (!running)
+			return;
+		stopping = true;
+	}
+	cv.notify_one();
+
+	if (writer.joinable())
+		writer.join();
+
+	if (file)
+		fclose(file);
+	file = nullptr;
+	file_path.clear();
+
+	if (dropped)
+		Warning() << "Tracks: " << dropped << " points dropped, the disk did not keep up";
+
+	std::lock_guard<std::mutex> lock(mtx);
+	running = false;
+	index.clear();
+	stage.clear();
+	sealing.clear();
+	dropped = 0;
+}
+
+void TrackArchive::add(uint32_t mmsi, const PathStore::Point *pts, int n)
+{
+	if (n <= 0)
+		return;
+
+	std::lock_guard<std::mutex> lock(mtx);
+	if (!running)
+		return;
+
+	if (stage.data.size() >= STAGE_LIMIT)
+	{
+		dropped += n;
+		return;
+	}
+
+	if (stage.data.empty())
+	{
+		stage.opened = std::time(nullptr);
+		stage.t_min = pts[0].time;
+		stage.t_max = pts[0].end();
+	}
+
+	for (int i = 0; i < n; i++)
+	{
+		stage.t_min = std::min(stage.t_min, pts[i].time);
+		stage.t_max = std::max(stage.t_max, pts[i].end());
+	}
+
+	putVarint(stage.data, mmsi);
+	PathStore::encodeRun(pts, n, stage.data);
+
+	if (stage.data.size() >= FLUSH_BYTES)
+		cv.notify_one();
+}
+
+void TrackArchive::run()
+{
+	std::unique_lock<std::mutex> lock(mtx);
+	std::time_t last_prune = 0;
+
+	while (true)
+	{
+		cv.wait_for(lock, std::chrono::seconds(1));
+
+		std::time_t now = std::time(nullptr);
+		if (!stage.data.empty() && (stopping || stage.data.size() >= FLUSH_BYTES || now - stage.opened >= FLUSH_SECONDS))
+		{
+			sealing = std::move(stage);
+			stage.clear();
+
+			lock.unlock();
+			seal(sealing);
+			lock.lock();
+
+			sealing.clear();
+		}
+
+		if (stopping)
+			break;
+
+		if (now - last_prune >= PRUNE_SECONDS)
+		{
+			lock.unlock();
+			prune();
+			lock.lock();
+			last_prune = now;
+		}
+	}
+}
+
+// runs on the writer thread, which owns the open file
+void TrackArchive::seal(const Stage &s)
+{
+	const std::string path = dir + "/" + FILE_PREFIX + Util::Convert::toDateStr((std::time_t)s.t_max) + FILE_EXT;
+
+	if (path != file_path)
+	{
+		if (file)
+			fclose(file);
+		file_path = path;
+		file = fopen(path.c_str(), "ab");
+	}
+
+	bool ok = file != nullptr && fseek(file, 0, SEEK_END) == 0;
+	long offset = ok ? ftell(file) + RECORD_HEADER : 0;
+
+	if (ok)
+	{
+		char hdr[RECORD_HEADER];
+		memcpy(hdr, RECORD_MAGIC, 4);
+		put32(hdr + 4, s.t_min);
+		put32(hdr + 8, s.t_max);
+		put32(hdr + 12, (uint32_t)s.data.size());
+
+		ok = fwrite(hdr, 1, sizeof(hdr), file) == sizeof(hdr) &&
+			 fwrite(s.data.data(), 1, s.data.size(), file) == s.data.size() &&
+			 fflush(file) == 0;
+	}
+
+	if (!ok)
+	{
+		Error() << "Tracks: cannot write " << path << ", history dropped";
+		if (file)
+			fclose(file);
+		file = nullptr;
+		file_path.clear();
+		return;
+	}
+
+	dropCache(file);
+
+	std::lock_guard<std::mutex> lock(mtx);
+	index.push_back({path, offset, s.t_min, s.t_max, (uint32_t)s.data.size()});
+}
+
+void TrackArchive::scan(const std::string &path)
+{
+	const std::string name = path.substr(path.find_last_of("/\\") + 1);
+	if (name.compare(0, strlen(FILE_PREFIX), FILE_PREFIX) != 0)
+		return;
+
+	FILE *f = fopen(path.c_str(), "rb");
+	if (!f)
+		return;
+
+	fseek(f, 0, SEEK_END);
+	const long size = ftell(f);
+
+	long pos = 0;
+	int skipped = 0;
+	char hdr[RECORD_HEADER];
+
+	while (pos + RECORD_HEADER <= size)
+	{
+		fseek(f, pos, SEEK_SET);
+		if (fread(hdr, 1, sizeof(hdr), f) != sizeof(hdr))
+			break;
+
+		const uint32_t bytes = get32(hdr + 12);
+		if (memcmp(hdr, RECORD_MAGIC, 4) == 0 && pos + RECORD_HEADER + (long)bytes <= size)
+		{
+			index.push_back({path, pos + RECORD_HEADER, get32(hdr + 4), get32(hdr + 8), bytes});
+			pos += RECORD_HEADER + bytes;
+			continue;
+		}
+
+		// resynchronise on the next magic
+		skipped++;
+		long next = -1;
+		std::vector<char> buf(65536);
+		for (long at = pos + 1; next < 0 && at < size; at += (long)buf.size() - 3)
+		{
+			fseek(f, at, SEEK_SET);
+			size_t n = fread(buf.data(), 1, buf.size(), f);
+			if (n < 4)
+				break;
+			auto it = std::search(buf.begin(), buf.begin() + n, RECORD_MAGIC, RECORD_MAGIC + 4);
+			if (it != buf.begin() + n)
+				next = at + (long)(it - buf.begin());
+		}
+		if (next < 0)
+			break;
+		pos = next;
+	}
+
+	dropCache(f);
+	fclose(f);
+
+	if (skipped)
+		Warning() << "Tracks: skipped " << skipped << " damaged record(s) in " << path;
+}
+
+void TrackArchive::prune()
+{
+	const int k = keep;
+	if (k <= 0)
+		return;
+
+	const std::string cutoff = Util::Convert::toDateStr(std::time(nullptr) - k);
+	const std::string prefix = FILE_PREFIX;
+
+	for (const auto &path : Util::Helper::getFilesWithExtension(dir, FILE_EXT))
+	{
+		const std::string name = path.substr(path.find_last_of("/\\") + 1);
+		if (name.size() != prefix.size() + 14 || name.compare(0, prefix.size(), prefix) != 0 ||
+			name.substr(prefix.size(), 10) >= cutoff)
+			continue;
+
+		if (file && path == file_path)
+		{
+			fclose(file);
+			file = nullptr;
+			file_path.clear();
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(mtx);
+			index.erase(std::remove_if(index.begin(), index.end(), [&](const Entry &e) { return e.path == path; }), index.end());
+		}
+		std::remove(path.c_str());
+	}
+}
+
+uint32_t TrackArchive::oldest()
+{
+	std::lock_guard<std::mutex> lock(mtx);
+
+	uint32_t t = 0;
+	auto take = [&](uint32_t v) {
+		if (t == 0 || v < t)
+			t = v;
+	};
+
+	for (const auto &e : index)
+		take(e.t_min);
+	if (!stage.data.empty())
+		take(stage.t_min);
+	if (!sealing.data.empty())
+		take(sealing.t_min);
+	return t;
+}
+
+void TrackArchive::read(std::time_t from, std::time_t until, Tracks &out)
+{
+	const uint32_t lo = from > 0 ? (uint32_t)from : 0;
+	const uint32_t hi = until > 0 ? (uint32_t)until : 0xFFFFFFFFu;
+	auto overlaps = [&](uint32_t t_min, uint32_t t_max) { return t_max >= lo && t_min <= hi; };
+
+	std::vector<Entry> hits;
+	std::string staged;
+	size_t total = 0;
+	bool capped = false;
+
+	// only the index is consulted under the lock, the files are read without it
+	{
+		std::lock_guard<std::mutex> lock(mtx);
+		if (!running)
+			return;
+
+		for (auto it = index.rbegin(); it != index.rend(); ++it)
+		{
+			if (!overlaps(it->t_min, it->t_max))
+				continue;
+			if (total + it->bytes > READ_LIMIT)
+			{
+				capped = true;
+				break;
+			}
+			total += it->bytes;
+			hits.push_back(*it);
+		}
+
+		if (!stage.data.empty() && overlaps(stage.t_min, stage.t_max))
+			staged += stage.data;
+		if (!sealing.data.empty() && overlaps(sealing.t_min, sealing.t_max))
+			staged += sealing.data;
+	}
+
+	if (capped)
+		Debug() << "Tracks: window read capped at " << READ_LIMIT / (1024 * 1024) << " MB";
+
+	std::sort(hits.begin(), hits.end(), [](const Entry &a, const Entry &b) {
+		return a.path != b.path ? a.path < b.path : a.offset < b.offset;
+	});
+
+	std::string buf;
+	FILE *f = nullptr;
+	const std::string *open_path = nullptr;
+
+	for (const auto &e : hits)
+	{
+		if (!open_path || *open_path != e.path)
+		{
+			if (f)
+			{
+				dropCache(f);
+				fclose(f);
+			}
+			f = fopen(e.path.c_str(), "rb");
+			open_path = &e.path;
+		}
+		if (!f)
+			continue;
+
+		buf.resize(e.bytes);
+		if (e.bytes == 0 || fseek(f, e.offset, SEEK_SET) != 0 || fread(&buf[0], 1, e.bytes, f) != e.bytes)
+			continue;
+		decode(buf, hi, out);
+	}
+
+	if (f)
+	{
+		dropCache(f);
+		fclose(f);
+	}
+
+	if (!staged.empty())
+		decode(staged, hi, out);
+
+	// newest first, and of the points before the window only the last one,
+	// where the vessel was when it opened
+	for (auto it = out.begin(); it != out.end();)
+	{
+		// runs decode oldest first; same-second points keep their order
+		auto &pts = it->second;
+		std::reverse(pts.begin(), pts.end());
+		std::stable_sort(pts.begin(), pts.end(), [](const PathStore::Point &a, const PathStore::Point &b) { return a.time > b.time; });
+
+		auto before = std::find_if(pts.begin(), pts.end(), [&](const PathStore::Point &p) { return p.end() < lo; });
+		if (before != pts.end())
+			pts.erase(before + 1, pts.end());
+
+		if (pts.empty())
+			it = out.erase(it);
+		else
+			++it;
+	}
+}
+
+// pads `data`, see PAD; runs starting after the window are skipped whole
+void TrackArchive::decode(std::string &data, uint32_t until, Tracks &out)
+{
+	const size_t n = data.size();
+	data.append(PAD, '\0');
+
+	const uint8_t *p = (const uint8_t *)data.data();
+	const uint8_t *end = p + n;
+	std::vector<PathStore::Point> run;
+
+	while (p < end)
+	{
+		uint32_t mmsi = getVarint(p);
+
+		run.clear();
+		if (!PathStore::decodeRun(p, end, run))
+			break;
+
+		if (run.front().time > until)
+			continue;
+
+		auto &pts = out[mmsi];
+		for (const auto &q : run)
+			if (q.time <= until)
+				pts.push_back(q);
+	}
+}
@@ -0,0 +1,110 @@
+/*
+	Copyright(c) 2021-2026 jvde.github@gmail.com
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdio>
+#include <ctime>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "PathStore.h"
+
+// Disk tier below PathStore. Track history leaving memory is staged under the
+// tracker lock and sealed by a writer thread into append-only daily files of
+// records, each carrying the time range of the runs it holds. The record index
+// lives in memory, so a replay window reads only the records it overlaps and
+// never waits on the tracker.
+class TrackArchive
+{
+public:
+	// per MMSI, newest point first
+	typedef std::unordered_map<uint32_t, std::vector<PathStore::Point>> Tracks;
+
+	~TrackArchive() { close(); }
+
+	bool open(const std::string &dir);
+	void close();
+	bool isOpen() const { return running; }
+
+	// seconds of history kept on disk, 0 keeps everything
+	void setKeep(int seconds) { keep = seconds; }
+
+	// called under the tracker lock, so it only copies into the staging buffer
+	void add(uint32_t mmsi, const PathStore::Point *pts, int n);
+
+	// history overlapping [from, until], until 0 is unbounded
+	void read(std::time_t from, std::time_t until, Tracks &out);
+
+	// earliest time held, 0 when empty
+	uint32_t oldest();
+
+private:
+	static const size_t FLUSH_BYTES = 256 * 1024;
+	static const int FLUSH_SECONDS = 60;
+	// staging is dropped beyond this while the disk does not keep up
+	static const size_t STAGE_LIMIT = 8 * 1024 * 1024;
+	// payload a single read may pull in, newest records first
+	static const size_t READ_LIMIT = 64 * 1024 * 1024;
+	static const int PRUNE_SECONDS = 3600;
+
+	struct Entry
+	{
+		std::string path;
+		long offset; // of the payload
+		uint32_t t_min, t_max, bytes;
+	};
+
+	struct Stage
+	{
+		std::string data;
+		uint32_t t_min = 0, t_max = 0;
+		std::time_t opened = 0;
+
+		void clear() { *this = Stage(); }
+	};
+
+	std::string dir;
+	std::atomic<int> keep{0};
+
+	// guards everything below
+	std::mutex mtx;
+	std::condition_variable cv;
+
+	std::vector<Entry> index;
+	Stage stage, sealing; // `sealing` is being written and not yet indexed
+	uint64_t dropped = 0;
+
+	std::thread writer;
+	std::atomic<bool> running{false}; // read by isOpen() without the lock
+	bool stopping = false;
+
+	FILE *file = nullptr;
+	std::string file_path;
+
+	void run();
+	void seal(const Stage &s);
+	void scan(const std::string &path);
+	void prune();
+
+	static void decode(std::string &data, uint32_t until, Tracks &out);
+};
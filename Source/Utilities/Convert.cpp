@@ -75,11 +75,10 @@ namespace Util
 		return std::string(str, 14);
 	}
 
-	std::string Convert::toTimestampStr(const std::time_t &t)
+	void Convert::toTimestampStr(const std::time_t &t, char *str)
 	{
 		UTC u = breakdown(t);
 
-		char str[24];
 		put2(str, u.year / 100);
 		put2(str + 2, u.year % 100);
 		str[4] = '/';
@@ -92,6 +91,13 @@ namespace Util
 		put2(str + 14, u.min);
 		str[16] = ':';
 		put2(str + 17, u.sec);
+		str[19] = '\0';
+	}
+
+	std::string Convert::toTimestampStr(const std::time_t &t)
+	{
+		char str[20];
+		toTimestampStr(t, str);
 		return std::string(str, 19);
 	}
 
@@ -143,6 +149,8 @@ namespace Util
 			return "F32_FS4";
 		case Format::DC16H:
 			return "DC16H";
+		case Format::BASEBAND:
+			return "BASEBAND";
 		default:
 			break;
 		}
@@ -30,6 +30,8 @@ namespace Util
 	public:
 		static std::string toTimeStr(const std::time_t &t);
 		static std::string toTimestampStr(const std::time_t &t);
+		// 19 characters plus terminator into a caller buffer of at least 20
+		static void toTimestampStr(const std::time_t &t, char *out);
 		static std::string toDateStr(const std::time_t &t);
 		static std::string toHexString(uint64_t l);
 
@@ -187,6 +187,8 @@ namespace Util
 			format = Format::F32_FS4;
 		else if (str == "DC16H")
 			format = Format::DC16H;
+		else if (str == "BASEBAND")
+			format = Format::BASEBAND;
 		else
 			return false;
 
@@ -224,6 +226,8 @@ namespace Util
 			type = Type::SERIALPORT;
 		else if (str == "UDP" || str == "UDPSERVER")
 			type = Type::UDP;
+		else if (str == "TCPSERVER")
+			type = Type::TCPSERVER;
 		else if (str == "SPYSERVER")
 			type = Type::SPYSERVER;
 		else if (str == "NMEA2000")
@@ -380,6 +384,8 @@ namespace Util
 			return "SERIALPORT";
 		case Type::UDP:
 			return "UDP";
+		case Type::TCPSERVER:
+			return "TCPSERVER";
 		case Type::SPYSERVER:
 			return "SPYSERVER";
 		case Type::N2K:
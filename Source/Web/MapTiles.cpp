@@ -18,6 +18,7 @@
 #include "MapTiles.h"
 #include "Logger.h"
 
+#include <atomic>
 #include <fstream>
 #include <algorithm>
 #include <sstream>
@@ -48,6 +49,7 @@ namespace
         {".png", "png", "image/png"},
         {".jpg", "jpg", "image/jpeg"},
         {".jpeg", "jpg", "image/jpeg"},
+        {".webp", "webp", "image/webp"},
         {".pbf", "pbf", "application/x-protobuf"},
     };
 
@@ -57,11 +59,24 @@ namespace
             return "image/png";
         if (format == "jpg" || format == "jpeg")
             return "image/jpeg";
+        if (format == "webp")
+            return "image/webp";
         if (format == "pbf")
             return "application/x-protobuf";
         return "application/octet-stream";
     }
 
+    bool isFile(const std::string &path)
+    {
+#ifdef _WIN32
+        DWORD attributes = GetFileAttributesA(path.c_str());
+        return attributes != INVALID_FILE_ATTRIBUTES && !(attributes & FILE_ATTRIBUTE_DIRECTORY);
+#else
+        struct stat statbuf;
+        return stat(path.c_str(), &statbuf) == 0 && S_ISREG(statbuf.st_mode);
+#endif
+    }
+
     const TileExt *extInfo(const std::string &filename)
     {
         size_t pos = filename.find_last_of('.');
@@ -80,8 +95,105 @@ namespace
 
 MapTiles::MapTiles() : minZoom(0), maxZoom(18)
 {
-    static int next_layer = 0;
-    layerID = std::to_string(++next_layer);
+    static std::atomic<int> next_layer(0);
+    layer = ++next_layer;
+    layerID = std::to_string(layer);
+}
+
+MapTiles::~MapTiles()
+{
+    TileCache::instance().drop(layer);
+}
+
+MapTiles::Tile MapTiles::getTile(int z, int x, int y, std::string &contentType)
+{
+    contentType.clear();
+
+    // beyond what the cache key holds, and beyond any zoom level in use
+    if (z < 0 || z > 30 || x < 0 || y < 0 || x >= (1 << 25) || y >= (1 << 25))
+        return nullptr;
+
+    TileCache &cache = TileCache::instance();
+    const uint64_t key = TileCache::key(layer, z, x, y);
+
+    Tile tile;
+    if (cache.get(key, tile, contentType))
+        return tile;
+
+    tile = loadTile(z, x, y, contentType);
+    cache.put(key, tile, contentType);
+    return tile;
+}
+
+TileCache &TileCache::instance()
+{
+    // never destroyed: layers may still drop their tiles during static teardown
+    static TileCache *cache = new TileCache();
+    return *cache;
+}
+
+// layer (8 bits), zoom (6), x and y (25 each)
+uint64_t TileCache::key(int layer, int z, int x, int y)
+{
+    return ((uint64_t)(layer & 0xFF) << 56) | ((uint64_t)(z & 0x3F) << 50) | ((uint64_t)x << 25) | (uint64_t)y;
+}
+
+bool TileCache::get(uint64_t key, MapTiles::Tile &tile, std::string &contentType)
+{
+    std::lock_guard<std::mutex> lock(mtx);
+
+    auto it = index.find(key);
+    if (it == index.end())
+        return false;
+
+    lru.splice(lru.begin(), lru, it->second);
+    tile = it->second->tile;
+    contentType = it->second->contentType;
+    return true;
+}
+
+void TileCache::put(uint64_t key, const MapTiles::Tile &tile, const std::string &contentType)
+{
+    std::lock_guard<std::mutex> lock(mtx);
+
+    auto it = index.find(key);
+    if (it != index.end())
+    {
+        bytes -= cost(*it->second);
+        lru.erase(it->second);
+        index.erase(it);
+    }
+
+    lru.push_front({key, tile, contentType});
+    index[key] = lru.begin();
+    bytes += cost(lru.front());
+
+    while (bytes > BUDGET && lru.size() > 1)
+    {
+        bytes -= cost(lru.back());
+        index.erase(lru.back().key);
+        lru.pop_back();
+    }
+}
+
+void TileCache::drop(int layer)
+{
+    std::lock_guard<std::mutex> lock(mtx);
+
+    const uint64_t bits = key(layer, 0, 0, 0);
+
+    for (auto it = lru.begin(); it != lru.end();)
+    {
+        if ((it->key >> 56) != (bits >> 56))
+        {
+            ++it;
+            continue;
+        }
+
+        bytes -= cost(*it);
+        index.erase(it->key);
+        it = lru.erase(it);
+    }
 }
 
 bool MapTiles::isValidCoordinate(int z, int x, int y) const
@@ -114,10 +226,45 @@ MBTilesSupport::MBTilesSupport() : db(nullptr) {}
 
 MBTilesSupport::~MBTilesSupport()
 {
+    for (sqlite3_stmt *stmt : statements)
+        sqlite3_finalize(stmt);
+
     if (db)
         sqlite3_close(db);
 }
 
+sqlite3_stmt *MBTilesSupport::acquireStatement()
+{
+    {
+        std::lock_guard<std::mutex> lock(statement_mtx);
+        if (!statements.empty())
+        {
+            sqlite3_stmt *stmt = statements.back();
+            statements.pop_back();
+            return stmt;
+        }
+    }
+
+    sqlite3_stmt *stmt = nullptr;
+    const char *query = "SELECT tile_data FROM tiles WHERE zoom_level = ? AND tile_column = ? AND tile_row = ?";
+
+    if (sqlite3_prepare_v2(db, query, -1, &stmt, nullptr) != SQLITE_OK)
+    {
+        Error() << "MBTILES: Failed to prepare SQL statement: " << sqlite3_errmsg(db);
+        return nullptr;
+    }
+    return stmt;
+}
+
+void MBTilesSupport::releaseStatement(sqlite3_stmt *stmt)
+{
+    sqlite3_reset(stmt);
+    sqlite3_clear_bindings(stmt);
+
+    std::lock_guard<std::mutex> lock(statement_mtx);
+    statements.push_back(stmt);
+}
+
 void MBTilesSupport::loadMetadata()
 {
     sqlite3_stmt *stmt;
@@ -187,43 +334,37 @@ int MBTilesSupport::getMBTilesZoom(int olZoom) const
     return zoomMapping[olZoom];
 }
 
-const std::vector<unsigned char> &MBTilesSupport::getTile(int z, int x, int y, std::string &contentType)
+MapTiles::Tile MBTilesSupport::loadTile(int z, int x, int y, std::string &contentType)
 {
-    contentType.clear();
-    tileData.clear();
-
     int mbtilesZoom = getMBTilesZoom(z);
     if (mbtilesZoom == -1)
-        return tileData;
+        return nullptr;
 
     int tmsY = (1 << mbtilesZoom) - 1 - y;
 
-    sqlite3_stmt *stmt;
-    const char *query = "SELECT tile_data FROM tiles WHERE zoom_level = ? AND tile_column = ? AND tile_row = ?";
-
-    if (sqlite3_prepare_v2(db, query, -1, &stmt, nullptr) != SQLITE_OK)
-    {
-        Error() << "MBTILES: Failed to prepare SQL statement: " << sqlite3_errmsg(db);
-        return tileData;
-    }
+    sqlite3_stmt *stmt = acquireStatement();
+    if (!stmt)
+        return nullptr;
 
     sqlite3_bind_int(stmt, 1, mbtilesZoom);
     sqlite3_bind_int(stmt, 2, x);
     sqlite3_bind_int(stmt, 3, tmsY);
 
+    Tile tile;
     if (sqlite3_step(stmt) == SQLITE_ROW)
     {
-        const void *data = sqlite3_column_blob(stmt, 0);
+        const unsigned char *data = static_cast<const unsigned char *>(sqlite3_column_blob(stmt, 0));
         int size = sqlite3_column_bytes(stmt, 0);
 
-        tileData.resize(size);
-        std::memcpy(tileData.data(), data, size);
-
-        contentType = mimeForFormat(format);
+        if (data && size > 0)
+        {
+            tile = std::make_shared<const std::vector<unsigned char>>(data, data + size);
+            contentType = mimeForFormat(format);
+        }
     }
 
-    sqlite3_finalize(stmt);
-    return tileData;
+    releaseStatement(stmt);
+    return tile;
 }
 
 std::string MBTilesSupport::generatePluginCode(bool overlay) const
@@ -374,37 +515,57 @@ bool FileSystemTiles::open(const std::string &directoryPath)
     }
 }
 
-const std::vector<unsigned char> &FileSystemTiles::getTile(int z, int x, int y, std::string &contentType)
+// the layer's own format is tried first, most directories hold only that one
+bool FileSystemTiles::findTile(int z, int x, int y, std::string &path, std::string &contentType) const
 {
-    contentType.clear();
-    tileData.clear();
-
     if (!isValidCoordinate(z, x, y))
-        return tileData;
+        return false;
 
     std::string base = basePath + "/" + std::to_string(z) + "/" +
                        std::to_string(x) + "/" + std::to_string(y);
 
-    for (const TileExt &t : tile_exts)
-    {
-        std::ifstream file((base + t.ext).c_str(), std::ios::binary | std::ios::ate);
-        if (!file.is_open())
-            continue;
-
-        std::streamsize size = file.tellg();
-        file.seekg(0, std::ios::beg);
-
-        tileData.resize((size_t)size);
-        if (file.read(reinterpret_cast<char *>(tileData.data()), size))
+    for (int pass = 0; pass < 2; pass++)
+        for (const TileExt &t : tile_exts)
         {
-            contentType = t.mime;
-            return tileData;
+            if ((format == t.format) != (pass == 0))
+                continue;
+
+            path = base + t.ext;
+            if (isFile(path))
+            {
+                contentType = t.mime;
+                return true;
+            }
         }
 
-        tileData.clear();
-    }
+    return false;
+}
+
+// images go out straight from the file; vector tiles are read, since whether
+// they are stored gzipped decides how they are sent
+bool FileSystemTiles::getTileFile(int z, int x, int y, std::string &path, std::string &contentType)
+{
+    return format != "pbf" && findTile(z, x, y, path, contentType) && !MapTiles::isCompressible(contentType);
+}
+
+MapTiles::Tile FileSystemTiles::loadTile(int z, int x, int y, std::string &contentType)
+{
+    std::string path;
+    if (!findTile(z, x, y, path, contentType))
+        return nullptr;
+
+    std::ifstream file(path.c_str(), std::ios::binary | std::ios::ate);
+    if (!file.is_open())
+        return nullptr;
+
+    std::streamsize size = file.tellg();
+    file.seekg(0, std::ios::beg);
+
+    std::vector<unsigned char> data((size_t)size);
+    if (!file.read(reinterpret_cast<char *>(data.data()), size))
+        return nullptr;
 
-    return tileData;
+    return std::make_shared<const std::vector<unsigned char>>(std::move(data));
 }
 
 std::string FileSystemTiles::generatePluginCode(bool overlay) const
@@ -17,41 +17,58 @@
 
 #pragma once
 
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #ifdef HASSQLITE
-#include <cstdint>
 #include <sqlite3.h>
 #endif
 
 class MapTiles
 {
+public:
+    typedef std::shared_ptr<const std::vector<unsigned char>> Tile;
+
 protected:
     std::string name;
     std::string attribution;
     std::string layerID;
     std::string format;
 
-    std::vector<unsigned char> tileData;
-
+    int layer;
     int minZoom;
     int maxZoom;
 
+    // Null means no such tile.
+    virtual Tile loadTile(int z, int x, int y, std::string &contentType) = 0;
+
     bool isValidCoordinate(int z, int x, int y) const;
 
     std::string pluginCode(bool overlay, const std::string &sourceOptions) const;
 
 public:
     MapTiles();
-    virtual ~MapTiles() = default;
+    virtual ~MapTiles();
 
     virtual bool open(const std::string &source) = 0;
 
-    // Empty result means no such tile.
-    virtual const std::vector<unsigned char> &getTile(int z, int x, int y, std::string &contentType) = 0;
+    // Null means no such tile; answered from the cache shared by all layers
+    // when the tile was asked for recently.
+    Tile getTile(int z, int x, int y, std::string &contentType);
+    // A source keeping tiles as plain files names the file instead, so it can
+    // be sent without being read; false sends the caller to getTile.
+    virtual bool getTileFile(int z, int x, int y, std::string &path, std::string &contentType) { return false; }
     virtual std::string generatePluginCode(bool overlay) const = 0;
 
+    // images are compressed already, vector tiles often stored gzipped
+    static bool isGzip(const std::vector<unsigned char> &data) { return data.size() >= 2 && data[0] == 0x1f && data[1] == 0x8b; }
+    static bool isCompressible(const std::string &contentType) { return contentType == "application/x-protobuf"; }
+
     const std::string &getName() const { return name; }
     const std::string &getAttribution() const { return attribution; }
     int getMinZoom() const { return minZoom; }
@@ -60,6 +77,38 @@ public:
     const std::string &getLayerID() const { return layerID; }
 };
 
+// Recently served tiles of every layer, bounded in bytes and evicted least
+// recently used first. Misses are kept as well, so the empty tiles around a
+// sparse set do not go back to the source on every pan.
+class TileCache
+{
+    static const size_t BUDGET = 16 * 1024 * 1024;
+    static const size_t ENTRY_OVERHEAD = 96;
+
+    struct Entry
+    {
+        uint64_t key;
+        MapTiles::Tile tile;
+        std::string contentType;
+    };
+
+    std::list<Entry> lru; // most recent first
+    std::unordered_map<uint64_t, std::list<Entry>::iterator> index;
+    size_t bytes = 0;
+    std::mutex mtx;
+
+    static size_t cost(const Entry &e) { return ENTRY_OVERHEAD + (e.tile ? e.tile->size() : 0); }
+
+public:
+    static TileCache &instance();
+    static uint64_t key(int layer, int z, int x, int y);
+
+    bool get(uint64_t key, MapTiles::Tile &tile, std::string &contentType);
+    void put(uint64_t key, const MapTiles::Tile &tile, const std::string &contentType);
+    // forget a layer, so a later one with the same key bits starts empty
+    void drop(int layer);
+};
+
 #ifdef HASSQLITE
 class MBTilesSupport : public MapTiles
 {
@@ -67,15 +116,24 @@ private:
     sqlite3 *db;
     std::vector<int> zoomMapping;
 
+    // prepared tile queries not in use, reset and ready for binding
+    std::vector<sqlite3_stmt *> statements;
+    std::mutex statement_mtx;
+
+    sqlite3_stmt *acquireStatement();
+    void releaseStatement(sqlite3_stmt *stmt);
+
     void loadMetadata();
     int getMBTilesZoom(int olZoom) const;
 
+protected:
+    Tile loadTile(int z, int x, int y, std::string &contentType) override;
+
 public:
     MBTilesSupport();
     ~MBTilesSupport() override;
 
     bool open(const std::string &filename) override;
-    const std::vector<unsigned char> &getTile(int z, int x, int y, std::string &contentType) override;
     std::string generatePluginCode(bool overlay) const override;
 };
 #endif
@@ -91,12 +149,16 @@ private:
 
     void scanDirectory();
     void detectFormat();
+    bool findTile(int z, int x, int y, std::string &path, std::string &contentType) const;
+
+protected:
+    Tile loadTile(int z, int x, int y, std::string &contentType) override;
 
 public:
     FileSystemTiles() = default;
     ~FileSystemTiles() override = default;
 
     bool open(const std::string &directoryPath) override;
-    const std::vector<unsigned char> &getTile(int z, int x, int y, std::string &contentType) override;
+    bool getTileFile(int z, int x, int y, std::string &path, std::string &contentType) override;
     std::string generatePluginCode(bool overlay) const override;
 };
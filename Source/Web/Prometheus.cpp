@@ -15,6 +15,8 @@
 	along with this program.  If not, see <https://www.gnu.org/licenses/>.
 */
 
+#include <cstdio>
+
 #include "Prometheus.h"
 
 const std::string ShippingClassNames[] = {
@@ -34,110 +36,233 @@ const std::string ShippingClassNames[] = {
 	"Search and Rescue Transponder EPIRB" // CLASS_SARTEPIRB
 };
 
+const float PrometheusCounter::level_bounds[LEVEL_BUCKETS] = {-60, -50, -45, -40, -35, -30, -25, -20, -15, -10, -5, 0};
+const float PrometheusCounter::ppm_bounds[PPM_BUCKETS] = {-20, -10, -5, -3, -2, -1, 0, 1, 2, 3, 5, 10, 20};
+
+static const std::memory_order relaxed = std::memory_order_relaxed;
+
+// a reader between the two halves can be off by one carry, like ByteCounter
+void PrometheusCounter::Sum::add(int32_t v)
+{
+	uint32_t add = (uint32_t)v;
+	uint32_t before = lo.fetch_add(add, relaxed);
+	uint32_t h = (v < 0 ? 0xFFFFFFFFu : 0u) + (before + add < before ? 1u : 0u);
+	if (h)
+		hi.fetch_add(h, relaxed);
+}
+
+int64_t PrometheusCounter::Sum::get() const
+{
+	return (int64_t)(((uint64_t)hi.load(relaxed) << 32) | lo.load(relaxed));
+}
+
+void PrometheusCounter::Sum::clear()
+{
+	lo.store(0, relaxed);
+	hi.store(0, relaxed);
+}
+
+template <int NB>
+void PrometheusCounter::Histogram<NB>::add(float v, const float *bounds)
+{
+	int b = 0;
+	while (b < NB && v > bounds[b])
+		b++;
+
+	bucket[b].fetch_add(1, relaxed);
+	count.fetch_add(1, relaxed);
+	sum.add((int32_t)(v * 100.0f));
+}
+
+template <int NB>
+void PrometheusCounter::Histogram<NB>::clear()
+{
+	for (auto &b : bucket)
+		b.store(0, relaxed);
+	count.store(0, relaxed);
+	sum.clear();
+}
+
+template <int NB>
+void PrometheusCounter::Histogram<NB>::write(std::string &out, const char *name, const std::string &labels, const float *bounds) const
+{
+	char line[256];
+	uint32_t cumulative = 0;
+
+	for (int b = 0; b <= NB; b++)
+	{
+		cumulative += bucket[b].load(relaxed);
+		if (b < NB)
+			snprintf(line, sizeof(line), "%s_bucket{%s,le=\"%g\"} %u\n", name, labels.c_str(), bounds[b], cumulative);
+		else
+			snprintf(line, sizeof(line), "%s_bucket{%s,le=\"+Inf\"} %u\n", name, labels.c_str(), cumulative);
+		out += line;
+	}
+
+	// count is the +Inf bucket so the two always agree within one scrape
+	snprintf(line, sizeof(line), "%s_sum{%s} %.2f\n%s_count{%s} %u\n", name, labels.c_str(), sum.get() / 100.0, name, labels.c_str(), cumulative);
+	out += line;
+}
+
 PrometheusCounter::PrometheusCounter()
 {
+	series[0].labels = "channel=\"other\",station_id=\"other\"";
+
 	Reset();
 	Clear();
 }
 
 void PrometheusCounter::Clear()
 {
+	for (auto &m : _msg)
+		m.store(0, relaxed);
+	for (auto &c : _channel)
+		c.store(0, relaxed);
+
+	_count.store(0, relaxed);
+	_distance.store(0, relaxed);
 
-	mtx.lock();
-	std::memset(_msg, 0, sizeof(_msg));
-	std::memset(_channel, 0, sizeof(_channel));
+	for (int i = 0; i < MAX_SERIES; i++)
+	{
+		series[i].level.clear();
+		series[i].ppm.clear();
+	}
+}
 
-	_count = 0;
-	_distance = 0;
+void PrometheusCounter::setSamples(int n)
+{
+	std::lock_guard<std::mutex> l(mtx);
 
-	mtx.unlock();
+	max_samples = n;
+	resetSamples();
 }
 
-void PrometheusCounter::Add(const AIS::Message &m, const TAG &tag)
+PrometheusCounter::Series &PrometheusCounter::getSeries(char channel, int station)
 {
+	int key = (station << 3) | (channel >= 'A' && channel <= 'D' ? channel - 'A' : 4);
 
-	if (m.type() > 28 || m.type() < 1)
-		return;
-	if (tag.shipclass < 0 || tag.shipclass > 13)
-		return;
+	int n = n_series.load(std::memory_order_acquire);
+	for (int i = 1; i < n; i++)
+		if (series[i].key == key)
+			return series[i];
+
+	std::lock_guard<std::mutex> l(mtx);
+
+	n = n_series.load(relaxed);
+	for (int i = 1; i < n; i++)
+		if (series[i].key == key)
+			return series[i];
+
+	if (n == MAX_SERIES)
+		return series[0];
+
+	Series &s = series[n];
+	s.key = key;
+	s.labels = std::string("channel=\"") + ((key & 7) < 4 ? channel : '?') + "\",station_id=\"" + std::to_string(station) + "\"";
+	n_series.store(n + 1, std::memory_order_release);
+	return s;
+}
 
+void PrometheusCounter::addSample(const AIS::Message &m, const TAG &tag)
+{
 	const char *speed = tag.speed < 0 ? "Unknown" : (tag.speed > 0.5 ? "Moving" : "Stationary");
 	char ch = m.getChannel();
+	char line[512];
+	std::string sample;
 
-	auto labels = [&](std::string &out) {
-		out += "type=\"" + std::to_string(m.type()) + "\",mmsi=\"" + std::to_string(m.mmsi()) + "\",station_id=\"" + std::to_string(m.getStation()) + "\",speed=\"" + speed + "\",shipclass=\"" + ShippingClassNames[tag.shipclass] + "\",channel=\"" + std::string(1, ch) + "\"";
+	auto add = [&](const char *name, float v) {
+		snprintf(line, sizeof(line), "%s{type=\"%d\",mmsi=\"%u\",station_id=\"%d\",speed=\"%s\",shipclass=\"%s\",channel=\"%c\"} %f\n",
+				 name, m.type(), m.mmsi(), m.getStation(), speed, ShippingClassNames[tag.shipclass].c_str(), ch, v);
+		sample += line;
 	};
 
 	if (tag.ppm < 1000)
+		add("ais_msg_ppm", tag.ppm);
+	if (tag.level < 1000)
+		add("ais_msg_level", tag.level);
+
+	std::lock_guard<std::mutex> l(mtx);
+
+	const int n = max_samples.load(relaxed);
+	if (n <= 0)
+		return;
+
+	if (samples.size() < (size_t)n)
+		samples.push_back(std::move(sample));
+	else
 	{
-		ppm += "ais_msg_ppm{";
-		labels(ppm);
-		ppm += "} " + std::to_string(tag.ppm) + "\n";
+		samples[sample_next] = std::move(sample);
+		sample_next = (sample_next + 1) % samples.size();
 	}
+}
 
-	if (tag.level < 1000)
+void PrometheusCounter::Add(const AIS::Message &m, const TAG &tag)
+{
+
+	if (m.type() > 28 || m.type() < 1)
+		return;
+	if (tag.shipclass < 0 || tag.shipclass > 13)
+		return;
+
+	if (tag.ppm < 1000 || tag.level < 1000)
 	{
-		level += "ais_msg_level{";
-		labels(level);
-		level += "} " + std::to_string(tag.level) + "\n";
+		Series &s = getSeries(m.getChannel(), m.getStation());
+
+		if (tag.level < 1000)
+			s.level.add(tag.level, level_bounds);
+		if (tag.ppm < 1000)
+			s.ppm.add(tag.ppm, ppm_bounds);
 	}
 
-	_count++;
-	_msg[m.type() - 1]++;
+	if (max_samples.load(relaxed) > 0)
+		addSample(m, tag);
+
+	_count.fetch_add(1, relaxed);
+	_msg[m.type() - 1].fetch_add(1, relaxed);
 
 	if (m.getChannel() >= 'A' && m.getChannel() <= 'D')
-		_channel[m.getChannel() - 'A']++;
+		_channel[m.getChannel() - 'A'].fetch_add(1, relaxed);
 
-	if (tag.distance > _distance)
-	{
-		_distance = tag.distance;
-	}
+	float d = _distance.load(relaxed);
+	while (tag.distance > d && !_distance.compare_exchange_weak(d, tag.distance, relaxed))
+		;
 }
 
 void PrometheusCounter::Receive(const JSON::JSON *json, int len, TAG &tag)
 {
-	AIS::Message &data = *((AIS::Message *)json[0].binary);
-
-	mtx.lock();
-
-	if (ppm.size() <= 32768 && level.size() <= 32768)
-		Add(data, tag);
-
-	mtx.unlock();
+	Add(*((AIS::Message *)json[0].binary), tag);
 }
 
 void PrometheusCounter::resetSamples()
 {
-	ppm = "# HELP ais_msg_ppm\n# TYPE ais_msg_ppm gauge\n";
-	level = "# HELP ais_msg_level\n# TYPE ais_msg_level gauge\n";
+	samples.clear();
+	sample_next = 0;
 }
 
 void PrometheusCounter::Reset()
 {
-	mtx.lock();
+	std::lock_guard<std::mutex> l(mtx);
 	resetSamples();
-	mtx.unlock();
 }
 
 std::string PrometheusCounter::toPrometheus()
 {
-	mtx.lock();
 	std::string element;
 
 	element += "# HELP ais_stat_count Total number of messages\n";
 	element += "# TYPE ais_stat_count counter\n";
-	element += "ais_stat_count " + std::to_string(_count) + "\n";
+	element += "ais_stat_count " + std::to_string(_count.load(relaxed)) + "\n";
 
 	element += "# HELP ais_stat_distance Longest distance\n";
 	element += "# TYPE ais_stat_distance gauge\n";
-	element += "ais_stat_distance " + std::to_string(_distance) + "\n";
+	element += "ais_stat_distance " + std::to_string(_distance.load(relaxed)) + "\n";
 
 	for (int i = 0; i < 4; i++)
 	{
 		std::string ch(1, i + 'A');
 		element += "# HELP ais_stat_count_channel_" + ch + " Total number of messages on channel " + ch + "\n";
 		element += "# TYPE ais_stat_count_channel_" + ch + " counter\n";
-		element += "ais_stat_count_channel_" + ch + " " + std::to_string(_channel[i]) + "\n";
+		element += "ais_stat_count_channel_" + ch + " " + std::to_string(_channel[i].load(relaxed)) + "\n";
 	}
 
 	for (int i = 0; i < 28; i++)
@@ -145,12 +270,42 @@ std::string PrometheusCounter::toPrometheus()
 		std::string type = std::to_string(i + 1);
 		element += "# HELP ais_stat_count_type_" + type + " Total number of messages of type " + type + "\n";
 		element += "# TYPE ais_stat_count_type_" + type + " counter\n";
-		element += "ais_stat_count_type_" + type + " " + std::to_string(_msg[i]) + "\n";
+		element += "ais_stat_count_type_" + type + " " + std::to_string(_msg[i].load(relaxed)) + "\n";
 	}
 
-	// drain must share the lock with the read or samples in between are lost
-	element += ppm + level;
-	resetSamples();
-	mtx.unlock();
+	int n = n_series.load(std::memory_order_acquire);
+
+	element += "# HELP ais_signal_level Signal level of received messages in dB\n";
+	element += "# TYPE ais_signal_level histogram\n";
+	for (int i = 0; i < n; i++)
+		if (i > 0 || series[0].level.count.load(relaxed))
+			series[i].level.write(element, "ais_signal_level", series[i].labels, level_bounds);
+
+	element += "# HELP ais_signal_ppm Frequency offset of received messages in ppm\n";
+	element += "# TYPE ais_signal_ppm histogram\n";
+	for (int i = 0; i < n; i++)
+		if (i > 0 || series[0].ppm.count.load(relaxed))
+			series[i].ppm.write(element, "ais_signal_ppm", series[i].labels, ppm_bounds);
+
+	std::lock_guard<std::mutex> l(mtx);
+
+	if (max_samples.load(relaxed) > 0)
+	{
+		// drain must share the lock with the read or samples in between are lost
+		std::string ppm = "# HELP ais_msg_ppm\n# TYPE ais_msg_ppm gauge\n";
+		std::string level = "# HELP ais_msg_level\n# TYPE ais_msg_level gauge\n";
+
+		// oldest first: a full ring starts at the next slot to be overwritten
+		for (size_t i = 0; i < samples.size(); i++)
+		{
+			const std::string &s = samples[(sample_next + i) % samples.size()];
+			size_t split = s.find("ais_msg_level");
+			ppm.append(s, 0, split);
+			if (split != std::string::npos)
+				level.append(s, split, std::string::npos);
+		}
+		element += ppm + level;
+		resetSamples();
+	}
 	return element;
 }
@@ -16,25 +16,75 @@
 */
 
 #pragma once
+#include <atomic>
 #include <iostream>
 #include <string.h>
 #include <mutex>
+#include <vector>
 
 #include "AIS-catcher.h"
 #include "JSONAIS.h"
 
+// Metrics for /metrics. Signal level and frequency offset are exported as
+// histograms per channel and station, so the series count is fixed however
+// many vessels are heard. Per-message samples are optional and bounded.
 class PrometheusCounter : public StreamIn<JSON::JSON> {
-	std::mutex mtx;
 
-	unsigned int _count;
-	unsigned int _msg[28];
-	unsigned int _channel[4];
+	// channel x station label sets; the rest share one overflow series
+	static const int MAX_SERIES = 64;
+
+	static const int LEVEL_BUCKETS = 12;
+	static const int PPM_BUCKETS = 13;
+	static const float level_bounds[LEVEL_BUCKETS];
+	static const float ppm_bounds[PPM_BUCKETS];
+
+	// fixed point sum in two 32-bit halves, armv6 has no 64-bit atomics
+	struct Sum {
+		std::atomic<uint32_t> lo{0}, hi{0};
+
+		void add(int32_t v);
+		int64_t get() const;
+		void clear();
+	};
+
+	template <int NB>
+	struct Histogram {
+		std::atomic<uint32_t> bucket[NB + 1]; // per bucket, last is +Inf
+		std::atomic<uint32_t> count{0};
+		Sum sum; // in 1/100 units
+
+		Histogram() { clear(); }
+		void add(float v, const float *bounds);
+		void clear();
+		void write(std::string &out, const char *name, const std::string &labels, const float *bounds) const;
+	};
+
+	struct Series {
+		int key = -1;
+		std::string labels; // preformatted, set before the series is published
+		Histogram<LEVEL_BUCKETS> level;
+		Histogram<PPM_BUCKETS> ppm;
+	};
+
+	// series[0] is the overflow series; entries below n_series are immutable but for their counts
+	Series series[MAX_SERIES];
+	std::atomic<int> n_series{1};
+
+	// guards series creation and the sample ring
+	std::mutex mtx;
 
-	float _distance;
+	std::atomic<unsigned int> _count;
+	std::atomic<unsigned int> _msg[28];
+	std::atomic<unsigned int> _channel[4];
+	std::atomic<float> _distance;
 
-	std::string ppm;
-	std::string level;
+	// last messages as labelled gauges, drained by each scrape
+	std::atomic<int> max_samples{0};
+	std::vector<std::string> samples;
+	size_t sample_next = 0; // oldest sample once the ring is full
 
+	Series &getSeries(char channel, int station);
+	void addSample(const AIS::Message &m, const TAG &tag);
 	void Add(const AIS::Message& m, const TAG& tag);
 	void Clear();
 	void resetSamples(); // caller must hold mtx
@@ -44,8 +94,9 @@ public:
 	virtual ~PrometheusCounter() {}
 
 	void Reset();
+	void setSamples(int n);
 
-	int getCount() { return _count; }
+	int getCount() { return _count.load(std::memory_order_relaxed); }
 
 	void Receive(const JSON::JSON* json, int len, TAG& tag);
 	std::string toPrometheus();
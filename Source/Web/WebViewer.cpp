@@ -328,7 +328,7 @@ void WebViewer::wireAggregate(const std::vector<std::unique_ptr<Receiver>> &rece
 		}
 
 		states[0]->appendModel(r.Model(j)->getName(), !first_of_device);
-		states[0]->connectJSON(r.OutputJSON(j));
+		states[0]->connectJSON(r.OutputJSON(j, ReceiverTracker::jsonKeys()));
 		states[0]->connectGPS(r.OutputGPS(j));
 		r.OutputADSB(j).Connect((StreamIn<Plane::ADSB> *)&planes);
 
@@ -386,7 +386,7 @@ void WebViewer::attachTrackers(const std::vector<std::unique_ptr<Receiver>> &rec
 		tracker->key = n.key;
 		tracker->model_name = {r.Model(j)->getName()};
 
-		tracker->connectJSON(r.OutputJSON(j));
+		tracker->connectJSON(r.OutputJSON(j, ReceiverTracker::jsonKeys()));
 		tracker->connectGPS(r.OutputGPS(j));
 
 		// a reclaimed tracker is already set up and was rewired by applySettings()
@@ -574,6 +574,9 @@ void WebViewer::applySettings()
 		s->wireStreams();
 	}
 
+	// a directory takes one writer, the aggregate tracker
+	states[0]->setTrackDir(settings.tracking.track_dir);
+
 	if (settings.realtime)
 	{
 		states[0]->connectSink(sse_streamer);
@@ -581,7 +584,10 @@ void WebViewer::applySettings()
 	}
 
 	if (settings.supportPrometheus)
+	{
+		dataPrometheus.setSamples(settings.prometheus_samples);
 		states[0]->connectSink(dataPrometheus);
+	}
 
 	logger.Stop();
 	if (settings.showlog)
@@ -650,6 +656,7 @@ void WebViewer::startServing()
 		Info() << "Webviewer: port " << bound_port
 			   << (tc.track_time != 3600 ? ", track_time: " + std::to_string(tc.track_time) + "s" : std::string())
 			   << (tc.track_memory > 0 ? ", track_memory: " + std::to_string(tc.track_memory) + " KB" : std::string())
+			   << (!tc.track_dir.empty() ? ", track_dir: " + tc.track_dir : std::string())
 			   << (tc.cutoff > 0 ? ", cutoff: " + std::to_string(tc.cutoff) : std::string())
 			   << (tc.server_mode ? ", server_mode: on" : "")
 			   << ", realtime: " << on(settings.realtime)
@@ -830,6 +837,8 @@ std::string WebViewer::buildMultiPathJSON(ReceiverTracker *s, const std::string
 // block, which is the intended effect.
 static const std::time_t REPLAY_BLOCK = 600;
 static const long long MAX_REPLAY_LOOKBACK = 7 * 24 * 3600;
+// events sent per poll; the returned cursor picks up the rest
+static const std::size_t MAX_EVENTS = 1000;
 
 // Checked before it is multiplied by anything: a negative index yields a
 // negative `until`, which the path writer reads as "no upper bound".
@@ -863,6 +872,16 @@ const WebViewer::Route WebViewer::routes[] = {
 	{"/api/binmsgs.json", nullptr, "application/json",
 	 [](WebViewer *, ReceiverTracker *s, const std::string &a)
 	 { return s->getBinaryMessagesJSON(queryInt(a, "since")); }, true},
+	{"/api/events.json", nullptr, "application/json",
+	 [](WebViewer *, ReceiverTracker *s, const std::string &a)
+	 {
+		 long long cursor = queryInt(a, "cursor");
+		 long long max = queryInt(a, "max");
+		 std::string kind = IO::HTTPRequest::queryParam(a, "kind");
+		 return s->getEventsJSON(cursor > 0 ? (uint64_t)cursor : 0,
+								 max > 0 && max < MAX_EVENTS ? (std::size_t)max : MAX_EVENTS,
+								 kind == "change" ? EventLog::CHANGE : kind == "binary" ? EventLog::BINARY : 0);
+	 }, true},
 	{"/api/history_full.json", nullptr, "application/json",
 	 [](WebViewer *, ReceiverTracker *s, const std::string &)
 	 { return s->toHistoryJSON(); }, true},
@@ -1070,12 +1089,19 @@ void WebViewer::Request(IO::TCPServerConnection &c, const IO::HTTPRequest &reque
 				if (source->getLayerID() != layer)
 					continue;
 
-				std::string contentType;
-				const std::vector<unsigned char> &data = source->getTile(z, x, y, contentType);
+				std::string contentType, path;
+				if (source->getTileFile(z, x, y, path, contentType) && ResponseFile(c, contentType, path, true))
+					return;
+
+				MapTiles::Tile tile = source->getTile(z, x, y, contentType);
 
-				if (!data.empty())
+				if (tile && !tile->empty())
 				{
-					Response(c, contentType, (char *)data.data(), data.size(), settings.use_zlib && gzip, true);
+					// a tile stored gzipped goes out as is, and only vector tiles gain from compressing
+					if (MapTiles::isGzip(*tile))
+						ResponseRaw(c, contentType, (const char *)tile->data(), (int)tile->size(), gzip, true);
+					else
+						Response(c, contentType, (const char *)tile->data(), (int)tile->size(), settings.use_zlib && gzip && MapTiles::isCompressible(contentType), true);
 					return;
 				}
 			}
@@ -1186,6 +1212,15 @@ Setting &WebViewer::SetKey(AIS::Keys key, const std::string &arg)
 	case AIS::KEY_SETTING_TRACK_MEMORY:
 		settings.tracking.track_memory = Util::Parse::Integer(arg, 16, 256 * 1024);
 		break;
+	case AIS::KEY_SETTING_TRACK_DIR:
+		settings.tracking.track_dir = arg;
+		break;
+	case AIS::KEY_SETTING_EVENTS_MAX:
+		settings.tracking.events_max = Util::Parse::Integer(arg, 0, 1000000);
+		break;
+	case AIS::KEY_SETTING_EVENTS_KB:
+		settings.tracking.events_kb = Util::Parse::Integer(arg, 0, 256 * 1024);
+		break;
 	case AIS::KEY_SETTING_REPLAY:
 		settings.replay = Util::Parse::Switch(arg);
 		frontend.setReplay(settings.replay);
@@ -1287,6 +1322,9 @@ Setting &WebViewer::SetKey(AIS::Keys key, const std::string &arg)
 	case AIS::KEY_SETTING_PROME:
 		settings.supportPrometheus = Util::Parse::Switch(arg);
 		break;
+	case AIS::KEY_SETTING_PROME_SAMPLES:
+		settings.prometheus_samples = Util::Parse::Integer(arg, 0, 10000);
+		break;
 	case AIS::KEY_SETTING_REUSE_PORT:
 		setReusePort(Util::Parse::Switch(arg));
 		break;
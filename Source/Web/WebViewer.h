@@ -110,6 +110,8 @@ public:
 		bool KML = false;
 		bool GeoJSON = false;
 		bool supportPrometheus = false;
+		// per-message samples kept between scrapes, 0 exports histograms only
+		int prometheus_samples = 0;
 		bool replay = true;
 		bool split = true;
 
@@ -248,9 +250,11 @@ public:
 	// settings that need more than a stored value: sinks, log listener, backup
 	void applySettings();
 
-	void setOutputChannels(const std::vector<std::unique_ptr<IO::OutputMessage>> &msg)
+	// null while the engine rebuilds the list
+	void setOutputChannels(const std::vector<std::unique_ptr<IO::OutputMessage>> *msg)
 	{
-		msg_channels = &msg;
+		std::lock_guard<std::recursive_mutex> lock(state_mtx);
+		msg_channels = msg;
 	}
 
 	void setCommFeed(IO::OutputMessage *f)
@@ -0,0 +1,27 @@
+# Find zstd
+if(ZSTD)
+    if(MSVC)
+        find_path(ZSTD_INCLUDE_DIR zstd.h HINTS ${POTHOSSDR_INCLUDE_DIR})
+        find_library(ZSTD_LIBRARY NAMES zstd libzstd HINTS ${POTHOSSDR_LIBRARY_DIR})
+    else()
+        pkg_check_modules(PKG_ZSTD libzstd)
+        find_path(ZSTD_INCLUDE_DIR zstd.h HINTS ${PKG_ZSTD_INCLUDE_DIRS})
+        if(STATIC)
+            find_library(ZSTD_LIBRARY libzstd.a HINTS ${PKG_ZSTD_LIBRARY_DIRS})
+        else()
+            find_library(ZSTD_LIBRARY NAMES zstd HINTS ${PKG_ZSTD_LIBRARY_DIRS})
+        endif()
+    endif()
+
+    if(ZSTD_INCLUDE_DIR AND ZSTD_LIBRARY)
+
+        message(STATUS "ZSTD: found - ${ZSTD_INCLUDE_DIR}, ${ZSTD_LIBRARY}")
+        add_definitions(-DHASZSTD)
+
+        set(ZSTD_INCLUDE_DIRS ${ZSTD_INCLUDE_DIR})
+        set(ZSTD_LIBRARIES ${ZSTD_LIBRARY})
+
+    else()
+        message(STATUS "ZSTD: not found - ${ZSTD_INCLUDE_DIR}, ${ZSTD_LIBRARY}")
+    endif()
+endif()
@@ -372,7 +372,8 @@ const dbSchema = {
         options: [
             { value: 'sqlite', label: 'SQLite (local file)' },
             { value: 'postgres', label: 'PostgreSQL' },
-            { value: 'csv', label: 'CSV files' }
+            { value: 'csv', label: 'CSV files' },
+            { value: 'archive', label: 'Compressed archive' }
         ],
         width: 40
     },
@@ -383,7 +384,7 @@ const dbSchema = {
         type: 'text',
         jsonpath: 'conn_str',
         placeholder: 'ais.db  ·  dbname=ais  ·  /var/log/ais',
-        tooltip: 'File for SQLite, libpq connection string for PostgreSQL, directory for CSV',
+        tooltip: 'File for SQLite, libpq connection string for PostgreSQL, directory for CSV and archive',
         width: 60
     },
     retention: {
@@ -481,6 +482,19 @@ const dbSchema = {
         defaultValue: 60,
         advanced: true
     },
+    bulk: {
+        name: 'bulk',
+        label: 'Bulk Load',
+        type: 'toggle',
+        jsonpath: 'bulk',
+        defaultValue: false,
+        advanced: true,
+        tooltip: 'PostgreSQL only: stream each write cycle with COPY instead of one insert per row',
+        dependsOn: {
+            field: 'type',
+            value: 'postgres'
+        }
+    },
     unique: ChannelFields.unique(),
     position_interval: ChannelFields.position_interval(),
     zones: ChannelFields.zones()
@@ -527,6 +541,52 @@ const mqttSchema = {
             { value: '2', label: '2 - Exactly once' }
         ],
     },
+    window: {
+        name: 'window',
+        section: 'Connection',
+        label: 'In-flight Window',
+        type: 'number',
+        min: 1,
+        max: 1024,
+        defaultValue: 32,
+        width: 33,
+        advanced: true,
+        tooltip: 'Publishes sent ahead before the first acknowledgement is needed',
+        dependsOn: {
+            field: 'qos',
+            value: ['1', '2']
+        }
+    },
+    backlog: {
+        name: 'backlog',
+        section: 'Connection',
+        label: 'Backlog',
+        type: 'number',
+        min: 1,
+        max: 1000000,
+        defaultValue: 4096,
+        width: 33,
+        advanced: true,
+        tooltip: 'Messages kept while the window is full or the broker is unreachable',
+        dependsOn: {
+            field: 'qos',
+            value: ['1', '2']
+        }
+    },
+    spill: {
+        name: 'spill',
+        section: 'Connection',
+        label: 'Spill File',
+        type: 'text',
+        width: 34,
+        advanced: true,
+        placeholder: 'Optional, e.g. /var/lib/ais/mqtt.spill',
+        tooltip: 'A full backlog overflows to this file instead of dropping the oldest messages',
+        dependsOn: {
+            field: 'qos',
+            value: ['1', '2']
+        }
+    },
     msgformat: ChannelFields.msgformat('JSON_FULL'),
     unique: ChannelFields.unique(),
     position_interval: ChannelFields.position_interval(),
@@ -668,6 +728,43 @@ const webviewerSchema = {
         width: 50,
         tooltip: 'More memory keeps longer track history'
     },
+    track_dir: {
+        name: 'track_dir',
+        section: 'Tracks',
+        restartWebviewer: true,
+        label: 'Track Directory',
+        type: 'text',
+        jsonpath: 'track_dir',
+        defaultValue: '',
+        width: 100,
+        tooltip: 'Keeps track history that no longer fits in memory on disk, for multi-day replay'
+    },
+    events_max: {
+        name: 'events_max',
+        section: 'Tracks',
+        restartWebviewer: true,
+        label: 'Event Log Entries',
+        type: 'number',
+        jsonpath: 'events_max',
+        defaultValue: 4096,
+        min: 0,
+        max: 1000000,
+        width: 50,
+        tooltip: 'Ship changes and binary messages kept for polling /api/events.json, 0 for no limit'
+    },
+    events_kb: {
+        name: 'events_kb',
+        section: 'Tracks',
+        restartWebviewer: true,
+        label: 'Event Log Memory (KB)',
+        type: 'number',
+        jsonpath: 'events_kb',
+        defaultValue: 1024,
+        min: 0,
+        max: 262144,
+        width: 50,
+        tooltip: 'Memory budget for the event log, 0 for no limit'
+    },
     replay: {
         name: 'replay',
         section: 'Service',
@@ -801,6 +898,20 @@ const webviewerSchema = {
         width: 24,
         tooltip: 'Metrics served at /metrics'
     },
+    prome_samples: {
+        name: 'prome_samples',
+        section: 'Service',
+        restartWebviewer: true,
+        label: 'Prometheus samples',
+        type: 'number',
+        jsonpath: 'prome_samples',
+        defaultValue: 0,
+        min: 0,
+        max: 10000,
+        width: 24,
+        dependsOn: { field: 'prome', value: true },
+        tooltip: 'Latest messages exported per scrape with MMSI labels, 0 for histograms only'
+    },
     log: {
         name: 'log',
         section: 'Features',
@@ -891,6 +1002,7 @@ const receiverSchema = {
             { value: "HYDRASDR", label: "HydraSDR" },
             { value: "SERIALPORT", label: "SERIAL" },
             { value: "UDPSERVER", label: "UDP Server" },
+            { value: "TCPSERVER", label: "TCP Server" },
             { value: "RTLTCP", label: "TCP Client" },
             { value: "SPYSERVER", label: "SPYSERVER" },
             { value: "NMEA2000", label: "NMEA2000" }
@@ -1404,6 +1516,108 @@ const receiverSchema = {
         },
         width: 25
     },
+    udpserver_workers: {
+        name: "udpserver_workers",
+        label: "Workers",
+        type: "number",
+        jsonpath: "udpserver.workers",
+        min: 1,
+        max: 64,
+        placeholder: "1",
+        tooltip: "Sockets sharing the port with SO_REUSEPORT, each on its own thread (Linux/BSD)",
+        advanced: true,
+        dependsOn: {
+            field: "input",
+            value: "UDPSERVER"
+        },
+        width: 50
+    },
+    udpserver_batch: {
+        name: "udpserver_batch",
+        label: "Batch",
+        type: "number",
+        jsonpath: "udpserver.batch",
+        min: 1,
+        max: 1024,
+        placeholder: "32",
+        tooltip: "Datagrams taken per receive call",
+        advanced: true,
+        dependsOn: {
+            field: "input",
+            value: "UDPSERVER"
+        },
+        width: 50
+    },
+    tcpserver_server: {
+        name: "tcpserver_server",
+        label: "Server Address",
+        type: "text",
+        jsonpath: "tcpserver.server",
+        placeholder: "e.g., 0.0.0.0",
+        tooltip: "Local address stations connect to",
+        dependsOn: {
+            field: "input",
+            value: "TCPSERVER"
+        },
+        width: 75
+    },
+    tcpserver_port: {
+        name: "tcpserver_port",
+        label: "Port",
+        type: "number",
+        jsonpath: "tcpserver.port",
+        placeholder: "e.g., 5631",
+        dependsOn: {
+            field: "input",
+            value: "TCPSERVER"
+        },
+        width: 25
+    },
+    tcpserver_workers: {
+        name: "tcpserver_workers",
+        label: "Workers",
+        type: "number",
+        jsonpath: "tcpserver.workers",
+        min: 1,
+        max: 64,
+        placeholder: "1",
+        tooltip: "Threads sharing the connections, each with its own SO_REUSEPORT listener (Linux/BSD)",
+        advanced: true,
+        dependsOn: {
+            field: "input",
+            value: "TCPSERVER"
+        },
+        width: 50
+    },
+    tcpserver_timeout: {
+        name: "tcpserver_timeout",
+        label: "Idle Timeout (s)",
+        type: "number",
+        jsonpath: "tcpserver.timeout",
+        min: 0,
+        max: 86400,
+        placeholder: "0 (never)",
+        tooltip: "Drop a station that sent nothing for this long",
+        advanced: true,
+        dependsOn: {
+            field: "input",
+            value: "TCPSERVER"
+        },
+        width: 50
+    },
+    tcpserver_station_map: {
+        name: "tcpserver_station_map",
+        label: "Station Map",
+        type: "text",
+        jsonpath: "tcpserver.station_map",
+        placeholder: "e.g., 10.0.0.5=101,10.0.0.6=102",
+        tooltip: "Station id per sender address, applied to sentences without their own tag block",
+        advanced: true,
+        dependsOn: {
+            field: "input",
+            value: "TCPSERVER"
+        }
+    },
     hackrf_lna: {
         name: "hackrf_lna",
         label: "LNA Gain",
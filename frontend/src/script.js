@@ -3048,6 +3048,8 @@ async function updateStatistics() {
                     html += `<div><span>Reconnects</span><span>${s.reconnects}</span></div>`;
                 if (s.dropped > 0)
                     html += `<div><span>Dropped</span><span>${s.dropped}</span></div>`;
+                if (s.rows_out > 0)
+                    html += `<div><span>Rows / last flush</span><span>${s.rows_out} / ${s.rows_per_sec} rows/s in ${s.flush_ms} ms</span></div>`;
                 html += "</section>";
             }
             outputSection.innerHTML = html;
@@ -1,11 +1,13 @@
 """aiscat — fast Python bindings for AIS-catcher's NMEA-to-JSON AIS decoder."""
 
+import mmap
 import os
 import socket
 import sys
 from importlib.metadata import PackageNotFoundError, version as _pkg_version
 
-from ._core import Decoder
+from ._core import Decoder, FileDecoder
+from ._core import decode_columns as _decode_columns
 from .types import AISMessage
 
 try:
@@ -15,8 +17,11 @@ except PackageNotFoundError:
 __all__ = [
     "Decoder",
     "decode",
+    "decode_columns",
     "iter_decode",
     "from_file",
+    "decode_file",
+    "decode_files",
     "from_stdin",
     "from_tcp",
     "from_udp",
@@ -98,6 +103,106 @@ def from_file(path, *, format="dictionary", country=False, chunk=65536):
             f.close()
 
 
+def decode_files(paths, *, format="dictionary", country=False, threads=None, chunk=1 << 22):
+    """Decode whole files on a pool of native threads; yields messages in input order.
+
+    The files are memory-mapped and cut into chunks of about ``chunk`` bytes at
+    line boundaries, never inside a multipart message, and each chunk decodes
+    on its own thread (``threads`` defaults to the number of CPUs). Parsing
+    runs without the GIL; the ``dictionary`` and ``annotated`` formats take it
+    to build their dicts, so they scale fully only on free-threaded Python,
+    while the bytes formats scale on any build.
+
+    Input is taken line by line (NMEA with or without tag blocks, JSON lines).
+    Takes the same ``format`` / ``country`` kwargs as ``Decoder``. The returned
+    iterator must not be shared between threads.
+    """
+    maps = []
+    for path in paths:
+        with open(path, "rb") as f:
+            if os.fstat(f.fileno()).st_size:
+                maps.append(mmap.mmap(f.fileno(), 0, access=mmap.ACCESS_READ))
+    return FileDecoder(maps, format=format, country=country,
+                       threads=threads or os.cpu_count() or 1, chunk=chunk)
+
+
+def decode_file(path, **kwargs):
+    """Decode one file on a pool of native threads. See ``decode_files``."""
+    return decode_files([path], **kwargs)
+
+
+def decode_columns(source, *, families=None, format="numpy"):
+    """Decode a whole buffer or file into columns, one table per message family.
+
+    ``source`` is bytes-like, a ``str`` of NMEA, or a file path (``os.PathLike``
+    or a ``str`` that names an existing file); files are memory-mapped. The
+    decode runs in C++ with the GIL released and builds no per-message objects.
+
+    Families (default: all) and the message types they collect:
+
+    - ``"position"`` — types 1, 2, 3, 18, 19, 27
+    - ``"static"`` — types 5, 19, 24 (static and voyage data)
+    - ``"base"`` — types 4, 11 (base station / UTC reports)
+
+    Columns are named after the AIS-catcher JSON keys, plus ``rxuxtime``.
+
+    ``format`` selects the table type:
+
+    - ``"numpy"`` (default) — NumPy structured array; a missing value is NaN
+      in float columns, -1 in integer columns and ``""`` in string columns
+    - ``"arrow"`` — ``pyarrow.RecordBatch`` with nulls for missing values
+    - ``"columns"`` — the raw ``(rows, {name: (dtype, values, validity, nulls)})``
+      tuple, with ``values`` native-endian bytes (a list for strings) and
+      ``validity`` an LSB-first bitmap; needs neither NumPy nor pyarrow
+    """
+    if format not in ("numpy", "arrow", "columns"):
+        raise ValueError(f"format must be one of 'numpy', 'arrow', 'columns'; got {format!r}")
+
+    if isinstance(source, os.PathLike) or (isinstance(source, str) and os.path.isfile(source)):
+        with open(source, "rb") as f:
+            if os.fstat(f.fileno()).st_size == 0:
+                raw = _decode_columns(b"", families)
+            else:
+                with mmap.mmap(f.fileno(), 0, access=mmap.ACCESS_READ) as m:
+                    raw = _decode_columns(m, families)
+    else:
+        raw = _decode_columns(source, families)
+
+    if format == "columns":
+        return raw
+    convert = _to_numpy if format == "numpy" else _to_arrow
+    return {name: convert(rows, cols) for name, (rows, cols) in raw.items()}
+
+
+def _to_numpy(rows, cols):
+    import numpy as np
+
+    arrays = {}
+    for name, (dtype, values, validity, nulls) in cols.items():
+        if dtype == "str":
+            arrays[name] = np.array(["" if v is None else v for v in values], dtype=str) if rows else np.array([], dtype="U1")
+        else:
+            arrays[name] = np.frombuffer(values, dtype=dtype)
+    out = np.empty(rows, dtype=[(name, a.dtype) for name, a in arrays.items()])
+    for name, a in arrays.items():
+        out[name] = a
+    return out
+
+
+def _to_arrow(rows, cols):
+    import pyarrow as pa
+
+    types = {"i4": pa.int32(), "f8": pa.float64()}
+    arrays = []
+    for name, (dtype, values, validity, nulls) in cols.items():
+        if dtype == "str":
+            arrays.append(pa.array(values, type=pa.string()))
+        else:
+            bitmap = pa.py_buffer(validity) if nulls else None
+            arrays.append(pa.Array.from_buffers(types[dtype], rows, [bitmap, pa.py_buffer(values)], null_count=nulls))
+    return pa.RecordBatch.from_arrays(arrays, names=list(cols))
+
+
 def from_stdin(**kwargs):
     """Yield decoded AIS messages from stdin. Accepts the same kwargs as ``from_file``."""
     return from_file(sys.stdin.buffer, **kwargs)
@@ -4,9 +4,15 @@
 #define PY_SSIZE_T_CLEAN
 #include <Python.h>
 
+#include <algorithm>
+#include <cmath>
+#include <condition_variable>
 #include <cstring>
 #include <deque>
+#include <mutex>
 #include <string>
+#include <thread>
+#include <vector>
 
 #include "Common.h"
 #include "Stream.h"
@@ -183,6 +189,45 @@ static PyObject *convert_value(const JSON::Value &v, bool annotated) {
     }
 }
 
+static bool is_dict(OutFormat f) {
+    return f == OutFormat::DICTIONARY || f == OutFormat::ANNOTATED;
+}
+
+// Renders a message in one of the bytes formats into out; false if the item
+// carries no message.
+static bool render_bytes(OutFormat format, const JSON::JSON &json, TAG &tag,
+                         JSON::Serializer &serializer, std::string &out) {
+    out.clear();
+    if (format == OutFormat::JSON) {
+        serializer.stringify(json, out);
+        return true;
+    }
+    auto *msg = static_cast<const AIS::Message *>(json.binary);
+    if (!msg) return false;
+    switch (format) {
+        case OutFormat::JSON_NMEA:
+            msg->getNMEAJSON(out, tag);
+            break;
+        case OutFormat::NMEA: {
+            auto sentences = msg->sentences();
+            for (size_t j = 0; j < sentences.size(); ++j) {
+                out.append(sentences[j]);
+                out.push_back('\n');
+            }
+            break;
+        }
+        case OutFormat::NMEA_TAG:
+            msg->getNMEATagBlock(out);
+            break;
+        case OutFormat::BINARY:
+            msg->getBinaryNMEA(out, tag);
+            break;
+        default:
+            return false;
+    }
+    return true;
+}
+
 class PySink : public StreamIn<JSON::JSON> {
 public:
     std::deque<PyObject *> queue;
@@ -193,65 +238,21 @@ public:
     void Receive(const JSON::JSON *data, int len, TAG &tag) override {
         for (int i = 0; i < len; ++i) {
             PyObject *d = nullptr;
-            switch (format) {
-                case OutFormat::DICTIONARY:
-                case OutFormat::ANNOTATED: {
-                    d = convert_object(data[i], format == OutFormat::ANNOTATED);
-                    auto *msg = static_cast<const AIS::Message *>(data[i].binary);
-                    if (d && msg) {
-                        PyObject *f = PyFloat_FromDouble((double)msg->getRxTimeMicros() / 1000000.0);
-                        if (f && format == OutFormat::ANNOTATED)
-                            f = wrap_annotated(f, AIS::KEY_RXUXTIME);
-                        if (!f || PyDict_SetItem(d, g_keys[AIS::KEY_RXUXTIME], f) < 0) {
-                            Py_XDECREF(f); Py_DECREF(d); d = nullptr;
-                        } else {
-                            Py_DECREF(f);
-                        }
+            if (is_dict(format)) {
+                d = convert_object(data[i], format == OutFormat::ANNOTATED);
+                auto *msg = static_cast<const AIS::Message *>(data[i].binary);
+                if (d && msg) {
+                    PyObject *f = PyFloat_FromDouble((double)msg->getRxTimeMicros() / 1000000.0);
+                    if (f && format == OutFormat::ANNOTATED)
+                        f = wrap_annotated(f, AIS::KEY_RXUXTIME);
+                    if (!f || PyDict_SetItem(d, g_keys[AIS::KEY_RXUXTIME], f) < 0) {
+                        Py_XDECREF(f); Py_DECREF(d); d = nullptr;
+                    } else {
+                        Py_DECREF(f);
                     }
-                    break;
-                }
-                case OutFormat::JSON: {
-                    scratch.clear();
-                    serializer.stringify(data[i], scratch);
-                    d = PyBytes_FromStringAndSize(scratch.data(), (Py_ssize_t)scratch.size());
-                    break;
-                }
-                case OutFormat::JSON_NMEA: {
-                    auto *msg = static_cast<const AIS::Message *>(data[i].binary);
-                    if (!msg) break;
-                    scratch.clear();
-                    msg->getNMEAJSON(scratch, tag);
-                    d = PyBytes_FromStringAndSize(scratch.data(), (Py_ssize_t)scratch.size());
-                    break;
-                }
-                case OutFormat::NMEA: {
-                    auto *msg = static_cast<const AIS::Message *>(data[i].binary);
-                    if (!msg) break;
-                    scratch.clear();
-                    auto sentences = msg->sentences();
-                    for (size_t j = 0; j < sentences.size(); ++j) {
-                        scratch.append(sentences[j]);
-                        scratch.push_back('\n');
-                    }
-                    d = PyBytes_FromStringAndSize(scratch.data(), (Py_ssize_t)scratch.size());
-                    break;
-                }
-                case OutFormat::NMEA_TAG: {
-                    auto *msg = static_cast<const AIS::Message *>(data[i].binary);
-                    if (!msg) break;
-                    scratch.clear();
-                    msg->getNMEATagBlock(scratch);
-                    d = PyBytes_FromStringAndSize(scratch.data(), (Py_ssize_t)scratch.size());
-                    break;
-                }
-                case OutFormat::BINARY: {
-                    auto *msg = static_cast<const AIS::Message *>(data[i].binary);
-                    if (!msg) break;
-                    scratch.clear();
-                    msg->getBinaryNMEA(scratch, tag);
-                    d = PyBytes_FromStringAndSize(scratch.data(), (Py_ssize_t)scratch.size());
-                    break;
                 }
+            } else if (render_bytes(format, data[i], tag, serializer, scratch)) {
+                d = PyBytes_FromStringAndSize(scratch.data(), (Py_ssize_t)scratch.size());
             }
             if (!d) {
                 if (PyErr_Occurred()) break;  // conversion failed; Decoder_feed propagates
@@ -266,6 +267,316 @@ public:
     }
 };
 
+// Bytes formats need no Python objects, so they are rendered off the GIL.
+class ByteSink : public StreamIn<JSON::JSON> {
+public:
+    OutFormat format = OutFormat::JSON;
+    std::vector<std::string> *out = nullptr;
+    JSON::Serializer serializer;
+    std::string scratch;
+
+    void Receive(const JSON::JSON *data, int len, TAG &tag) override {
+        for (int i = 0; i < len; ++i)
+            if (render_bytes(format, data[i], tag, serializer, scratch))
+                out->push_back(scratch);
+    }
+};
+
+// Mode bits of the TAG a pipeline runs with, as set up by Decoder_init.
+static void setup_tag(TAG &tag, OutFormat fmt, bool country) {
+    tag.clear();
+    if (country) tag.mode |= 4;  // enables JSONAIS::COUNTRY (MMSI prefix → country, country_code)
+    // Clearing mode bit 2 skips the rxtime string the dict formats would only
+    // discard (kSkipMask); PySink::Receive adds rxuxtime from the message.
+    if (is_dict(fmt)) tag.mode &= ~2u;
+}
+
+// Columnar batch decoding. A family is a set of message types and the keys
+// read from them; each key is a column of native values with a validity
+// bitmap (Arrow layout, LSB first), so the whole batch is decoded without a
+// Python object per message and with the GIL released.
+enum class ColType { INT, FLOAT, STR };
+
+struct ColumnDef {
+    int key;
+    ColType type;
+};
+
+struct FamilyDef {
+    const char *name;
+    uint32_t types;  // bit per message type
+    std::vector<ColumnDef> columns;
+};
+
+static const std::vector<FamilyDef> &families() {
+    static const std::vector<FamilyDef> defs = {
+        {"position", (1u << 1) | (1u << 2) | (1u << 3) | (1u << 18) | (1u << 19) | (1u << 27), {
+            {AIS::KEY_MMSI, ColType::INT}, {AIS::KEY_TYPE, ColType::INT},
+            {AIS::KEY_LAT, ColType::FLOAT}, {AIS::KEY_LON, ColType::FLOAT},
+            {AIS::KEY_SPEED, ColType::FLOAT}, {AIS::KEY_COURSE, ColType::FLOAT},
+            {AIS::KEY_HEADING, ColType::INT}, {AIS::KEY_STATUS, ColType::INT},
+            {AIS::KEY_TURN, ColType::FLOAT}, {AIS::KEY_ACCURACY, ColType::INT},
+            {AIS::KEY_SECOND, ColType::INT},
+        }},
+        {"static", (1u << 5) | (1u << 19) | (1u << 24), {
+            {AIS::KEY_MMSI, ColType::INT}, {AIS::KEY_TYPE, ColType::INT},
+            {AIS::KEY_PARTNO, ColType::INT}, {AIS::KEY_IMO, ColType::INT},
+            {AIS::KEY_CALLSIGN, ColType::STR}, {AIS::KEY_SHIPNAME, ColType::STR},
+            {AIS::KEY_SHIPTYPE, ColType::INT},
+            {AIS::KEY_TO_BOW, ColType::INT}, {AIS::KEY_TO_STERN, ColType::INT},
+            {AIS::KEY_TO_PORT, ColType::INT}, {AIS::KEY_TO_STARBOARD, ColType::INT},
+            {AIS::KEY_EPFD, ColType::INT},
+            {AIS::KEY_MONTH, ColType::INT}, {AIS::KEY_DAY, ColType::INT},
+            {AIS::KEY_HOUR, ColType::INT}, {AIS::KEY_MINUTE, ColType::INT},
+            {AIS::KEY_DRAUGHT, ColType::FLOAT}, {AIS::KEY_DESTINATION, ColType::STR},
+        }},
+        {"base", (1u << 4) | (1u << 11), {
+            {AIS::KEY_MMSI, ColType::INT}, {AIS::KEY_TYPE, ColType::INT},
+            {AIS::KEY_YEAR, ColType::INT}, {AIS::KEY_MONTH, ColType::INT},
+            {AIS::KEY_DAY, ColType::INT}, {AIS::KEY_HOUR, ColType::INT},
+            {AIS::KEY_MINUTE, ColType::INT}, {AIS::KEY_SECOND, ColType::INT},
+            {AIS::KEY_LAT, ColType::FLOAT}, {AIS::KEY_LON, ColType::FLOAT},
+            {AIS::KEY_ACCURACY, ColType::INT}, {AIS::KEY_EPFD, ColType::INT},
+            {AIS::KEY_RAIM, ColType::INT},
+        }},
+    };
+    return defs;
+}
+
+struct Column {
+    ColType type;
+    std::vector<int32_t> ints;
+    std::vector<double> floats;
+    std::vector<std::string> strs;
+    std::vector<uint8_t> valid;  // bitmap
+    int64_t nulls = 0;
+};
+
+struct FamilyTable {
+    const FamilyDef *def;
+    std::vector<int> slot;        // AIS::Keys -> column, -1 if not a column
+    std::vector<Column> columns;  // as in def, then rxuxtime
+    int64_t rows = 0;
+
+    explicit FamilyTable(const FamilyDef &d) : def(&d), slot(AIS::KEY_COUNT, -1) {
+        for (size_t c = 0; c < d.columns.size(); ++c) {
+            slot[d.columns[c].key] = (int)c;
+            columns.push_back(Column());
+            columns.back().type = d.columns[c].type;
+        }
+        columns.push_back(Column());
+        columns.back().type = ColType::FLOAT;
+    }
+
+    // opens a row with every column missing
+    void begin() {
+        if ((rows & 7) == 0)
+            for (Column &c : columns) c.valid.push_back(0);
+        for (Column &c : columns) {
+            switch (c.type) {
+                case ColType::INT:   c.ints.push_back(-1); break;
+                case ColType::FLOAT: c.floats.push_back(NAN); break;
+                case ColType::STR:   c.strs.emplace_back(); break;
+            }
+            c.nulls++;
+        }
+        rows++;
+    }
+
+    void set(int col, const JSON::Value &v) {
+        using T = JSON::Value::Type;
+        Column &c = columns[(size_t)col];
+        switch (c.type) {
+            case ColType::INT:
+                if (v.getType() == T::BOOL) c.ints.back() = v.getBool();
+                else if (v.getType() == T::INT) c.ints.back() = (int32_t)v.getInt();
+                else return;
+                break;
+            case ColType::FLOAT:
+                if (v.getType() != T::FLOAT && v.getType() != T::INT) return;
+                c.floats.back() = v.getFloat();
+                break;
+            case ColType::STR:
+                if (v.getType() != T::STRING) return;
+                c.strs.back() = v.getString();
+                break;
+        }
+        present(c);
+    }
+
+    void setTime(double t) {
+        columns.back().floats.back() = t;
+        present(columns.back());
+    }
+
+    // marks the value of the current row as present
+    void present(Column &c) {
+        const int64_t r = rows - 1;
+        c.valid[(size_t)(r >> 3)] |= (uint8_t)(1u << (r & 7));
+        c.nulls--;
+    }
+};
+
+class ColumnSink : public StreamIn<JSON::JSON> {
+public:
+    std::vector<FamilyTable> tables;
+
+    void Receive(const JSON::JSON *data, int len, TAG &tag) override {
+        for (int i = 0; i < len; ++i) {
+            auto *msg = static_cast<const AIS::Message *>(data[i].binary);
+            if (!msg) continue;
+            const int type = msg->type();
+            if (type < 0 || type > 31) continue;
+
+            for (FamilyTable &t : tables) {
+                if (!(t.def->types & (1u << type))) continue;
+                t.begin();
+                for (const auto &m : data[i].getMembers()) {
+                    int k = m.Key();
+                    if (k >= 0 && k < (int)AIS::KEY_COUNT && t.slot[k] >= 0)
+                        t.set(t.slot[k], m.Get());
+                }
+                t.setTime((double)msg->getRxTimeMicros() / 1000000.0);
+            }
+        }
+    }
+};
+
+static PyObject *column_to_python(const Column &c, int64_t rows) {
+    PyObject *values = nullptr;
+    switch (c.type) {
+        case ColType::INT:
+            values = PyBytes_FromStringAndSize((const char *)c.ints.data(), (Py_ssize_t)(c.ints.size() * sizeof(int32_t)));
+            break;
+        case ColType::FLOAT:
+            values = PyBytes_FromStringAndSize((const char *)c.floats.data(), (Py_ssize_t)(c.floats.size() * sizeof(double)));
+            break;
+        case ColType::STR:
+            values = PyList_New((Py_ssize_t)rows);
+            if (!values) return nullptr;
+            for (Py_ssize_t r = 0; r < (Py_ssize_t)rows; ++r) {
+                PyObject *s;
+                if (c.valid[(size_t)(r >> 3)] & (1u << (r & 7))) {
+                    const std::string &v = c.strs[(size_t)r];
+                    s = PyUnicode_FromStringAndSize(v.data(), (Py_ssize_t)v.size());
+                    if (!s) { Py_DECREF(values); return nullptr; }
+                } else {
+                    Py_INCREF(Py_None);
+                    s = Py_None;
+                }
+                PyList_SET_ITEM(values, r, s);
+            }
+            break;
+    }
+    if (!values) return nullptr;
+
+    static const char *codes[] = {"i4", "f8", "str"};
+    PyObject *valid = PyBytes_FromStringAndSize((const char *)c.valid.data(), (Py_ssize_t)c.valid.size());
+    if (!valid) { Py_DECREF(values); return nullptr; }
+    return Py_BuildValue("(sNNL)", codes[(int)c.type], values, valid, (long long)c.nulls);
+}
+
+static PyObject *table_to_python(const FamilyTable &t) {
+    PyObject *cols = PyDict_New();
+    if (!cols) return nullptr;
+    for (size_t c = 0; c < t.columns.size(); ++c) {
+        PyObject *key = c < t.def->columns.size() ? g_keys[t.def->columns[c].key] : g_keys[AIS::KEY_RXUXTIME];
+        PyObject *col = column_to_python(t.columns[c], t.rows);
+        if (!col || PyDict_SetItem(cols, key, col) < 0) {
+            Py_XDECREF(col); Py_DECREF(cols); return nullptr;
+        }
+        Py_DECREF(col);
+    }
+    return Py_BuildValue("(LN)", (long long)t.rows, cols);
+}
+
+// decode_columns(data, families) -> {family: (rows, {column: (dtype, values, validity, nulls)})}
+static PyObject *decode_columns(PyObject *Py_UNUSED(module), PyObject *args, PyObject *kwds) {
+    static const char *kwlist[] = {"data", "families", nullptr};
+    PyObject *data_obj, *names = nullptr;
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "O|O", (char **)kwlist, &data_obj, &names))
+        return nullptr;
+
+    ColumnSink sink;
+    AIS::KeySet keys;
+    const std::vector<FamilyDef> &defs = families();
+
+    if (!names || names == Py_None) {
+        for (const FamilyDef &d : defs) sink.tables.emplace_back(d);
+    } else {
+        PyObject *seq = PySequence_Fast(names, "families must be a sequence of names");
+        if (!seq) return nullptr;
+        for (Py_ssize_t i = 0; i < PySequence_Fast_GET_SIZE(seq); ++i) {
+            const char *n = PyUnicode_AsUTF8(PySequence_Fast_GET_ITEM(seq, i));
+            const FamilyDef *found = nullptr;
+            for (const FamilyDef &d : defs)
+                if (n && !std::strcmp(n, d.name)) found = &d;
+            if (!found) {
+                if (n) PyErr_Format(PyExc_ValueError, "unknown family %s; expected 'position', 'static' or 'base'", n);
+                Py_DECREF(seq);
+                return nullptr;
+            }
+            sink.tables.emplace_back(*found);
+        }
+        Py_DECREF(seq);
+    }
+    for (const FamilyTable &t : sink.tables)
+        for (const ColumnDef &c : t.def->columns) keys.add(c.key);
+
+    Py_buffer view;
+    if (PyUnicode_Check(data_obj)) {
+        Py_ssize_t size;
+        const char *s = PyUnicode_AsUTF8AndSize(data_obj, &size);
+        if (!s || PyBuffer_FillInfo(&view, data_obj, (void *)s, size, 1, PyBUF_SIMPLE) < 0) return nullptr;
+    } else if (PyObject_GetBuffer(data_obj, &view, PyBUF_SIMPLE) < 0) {
+        return nullptr;
+    }
+
+    std::string error;
+    Py_BEGIN_ALLOW_THREADS
+    try {
+        AIS::NMEA nmea;
+        AIS::JSONAIS jsonais;
+        TAG tag;
+        tag.clear();
+        tag.mode &= ~2u;
+        jsonais.require(keys);
+        nmea.out.Connect(&jsonais);
+        jsonais.out.Connect(&sink);
+
+        // in slices, as a stream would deliver them
+        const char *p = (const char *)view.buf;
+        for (Py_ssize_t done = 0; done < view.len;) {
+            int n = (int)std::min<Py_ssize_t>(view.len - done, 1 << 20);
+            RAW r{Format::TXT, (void *)(p + done), n};
+            nmea.Receive(&r, 1, tag);
+            done += n;
+        }
+    } catch (const std::exception &e) {
+        error = e.what();
+    } catch (...) {
+        error = "aiscat: unknown error";
+    }
+    Py_END_ALLOW_THREADS
+    PyBuffer_Release(&view);
+
+    if (!error.empty()) {
+        PyErr_SetString(PyExc_RuntimeError, error.c_str());
+        return nullptr;
+    }
+
+    PyObject *result = PyDict_New();
+    if (!result) return nullptr;
+    for (const FamilyTable &t : sink.tables) {
+        PyObject *table = table_to_python(t);
+        if (!table || PyDict_SetItemString(result, t.def->name, table) < 0) {
+            Py_XDECREF(table); Py_DECREF(result); return nullptr;
+        }
+        Py_DECREF(table);
+    }
+    return result;
+}
+
 typedef struct {
     PyObject_HEAD
     AIS::NMEA *nmea;
@@ -295,12 +606,7 @@ static int Decoder_init(DecoderObject *self, PyObject *args, PyObject *kwds) {
         self->sink = new PySink();
         self->sink->format = fmt;
         self->tag = new TAG();
-        self->tag->clear();
-        if (country) self->tag->mode |= 4;  // enables JSONAIS::COUNTRY (MMSI prefix → country, country_code)
-        // Clearing mode bit 2 skips the rxtime string the dict formats would only
-        // discard (kSkipMask); PySink::Receive adds rxuxtime from the message.
-        if (fmt == OutFormat::DICTIONARY || fmt == OutFormat::ANNOTATED)
-            self->tag->mode &= ~2u;
+        setup_tag(*self->tag, fmt, country);
         self->nmea->out.Connect(self->jsonais);
         self->jsonais->out.Connect(self->sink);
     } catch (const std::exception &e) {
@@ -380,12 +686,331 @@ static PyTypeObject DecoderType = {
     PyVarObject_HEAD_INIT(nullptr, 0)
 };
 
+// Decodes memory-mapped files on a pool of threads. The files are cut into
+// chunks at line starts that split no multipart message (NMEA::nextCut), so every chunk
+// decodes on a fresh NMEA/JSONAIS pipeline, and the results are handed out in
+// input order. Parsing runs off the GIL; with a GIL the dict formats take it
+// per chunk to build their objects, free-threaded builds build them in parallel.
+struct Collected {
+    AIS::Message msg;
+    TAG tag;
+};
+
+class MessageCollector : public StreamIn<AIS::Message> {
+public:
+    std::vector<Collected> msgs;
+
+    void Receive(const AIS::Message *data, int len, TAG &tag) override {
+        for (int i = 0; i < len; ++i) msgs.push_back({data[i], tag});
+    }
+};
+
+// Holds the GIL (attaches the thread) for its scope, also when unwinding.
+struct Attached {
+    PyGILState_STATE state;
+    Attached() : state(PyGILState_Ensure()) {}
+    ~Attached() { PyGILState_Release(state); }
+};
+
+struct Chunk {
+    const char *data;
+    size_t size;
+    bool done = false;
+    std::vector<std::string> bytes;   // bytes formats
+    std::deque<PyObject *> objects;   // dict formats
+    std::string error;                // C++ exception
+    PyObject *exc_type = nullptr, *exc_value = nullptr, *exc_tb = nullptr;  // conversion error
+};
+
+class FilePool {
+public:
+    OutFormat format = OutFormat::DICTIONARY;
+    bool country = false;
+    std::vector<Py_buffer> views;
+    std::vector<Chunk> chunks;
+
+    size_t next = 0;      // next chunk to decode
+    size_t consumed = 0;  // chunks handed out
+    size_t window = 1;    // chunks decoded ahead of the consumer
+    bool stop = false;
+    std::mutex mtx;
+    std::condition_variable cv;
+    std::vector<std::thread> threads;
+
+    // the chunk being handed out
+    std::vector<std::string> bytes;
+    std::deque<PyObject *> objects;
+    size_t pos = 0;
+
+    void split(const char *p, size_t size, size_t chunk) {
+        const char *begin = p, *end = p + size;
+        while (p < end) {
+            const char *c = end;
+            if ((size_t)(end - p) > chunk) {
+                const char *nl = (const char *)std::memchr(p + chunk, '\n', end - (p + chunk));
+                c = nl ? AIS::NMEA::nextCut(begin, nl + 1, end, true) : end;
+            }
+            chunks.emplace_back();
+            chunks.back().data = p;
+            chunks.back().size = (size_t)(c - p);
+            p = c;
+        }
+    }
+
+    void start(int n) {
+        window = (size_t)n * 2;
+        for (int i = 0; i < n; ++i) threads.emplace_back(&FilePool::run, this);
+    }
+
+    void run() {
+        for (;;) {
+            size_t k;
+            {
+                std::unique_lock<std::mutex> lock(mtx);
+                cv.wait(lock, [this] { return stop || next == chunks.size() || next < consumed + window; });
+                if (stop || next == chunks.size()) return;
+                k = next++;
+            }
+            decode(chunks[k]);
+            {
+                std::lock_guard<std::mutex> lock(mtx);
+                chunks[k].done = true;
+            }
+            cv.notify_all();
+        }
+    }
+
+    void decode(Chunk &c) {
+        TAG tag;
+        setup_tag(tag, format, country);
+
+        try {
+            AIS::NMEA nmea;
+            RAW r{Format::TXT, (void *)c.data, (int)c.size};
+
+            if (!is_dict(format)) {
+                AIS::JSONAIS jsonais;
+                ByteSink sink;
+                sink.format = format;
+                sink.out = &c.bytes;
+                nmea.out.Connect(&jsonais);
+                jsonais.out.Connect(&sink);
+                nmea.Receive(&r, 1, tag);
+                return;
+            }
+
+#ifdef Py_GIL_DISABLED
+            // attaching does not serialize the threads: build the dicts as we go
+            {
+                Attached attached;
+                AIS::JSONAIS jsonais;
+                PySink sink;
+                sink.format = format;
+                nmea.out.Connect(&jsonais);
+                jsonais.out.Connect(&sink);
+                nmea.Receive(&r, 1, tag);
+                if (PyErr_Occurred()) PyErr_Fetch(&c.exc_type, &c.exc_value, &c.exc_tb);
+                c.objects.swap(sink.queue);
+            }
+#else
+            // parse without the GIL, then take it once to build the dicts
+            MessageCollector collector;
+            nmea.out.Connect(&collector);
+            nmea.Receive(&r, 1, tag);
+
+            if (stop) return;
+
+            {
+                Attached attached;
+                AIS::JSONAIS jsonais;
+                PySink sink;
+                sink.format = format;
+                jsonais.out.Connect(&sink);
+
+                for (Collected &m : collector.msgs) {
+                    jsonais.Receive(&m.msg, 1, m.tag);
+                    if (PyErr_Occurred()) break;
+                }
+                if (PyErr_Occurred()) PyErr_Fetch(&c.exc_type, &c.exc_value, &c.exc_tb);
+                c.objects.swap(sink.queue);
+            }
+#endif
+        } catch (const std::exception &e) {
+            c.error = e.what();
+        } catch (...) {
+            c.error = "aiscat: unknown error";
+        }
+    }
+
+    // waits for the next chunk in order; false when all are handed out
+    bool take() {
+        if (consumed == chunks.size()) return false;
+        Chunk &c = chunks[consumed];
+
+        Py_BEGIN_ALLOW_THREADS
+        {
+            std::unique_lock<std::mutex> lock(mtx);
+            cv.wait(lock, [&c] { return c.done; });
+        }
+        Py_END_ALLOW_THREADS
+
+        bytes.clear();
+        bytes.swap(c.bytes);
+        objects.swap(c.objects);
+        pos = 0;
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            consumed++;
+        }
+        cv.notify_all();
+        return true;
+    }
+
+    void shutdown() {
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            stop = true;
+        }
+        cv.notify_all();
+        // the workers may be waiting for the GIL
+        Py_BEGIN_ALLOW_THREADS
+        for (std::thread &t : threads) t.join();
+        Py_END_ALLOW_THREADS
+        threads.clear();
+
+        for (Chunk &c : chunks) {
+            for (PyObject *o : c.objects) Py_DECREF(o);
+            Py_XDECREF(c.exc_type);
+            Py_XDECREF(c.exc_value);
+            Py_XDECREF(c.exc_tb);
+        }
+        for (PyObject *o : objects) Py_DECREF(o);
+        chunks.clear();
+        objects.clear();
+        for (Py_buffer &v : views) PyBuffer_Release(&v);
+        views.clear();
+    }
+};
+
+typedef struct {
+    PyObject_HEAD
+    FilePool *pool;
+} FileDecoderObject;
+
+static int FileDecoder_init(FileDecoderObject *self, PyObject *args, PyObject *kwds) {
+    static const char *kwlist[] = {"buffers", "format", "country", "threads", "chunk", nullptr};
+    PyObject *buffers;
+    const char *format_str = nullptr;
+    int country = 0, threads = 1;
+    Py_ssize_t chunk = 1 << 22;
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "O|zpin", (char **)kwlist,
+                                     &buffers, &format_str, &country, &threads, &chunk))
+        return -1;
+
+    if (self->pool) {
+        PyErr_SetString(PyExc_RuntimeError, "FileDecoder is already initialized");
+        return -1;
+    }
+    OutFormat fmt;
+    if (!parse_format(format_str, fmt)) {
+        PyErr_Format(PyExc_ValueError,
+            "format must be one of 'dictionary', 'annotated', 'json', 'json_nmea', 'nmea', 'nmea_tag', 'binary'; got %s",
+            format_str);
+        return -1;
+    }
+    if (threads < 1) {
+        PyErr_SetString(PyExc_ValueError, "threads must be at least 1");
+        return -1;
+    }
+    // a chunk is one RAW block of the NMEA decoder
+    chunk = std::max<Py_ssize_t>(1 << 16, std::min<Py_ssize_t>(chunk, 1 << 30));
+
+    PyObject *seq = PySequence_Fast(buffers, "buffers must be a sequence of bytes-like objects");
+    if (!seq) return -1;
+
+    FilePool *pool = new FilePool();
+    pool->format = fmt;
+    pool->country = country != 0;
+    self->pool = pool;
+
+    for (Py_ssize_t i = 0; i < PySequence_Fast_GET_SIZE(seq); ++i) {
+        Py_buffer view;
+        if (PyObject_GetBuffer(PySequence_Fast_GET_ITEM(seq, i), &view, PyBUF_SIMPLE) < 0) {
+            Py_DECREF(seq);
+            return -1;
+        }
+        pool->views.push_back(view);
+        pool->split((const char *)view.buf, (size_t)view.len, (size_t)chunk);
+    }
+    Py_DECREF(seq);
+
+    try {
+        pool->start(threads);
+    } catch (const std::exception &e) {
+        PyErr_SetString(PyExc_RuntimeError, e.what());
+        return -1;
+    }
+    return 0;
+}
+
+static void FileDecoder_dealloc(FileDecoderObject *self) {
+    if (self->pool) {
+        self->pool->shutdown();
+        delete self->pool;
+    }
+    Py_TYPE(self)->tp_free((PyObject *)self);
+}
+
+static PyObject *FileDecoder_next(FileDecoderObject *self) {
+    FilePool *pool = self->pool;
+    if (!pool) {
+        PyErr_SetString(PyExc_RuntimeError, "FileDecoder is not initialized");
+        return nullptr;
+    }
+
+    for (;;) {
+        if (!pool->objects.empty()) {
+            PyObject *o = pool->objects.front();
+            pool->objects.pop_front();
+            return o;
+        }
+        if (pool->pos < pool->bytes.size()) {
+            const std::string &b = pool->bytes[pool->pos++];
+            return PyBytes_FromStringAndSize(b.data(), (Py_ssize_t)b.size());
+        }
+
+        if (!pool->take()) return nullptr;  // StopIteration
+
+        Chunk &c = pool->chunks[pool->consumed - 1];
+        if (!c.error.empty()) {
+            PyErr_SetString(PyExc_RuntimeError, c.error.c_str());
+            return nullptr;
+        }
+        if (c.exc_type) {
+            PyErr_Restore(c.exc_type, c.exc_value, c.exc_tb);
+            c.exc_type = c.exc_value = c.exc_tb = nullptr;
+            return nullptr;
+        }
+    }
+}
+
+static PyTypeObject FileDecoderType = {
+    PyVarObject_HEAD_INIT(nullptr, 0)
+};
+
+static PyMethodDef module_methods[] = {
+    {"decode_columns", (PyCFunction)(void (*)(void))decode_columns, METH_VARARGS | METH_KEYWORDS,
+     "decode_columns(data, families=None) -> dict. Decode a whole buffer into "
+     "per-family columns with the GIL released; see aiscat.decode_columns."},
+    {nullptr, nullptr, 0, nullptr}
+};
+
 static struct PyModuleDef coremodule = {
     PyModuleDef_HEAD_INIT,
     "_core",
     "AIS-catcher NMEA decoder (C++ binding)",
     -1,
-    nullptr
+    module_methods
 };
 
 PyMODINIT_FUNC PyInit__core(void) {
@@ -400,6 +1025,20 @@ PyMODINIT_FUNC PyInit__core(void) {
 
     if (PyType_Ready(&DecoderType) < 0) return nullptr;
 
+    FileDecoderType.tp_name = "aiscat._core.FileDecoder";
+    FileDecoderType.tp_basicsize = sizeof(FileDecoderObject);
+    FileDecoderType.tp_dealloc = (destructor)FileDecoder_dealloc;
+    FileDecoderType.tp_flags = Py_TPFLAGS_DEFAULT;
+    FileDecoderType.tp_doc =
+        "FileDecoder(buffers, format=None, country=False, threads=1, chunk=4 MiB): "
+        "iterator over the messages in the buffers, decoded on a thread pool; see aiscat.decode_files.";
+    FileDecoderType.tp_iter = PyObject_SelfIter;
+    FileDecoderType.tp_iternext = (iternextfunc)FileDecoder_next;
+    FileDecoderType.tp_init = (initproc)FileDecoder_init;
+    FileDecoderType.tp_new = PyType_GenericNew;
+
+    if (PyType_Ready(&FileDecoderType) < 0) return nullptr;
+
     PyObject *m = PyModule_Create(&coremodule);
     if (!m) return nullptr;
 
@@ -439,5 +1078,12 @@ PyMODINIT_FUNC PyInit__core(void) {
         Py_DECREF(m);
         return nullptr;
     }
+
+    Py_INCREF(&FileDecoderType);
+    if (PyModule_AddObject(m, "FileDecoder", (PyObject *)&FileDecoderType) < 0) {
+        Py_DECREF(&FileDecoderType);
+        Py_DECREF(m);
+        return nullptr;
+    }
     return m;
 }
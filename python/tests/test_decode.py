@@ -4,6 +4,7 @@ import os
 import subprocess
 import sys
 import sysconfig
+import tempfile
 import textwrap
 
 import aiscat
@@ -95,6 +96,64 @@ def test_decode_max_length_type26():
     assert oversized_dec.next() is None
 
 
+def test_decode_columns():
+    data = SAMPLE_A + SAMPLE_B + SAMPLE_TYPE5
+    rows, cols = aiscat.decode_columns(data, families=["position"], format="columns")["position"]
+    assert rows == 2
+    dtype, values, validity, nulls = cols["mmsi"]
+    assert dtype == "i4" and nulls == 0 and validity[0] & 3 == 3
+    assert int.from_bytes(values[:4], sys.byteorder, signed=True) == 366730000
+
+    tables = aiscat.decode_columns(data, format="columns")
+    assert sorted(tables) == ["base", "position", "static"]
+    rows, cols = tables["static"]
+    assert rows == 1
+    assert cols["shipname"][1][0] == aiscat.decode(*SAMPLE_TYPE5.splitlines())["shipname"]
+    assert tables["base"][0] == 0
+
+    try:
+        import numpy  # noqa: F401
+    except ImportError:
+        return
+    pos = aiscat.decode_columns(data)["position"]
+    assert list(pos["mmsi"]) == [366730000, aiscat.decode(SAMPLE_B)["mmsi"]]
+    assert abs(pos["lat"][0] - 37.803802) < 1e-3
+
+
+def test_decode_file_threads():
+    # several chunks, with multipart messages on the cuts
+    data = (SAMPLE_A + SAMPLE_TYPE5 + SAMPLE_B) * 2000
+    with tempfile.TemporaryDirectory() as d:
+        path = os.path.join(d, "sample.nmea")
+        with open(path, "wb") as f:
+            f.write(data)
+
+        expected = list(aiscat.from_file(path, format="nmea"))
+        assert len(expected) == 6000
+        assert list(aiscat.decode_file(path, format="nmea", threads=3, chunk=1)) == expected
+
+        msgs = list(aiscat.decode_files([path, path], threads=2, chunk=1))
+        assert [m["type"] for m in msgs] == [1, 5, 1] * 4000
+
+        it = aiscat.decode_file(path, threads=2, chunk=1)
+        assert next(it)["type"] == 1
+        del it  # stops the pool with chunks still queued
+
+
+def test_decode_file_threads_interleaved():
+    # a single-part sentence on the other channel between the fragments
+    data = (SAMPLE_TYPE5.splitlines(True)[0] + SAMPLE_B + SAMPLE_TYPE5.splitlines(True)[1]) * 20000
+    with tempfile.TemporaryDirectory() as d:
+        path = os.path.join(d, "interleaved.nmea")
+        with open(path, "wb") as f:
+            f.write(data)
+
+        expected = list(aiscat.from_file(path, format="nmea"))
+        assert len(expected) == 40000
+        for chunk in (1, 65600):
+            assert list(aiscat.decode_file(path, format="nmea", threads=3, chunk=chunk)) == expected
+
+
 # Free-threading: independent Decoder instances must be usable from different
 # threads. The Py_GIL_DISABLED-specific assertions self-gate, so these run
 # (and trivially pass) on GIL builds too.
@@ -207,6 +266,9 @@ if __name__ == "__main__":
     test_decode_type1()
     test_decode_two_sentences()
     test_decode_max_length_type26()
+    test_decode_columns()
+    test_decode_file_threads()
+    test_decode_file_threads_interleaved()
     test_import_does_not_enable_gil()
     test_independent_decoders_from_multiple_threads()
     test_multifragment_decoders_from_multiple_threads()